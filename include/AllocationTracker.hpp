@@ -0,0 +1,251 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_ALLOCATION_TRACKER_HPP
+#define PONG_ALLOCATION_TRACKER_HPP
+
+#include <Bit/Build.hpp>
+#include <atomic>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Allocation counters.
+	///
+	////////////////////////////////////////////////////////////////
+	struct AllocationCounters
+	{
+		AllocationCounters( );
+
+		AllocationCounters operator -( const AllocationCounters & p_Counters ) const;
+		AllocationCounters & operator +=( const AllocationCounters & p_Counters );
+
+		Bit::Uint64 Allocations;
+		Bit::Uint64 Frees;
+		Bit::Uint64 Bytes;	///< Allocated bytes, freed bytes are not subtracted.
+	};
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Counts the heap allocations of every thread.
+	///
+	/// The global operator new and delete are replaced to count
+	/// the allocations in thread local counters.
+	/// MSVC debug builds count through the CRT allocation hook instead,
+	/// since Bit's memory leak check maps new to the debug new of the CRT.
+	/// The hook counts malloc as well.
+	///
+	////////////////////////////////////////////////////////////////
+	class AllocationTracker
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the counters of the calling thread.
+		///
+		////////////////////////////////////////////////////////////////
+		static AllocationCounters GetThreadCounters( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Count an allocation of the calling thread.
+		///
+		////////////////////////////////////////////////////////////////
+		static void RecordAllocation( const Bit::SizeType p_Size );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Count a free of the calling thread.
+		///
+		////////////////////////////////////////////////////////////////
+		static void RecordFree( );
+
+	};
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Allocation report of a repeated frame, like a server tick.
+	///
+	/// Attributes the allocations of a frame to named phases.
+	/// Allocations made by other threads on behalf of the frame
+	/// are added with Add.
+	/// After a warm-up, a frame is in steady state and must not allocate.
+	/// Allocating steady frames are reported or asserted on,
+	/// depending on the check.
+	///
+	/// The report itself never allocates while recording.
+	///
+	////////////////////////////////////////////////////////////////
+	class AllocationReport
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Maximum number of phases.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::SizeType MaxPhases = 16;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check enumerator, what to do with allocating steady frames.
+		///
+		////////////////////////////////////////////////////////////////
+		enum eCheck
+		{
+			Off,
+			Report,
+			Assert
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the default check, report in debug builds, off otherwise.
+		///
+		////////////////////////////////////////////////////////////////
+		static eCheck GetDefaultCheck( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor.
+		///
+		/// \param p_pName Name of the frames, used in the reports.
+		/// \param p_Check What to do with allocating steady frames.
+		/// \param p_WarmUpFrames Frames after a reset before the steady state.
+		///
+		////////////////////////////////////////////////////////////////
+		AllocationReport( const char * p_pName, const eCheck p_Check, const Bit::Uint32 p_WarmUpFrames );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Set the check.
+		///
+		////////////////////////////////////////////////////////////////
+		void SetCheck( const eCheck p_Check );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Restart the warm-up, thread safe.
+		///
+		/// Called on expected allocations, like new connections.
+		///
+		////////////////////////////////////////////////////////////////
+		void ResetSteadyState( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Begin a frame.
+		///
+		////////////////////////////////////////////////////////////////
+		void BeginFrame( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief End the frame and check it.
+		///
+		/// \return false if a steady frame allocated.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool EndFrame( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Begin a phase on the calling thread.
+		///
+		/// \param p_pName Name of the phase, must be a string literal.
+		///
+		////////////////////////////////////////////////////////////////
+		void BeginPhase( const char * p_pName );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief End the current phase.
+		///
+		////////////////////////////////////////////////////////////////
+		void EndPhase( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Add allocations of other threads to a phase.
+		///
+		////////////////////////////////////////////////////////////////
+		void Add( const char * p_pName, const AllocationCounters & p_Counters );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the counters of the last frame.
+		///
+		////////////////////////////////////////////////////////////////
+		const AllocationCounters & GetFrameCounters( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of allocating steady frames.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint64 GetViolationCount( ) const;
+
+	private:
+
+		// Private structures
+		struct Phase
+		{
+			const char *		pName;
+			AllocationCounters	Counters;
+		};
+
+		// Private functions
+		Phase * FindPhase( const char * p_pName );
+		void PrintFrame( ) const;
+
+		// Private variables
+		const char *				m_pName;
+		eCheck						m_Check;
+		Bit::Uint32					m_WarmUpFrames;
+		std::atomic<Bit::Uint32>	m_SteadyFrames;
+		Bit::Uint64					m_Frame;
+		Bit::Uint64					m_Violations;
+		Phase						m_Phases[ MaxPhases ];
+		Bit::SizeType				m_PhaseCount;
+		Phase *						m_pCurrentPhase;
+		AllocationCounters			m_PhaseStart;
+		AllocationCounters			m_FrameCounters;
+
+	};
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Scoped phase of an allocation report.
+	///
+	////////////////////////////////////////////////////////////////
+	class AllocationScope
+	{
+
+	public:
+
+		AllocationScope( AllocationReport & p_Report, const char * p_pName );
+		~AllocationScope( );
+
+	private:
+
+		// Copy not allowed
+		AllocationScope( const AllocationScope & );
+		AllocationScope & operator =( const AllocationScope & );
+
+		AllocationReport & m_Report;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -26,6 +26,7 @@
 
 #include <Bit/Network/Net/Entity.hpp>
 #include <Bit/System/Vector2.hpp>
+#include <cstddef>
 
 namespace Pong
 {
@@ -40,6 +41,18 @@ namespace Pong
 
 	public:
 
+		////////////////////////////////////////////////////////////////
+		/// \brief Allocate balls from the ball block pool.
+		///
+		////////////////////////////////////////////////////////////////
+		static void * operator new( std::size_t p_Size );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Return balls to the ball block pool.
+		///
+		////////////////////////////////////////////////////////////////
+		static void operator delete( void * p_pPointer, std::size_t p_Size );
+
 		// Variables
 		Bit::Net::Variable<Bit::Vector2f32> Position;
 		Bit::Net::Variable<Bit::Float64>	Rotation;
@@ -0,0 +1,82 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_BASELINE_MESSAGE_LISTENER_HPP
+#define PONG_BASELINE_MESSAGE_LISTENER_HPP
+
+#include <MessageHandler.hpp>
+#include <EntityStates.hpp>
+
+namespace Pong
+{
+
+	// Forward declarations
+	class Client;
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Baseline message handler, the answer to the join message.
+	///
+	/// Layout: slot (Uint8, 0xFF if the server is full), resume token (Uint64),
+	/// game mode (Uint8), obstacle count (Uint16), seed (Uint32),
+	/// ball radius, player width and height (Float32),
+	/// followed by a full detail snapshot of every entity and the tick.
+	///
+	/// The baseline of a resume must have the match setup of the first one,
+	/// the entities and shapes are not rebuilt.
+	///
+	////////////////////////////////////////////////////////////////
+	class BaselineMessageListener : public MessageHandler
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		////////////////////////////////////////////////////////////////
+		BaselineMessageListener( Client * p_pClient );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Handle message function
+		///
+		////////////////////////////////////////////////////////////////
+		virtual void HandleMessage( Packet & p_Message );
+
+	private:
+
+		// Private variables
+		Client *		m_pClient;
+		BallStates		m_Balls;
+		PlayerStates	m_Players;
+		Bit::Bool		m_HasSetup;			///< A baseline was applied, later ones are resumes.
+		Bit::Uint8		m_Mode;				///< Match setup of the first baseline.
+		Bit::Uint16		m_ObstacleCount;
+		Bit::Uint32		m_Seed;
+		Bit::Uint16		m_BallCount;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
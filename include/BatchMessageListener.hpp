@@ -0,0 +1,79 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_BATCH_MESSAGE_LISTENER_HPP
+#define PONG_BATCH_MESSAGE_LISTENER_HPP
+
+#include <Bit/Network/Net/HostMessageListener.hpp>
+#include <MessageHandler.hpp>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Unpacks batch messages sent by the MessageBatcher and
+	///		dispatches each record to its message handler.
+	///
+	////////////////////////////////////////////////////////////////
+	class BatchMessageListener : public Bit::Net::HostMessageListener
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		////////////////////////////////////////////////////////////////
+		BatchMessageListener( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Hook a message handler to a message type.
+		///
+		////////////////////////////////////////////////////////////////
+		void Hook( MessageHandler * p_pHandler, const Bit::Uint8 p_Type );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Handle message function
+		///
+		////////////////////////////////////////////////////////////////
+		virtual void HandleMessage( Bit::Net::HostMessageDecoder & p_Message );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Dispatch all records of a frame.
+		///
+		////////////////////////////////////////////////////////////////
+		void Dispatch( const Bit::Uint8 * p_pFrame, const Bit::SizeType p_Size );
+
+	private:
+
+		// Private variables
+		MessageHandler *	m_pHandlers[ 256 ];
+		Packet				m_Frame;
+		Packet				m_Record;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
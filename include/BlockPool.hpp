@@ -0,0 +1,106 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_BLOCK_POOL_HPP
+#define PONG_BLOCK_POOL_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Mutex.hpp>
+#include <vector>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Fixed size block allocator.
+	///
+	/// Blocks are carved out of contiguous chunks and recycled
+	/// through a free list, so objects of the same type end up
+	/// next to each other in memory and are never returned to
+	/// the heap until the pool is destroyed.
+	///
+	////////////////////////////////////////////////////////////////
+	class BlockPool
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor.
+		///
+		/// \param p_BlockSize Size of each block, in bytes.
+		/// \param p_BlocksPerChunk Number of blocks allocated at once.
+		///
+		////////////////////////////////////////////////////////////////
+		BlockPool( const Bit::SizeType p_BlockSize, const Bit::SizeType p_BlocksPerChunk );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destructor, releases all chunks.
+		///
+		////////////////////////////////////////////////////////////////
+		~BlockPool( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Allocate a block.
+		///
+		////////////////////////////////////////////////////////////////
+		void * Allocate( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Return a block to the pool.
+		///
+		////////////////////////////////////////////////////////////////
+		void Free( void * p_pBlock );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the size of each block, in bytes.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetBlockSize( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of allocated blocks.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetUsedCount( ) const;
+
+	private:
+
+		// Copy not allowed
+		BlockPool( const BlockPool & );
+		BlockPool & operator =( const BlockPool & );
+
+		// Private variables
+		Bit::Mutex					m_Mutex;
+		Bit::SizeType				m_BlockSize;
+		Bit::SizeType				m_BlocksPerChunk;
+		std::vector<Bit::Uint8 *>	m_Chunks;
+		void *						m_pFreeList;
+		Bit::SizeType				m_UsedCount;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
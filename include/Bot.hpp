@@ -0,0 +1,92 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_BOT_HPP
+#define PONG_BOT_HPP
+
+#include <Bit/Build.hpp>
+#include <Player.hpp>
+#include <EntityStates.hpp>
+#include <MatchBatch.hpp>
+#include <MultiBallMatch.hpp>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Server side players, without a client or a connection.
+	///
+	/// A bot follows the nearest ball with its paddle, and writes
+	/// its input straight into the match, just like the user
+	/// messages set Player::IsMoving and Player::Direction.
+	/// Bots let a single process fill any number of matches,
+	/// to measure the simulation and replication on their own.
+	///
+	/// Bots keep no state, and bots of different matches can
+	/// play on different threads at the same time.
+	///
+	////////////////////////////////////////////////////////////////
+	class Bot
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Decide the input of a paddle.
+		///
+		/// \param p_PaddleY Height of the paddle.
+		/// \param p_TargetY Height the paddle should move to.
+		/// \param p_IsMoving Set to true if the paddle should move.
+		/// \param p_Direction Set to the direction to move in.
+		///
+		////////////////////////////////////////////////////////////////
+		static void Think(	const Bit::Float32 p_PaddleY, const Bit::Float32 p_TargetY,
+							bool & p_IsMoving, eDirection & p_Direction );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Find the height of the ball nearest to a paddle.
+		///
+		/// \return The height of the ball, or the middle of the field if there are no balls.
+		///
+		////////////////////////////////////////////////////////////////
+		static Bit::Float32 FindTarget(	const BallStates & p_Balls, const Bit::SizeType p_First,
+										const Bit::SizeType p_Count, const Bit::Float32 p_PaddleX );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Play both paddles of the matches p_First to p_First + p_Count - 1.
+		///
+		////////////////////////////////////////////////////////////////
+		static void Play( MatchBatch & p_Matches, const Bit::SizeType p_First, const Bit::SizeType p_Count );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Play both paddles of a multi-ball match.
+		///
+		////////////////////////////////////////////////////////////////
+		static void Play( MultiBallMatch & p_Match );
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,173 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_CHECKPOINT_HPP
+#define PONG_CHECKPOINT_HPP
+
+#include <Bit/Build.hpp>
+#include <Packet.hpp>
+#include <string>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Match state checkpoint in a memory mapped file.
+	///
+	/// The file holds two slots. A write goes to the slot that is
+	/// not the newest one, and is published by an atomic sequence
+	/// number after the data is in place, so a crash in the middle
+	/// of a write still leaves the previous checkpoint intact.
+	///
+	/// The file is shared by a running server and the server
+	/// taking over from it. The new server requests a handover,
+	/// the running server writes a final checkpoint, releases the
+	/// file and stops, and the new server continues from the
+	/// released state.
+	///
+	////////////////////////////////////////////////////////////////
+	class Checkpoint
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		Checkpoint( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destructor, closes the file.
+		///
+		////////////////////////////////////////////////////////////////
+		~Checkpoint( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Create a new, empty checkpoint file.
+		///
+		/// An existing file is overwritten.
+		///
+		/// \param p_Capacity Maximum size of a checkpoint, in bytes.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Create( const std::string & p_Path, const Bit::SizeType p_Capacity );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Open an existing checkpoint file.
+		///
+		/// \return False if the file is missing or not a checkpoint file.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Open( const std::string & p_Path );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Unmap and close the file.
+		///
+		////////////////////////////////////////////////////////////////
+		void Close( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if the file is open.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool IsOpen( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the maximum size of a checkpoint, in bytes.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetCapacity( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Write a checkpoint.
+		///
+		/// \return False if the checkpoint does not fit.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Write( const Packet & p_Packet );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Read the newest checkpoint.
+		///
+		/// \return False if there is no valid checkpoint.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Read( Packet & p_Packet ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Ask the server owning the file to hand over.
+		///
+		////////////////////////////////////////////////////////////////
+		void RequestHandover( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if another server requested a handover.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool IsHandoverRequested( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Mark the file as released, after the final checkpoint.
+		///
+		////////////////////////////////////////////////////////////////
+		void Release( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if the previous owner released the file.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool IsReleased( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Take ownership of the file, clearing any handover.
+		///
+		////////////////////////////////////////////////////////////////
+		void Acquire( );
+
+	private:
+
+		// Copy not allowed
+		Checkpoint( const Checkpoint & );
+		Checkpoint & operator =( const Checkpoint & );
+
+		// Private structures
+		struct Header;
+
+		// Private functions
+		Bit::Bool Map( const std::string & p_Path, const Bit::SizeType p_Size, const Bit::Bool p_Create );
+		Bit::Uint8 * GetSlot( const Bit::Uint32 p_Slot ) const;
+
+		// Private variables
+		Bit::Int64		m_File;
+		Bit::Int64		m_Mapping;		///< Handle of the file mapping, Windows only.
+		Bit::Uint8 *	m_pData;
+		Bit::SizeType	m_Size;
+		Header *		m_pHeader;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -28,9 +28,22 @@
 #include <Bit/Network/net/Client.hpp>
 #include <Bit/Window/SimpleRenderWindow.hpp>
 #include <Bit/Graphics/GraphicDevice.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Bit/System/Mutex.hpp>
 #include <Ball.hpp>
 #include <Player.hpp>
-#include <InitMessageListener.hpp>
+#include <EntityStore.hpp>
+#include <GameMode.hpp>
+#include <MultiBallMatch.hpp>
+#include <BaselineMessageListener.hpp>
+#include <BatchMessageListener.hpp>
+#include <TimeSyncMessageListener.hpp>
+#include <SnapshotMessageListener.hpp>
+#include <TimeSync.hpp>
+#include <AllocationTracker.hpp>
+#include <FrameHistogram.hpp>
+#include <ClientSettings.hpp>
+#include <LocalTransport.hpp>
 
 namespace Pong
 {
@@ -49,13 +62,15 @@ namespace Pong
 	public:
 
 		// Friend classes
-		friend class InitMessageListener;
+		friend class BaselineMessageListener;
+		friend class TimeSyncMessageListener;
+		friend class SnapshotMessageListener;
 
 		////////////////////////////////////////////////////////////////
-		/// \brief Default constructor.
+		/// \brief Constructor.
 		///
 		////////////////////////////////////////////////////////////////
-		Client( );
+		Client( const ClientSettings & p_Settings = ClientSettings( ) );
 
 		////////////////////////////////////////////////////////////////
 		/// \brief Destructor.
@@ -72,16 +87,167 @@ namespace Pong
 						const Bit::Uint16 p_Port,
 						const Bit::Time & p_Timeout );
 
+		////////////////////////////////////////////////////////////////
+		/// \brief Join the last server again, after a lost connection.
+		///
+		/// The resume token of the last join gets the player slot back,
+		/// if the server still keeps it.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Resume( );
+
 		////////////////////////////////////////////////////////////////
 		/// \brief Run the game client.
 		///
 		////////////////////////////////////////////////////////////////
 		Bit::Bool Run( );
 
+		////////////////////////////////////////////////////////////////
+		/// \brief Start moving the own player.
+		///
+		/// Inputs are stamped with the server tick and the offset
+		/// within it, the server applies them at the same offset.
+		///
+		////////////////////////////////////////////////////////////////
+		void SendMove( const eDirection p_Direction );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Stop moving the own player.
+		///
+		////////////////////////////////////////////////////////////////
+		void SendStopMove( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the player slot given by the server, 0 or 1.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint16 GetUserId( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get a player, 0 or 1.
+		///
+		////////////////////////////////////////////////////////////////
+		Player * GetPlayer( const Bit::SizeType p_Index ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get a ball.
+		///
+		////////////////////////////////////////////////////////////////
+		Ball * GetBall( const Bit::SizeType p_Index ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of balls.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetBallCount( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Send a time sync ping if one is due.
+		///
+		/// Called every frame, pings are sent frequently until
+		/// synchronized, then once a second to follow the drift.
+		///
+		////////////////////////////////////////////////////////////////
+		void UpdateTimeSync( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Acknowledge the snapshots received since the last call.
+		///
+		/// Called every frame, the server adapts the snapshot rate
+		/// and detail to the acknowledgements.
+		///
+		////////////////////////////////////////////////////////////////
+		void SendSnapshotAck( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if the server time is known.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool IsTimeSynchronized( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the current time of the server clock.
+		///
+		/// Never goes backwards, even if the estimate is corrected.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Time ServerTimeNow( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the tick the server is currently at.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 ServerTickNow( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the tick the server is currently at,
+		///		   and how far into the tick it is.
+		///
+		/// \param p_Offset Set to the microseconds since the start of the tick.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 ServerTickNow( Bit::Uint32 & p_Offset );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the smoothed round trip time to the server.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Time GetRoundTripTime( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the times between the frames of the last run.
+		///
+		////////////////////////////////////////////////////////////////
+		const FrameHistogram & GetFrameTimes( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the work times of the frames of the last run, without the pacing.
+		///
+		////////////////////////////////////////////////////////////////
+		const FrameHistogram & GetFrameCosts( ) const;
+
 	private:
 
+		// Private structures
+		struct HeadlessShape
+		{
+			Bit::Vector2f32	Position;
+			Bit::Float32	Rotation;
+		};
+
 		// Private functions
 
+		////////////////////////////////////////////////////////////////
+		/// \brief Handle the messages of the local transport.
+		///
+		////////////////////////////////////////////////////////////////
+		void ReceiveLocalMessages( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Send a message over the local transport.
+		///
+		/// A message that does not fit sets the overflow of the
+		/// transport and is dropped with the ones after it,
+		/// ReceiveLocalMessages then joins again.
+		///
+		/// \return false if not joined locally,
+		///		send it over the network.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool SendLocal( const LocalMessage::eType p_Type, const Packet & p_Message );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Handle the window events.
+		///
+		////////////////////////////////////////////////////////////////
+		void HandleEvents( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Draw the shapes, or only transform them if headless.
+		///
+		////////////////////////////////////////////////////////////////
+		void Draw( );
+
 		////////////////////////////////////////////////////////////////
 		/// \brief Create graphics
 		///
@@ -94,17 +260,57 @@ namespace Pong
 		////////////////////////////////////////////////////////////////
 		void DestroyGraphics( );
 
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the local clock, in microseconds.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Int64 GetLocalTime( );
+
 		// Private variables
+		ClientSettings					m_Settings;
 		Server *						m_pServer;
+		EntityStore<Ball>				m_Balls;
+		EntityStore<Player>				m_Players;
 		Ball *							m_pBall;
 		Player *						m_pPlayers[ 2 ];
-		//Bit::ThreadValue<Bit::Uint16>	m_UserId;
+		Bit::ThreadValue<Bit::Uint16>	m_UserId;
 		Bit::ThreadValue<Bit::Bool>		m_Initialized;
+		Bit::Uint64						m_ResumeToken;		///< Token of the player slot, 0 for none.
+		Bit::Address					m_Address;
+		Bit::Uint16						m_Port;
+		Bit::Time						m_Timeout;
 		Bit::Semaphore					m_InitSemaphore;
-		InitMessageListener				m_InitMessageListener;
+		BaselineMessageListener			m_BaselineMessageListener;
+		BatchMessageListener			m_BatchMessageListener;
 		Bit::SimpleRenderWindow *		m_pWindow;
+		GameMode::eMode					m_GameMode;
+		Obstacles						m_Obstacles;
 		Bit::Shape *					m_pPlayerShapes[ 2 ];
-		Bit::Shape *					m_pBallShape;
+		std::vector<Bit::Shape *>		m_BallShapes;
+		std::vector<Bit::Shape *>		m_ObstacleShapes;
+		std::vector<HeadlessShape>		m_HeadlessShapes;
+		FrameHistogram					m_FrameTimes;
+		FrameHistogram					m_FrameCosts;
+		AllocationReport				m_AllocationReport;
+		Bit::Timer						m_Clock;
+		Bit::Mutex						m_TimeSyncMutex;	///< Guards the time sync variables below.
+		TimeSync						m_TimeSync;
+		TimeSyncMessageListener			m_TimeSyncMessageListener;
+		Bit::Uint32						m_PingSequence;
+		Bit::Int64						m_LastPingTime;
+		Bit::Uint32						m_LastPongSequence;
+		Bit::Int64						m_LastServerTime;
+		Bit::Uint32						m_ServerTick;
+		Bit::Int64						m_ServerTickTime;
+		Bit::Uint32						m_TickInterval;
+		SnapshotMessageListener			m_SnapshotMessageListener;
+		LocalTransport *				m_pLocalTransport;	///< Of the server hosted by this process, NULL over the network.
+		BatchMessageListener			m_LocalBatchMessageListener;
+		SnapshotMessageListener			m_LocalSnapshotMessageListener;
+		Bit::Mutex						m_SnapshotMutex;	///< Guards the snapshot acknowledgement below.
+		Bit::Uint32						m_SnapshotAck;		///< Newest received snapshot sequence.
+		Bit::Uint32						m_SnapshotAckBits;	///< Received snapshots before the newest, bit 0 is the previous one.
+		Bit::Bool						m_SnapshotAckPending;
 
 	};
 
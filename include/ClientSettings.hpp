@@ -21,47 +21,39 @@
 //    source distribution.
 // ///////////////////////////////////////////////////////////////////////////
 
-#include <InitMessageListener.hpp>
-#include <Client.hpp>
-#include <Bit/System/MemoryLeak.hpp>
+#ifndef PONG_CLIENT_SETTINGS_HPP
+#define PONG_CLIENT_SETTINGS_HPP
+
+#include <Bit/Build.hpp>
 
 namespace Pong
 {
-	InitMessageListener::InitMessageListener( Client * p_pClient ) :
-		m_pClient( p_pClient )
-	{
-	}
 
-	void InitMessageListener::HandleMessage( Bit::Net::HostMessageDecoder & p_Message )
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Pong client settings.
+	///
+	////////////////////////////////////////////////////////////////
+	struct ClientSettings
 	{
-		// Ignore the message if already initialized.
-		/*if( m_pClient->m_Initialized.Get( ) == true )
-		{
-			return;
-		}
 
-		// Error check the message size
-		if( p_Message.GetMessageSize( ) < 4 )
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor, default settings.
+		///
+		////////////////////////////////////////////////////////////////
+		ClientSettings( ) :
+			FrameRate( 60 ),
+			Headless( false ),
+			FrameCount( 0 )
 		{
-			return;
 		}
-		
-		// Read the user id
-		Bit::Int32 userId = p_Message.ReadInt( );
 
-		// Error check the user id
-		if( userId < 0 || userId > 1 )
-		{
-			m_pClient->m_Initialized.Set( false );
-			m_pClient->m_InitSemaphore.Release( );
-			return;
-		}
+		Bit::Uint32		FrameRate;	///< Frames per second, 0 for unlimited. Set to the refresh rate to line up with the display.
+		Bit::Bool		Headless;	///< Run the frames without a window, for benchmarks on machines without a display.
+		Bit::Uint64		FrameCount;	///< Frames to run before returning, 0 to run until closed.
 
-		m_pClient->m_UserId.Set( static_cast<Bit::Uint16>( userId ) );
+	};
 
-		// Set the initialized flag and release the semaphore
-		m_pClient->m_Initialized.Set( true );
-		m_pClient->m_InitSemaphore.Release( );*/
-	}
+}
 
-}
\ No newline at end of file
+#endif
\ No newline at end of file
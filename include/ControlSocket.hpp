@@ -0,0 +1,123 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_CONTROL_SOCKET_HPP
+#define PONG_CONTROL_SOCKET_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Time.hpp>
+#include <string>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Local socket for administration commands.
+	///
+	/// Listens on a Unix domain socket. Each connection sends
+	/// a single command line and receives the reply, after which
+	/// the connection is closed, for example:
+	///
+	///     echo stats | nc -U netpong.sock
+	///
+	/// Unix domain sockets are not available to the Windows
+	/// toolset of this project, there Open always fails.
+	///
+	////////////////////////////////////////////////////////////////
+	class ControlSocket
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Maximum length of a command, in bytes.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::SizeType MaxCommandSize = 256;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		ControlSocket( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destructor, closes the socket.
+		///
+		////////////////////////////////////////////////////////////////
+		~ControlSocket( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Listen on a socket file.
+		///
+		/// A file left behind by a previous process is replaced.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Open( const std::string & p_Path );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Close the socket and remove the socket file.
+		///
+		////////////////////////////////////////////////////////////////
+		void Close( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if the socket is open.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool IsOpen( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Wait for a command.
+		///
+		/// \param p_Command Set to the command line, without the line break.
+		/// \param p_Timeout Maximum time to wait for a connection.
+		///
+		/// \return True if a command was received, it has to be answered by Reply.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Receive( std::string & p_Command, const Bit::Time & p_Timeout );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Send the reply of the received command and close its connection.
+		///
+		////////////////////////////////////////////////////////////////
+		void Reply( const std::string & p_Reply );
+
+	private:
+
+		// Copy not allowed
+		ControlSocket( const ControlSocket & );
+		ControlSocket & operator =( const ControlSocket & );
+
+		// Private variables
+		Bit::Int32		m_Handle;
+		Bit::Int32		m_Connection;	///< Connection of the received command, -1 for none.
+		std::string		m_Path;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
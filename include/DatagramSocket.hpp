@@ -0,0 +1,212 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_DATAGRAM_SOCKET_HPP
+#define PONG_DATAGRAM_SOCKET_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Time.hpp>
+#include <vector>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief UDP socket with batched receive and send.
+	///
+	/// On Linux the socket drains and flushes datagrams with
+	/// recvmmsg/sendmmsg, and waits for data with epoll,
+	/// one system call per batch instead of one per datagram.
+	/// Other platforms fall back to recvfrom/sendto loops and select.
+	///
+	/// Sends are queued and only go out on Flush, so all sends of
+	/// a tick can be flushed in one go.
+	/// Addresses are IPv4, in host byte order.
+	///
+	////////////////////////////////////////////////////////////////
+	class DatagramSocket
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Maximum size of a datagram, in bytes.
+		///
+		/// The largest UDP payload over IPv4, the snapshots and
+		/// baselines of the multi-ball matches exceed the MTU.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::SizeType MaxDatagramSize = 65507;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Number of datagrams per system call.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::SizeType BatchSize = 64;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Datagram structure.
+		///
+		////////////////////////////////////////////////////////////////
+		struct Datagram
+		{
+			Bit::Uint32		Address;
+			Bit::Uint16		Port;
+			Bit::SizeType	Size;
+			Bit::Uint8 *	Data;		///< MaxDatagramSize bytes, owned by the socket.
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Statistics structure.
+		///
+		////////////////////////////////////////////////////////////////
+		struct Statistics
+		{
+			Statistics( );
+
+			Bit::Uint64 ReceiveCalls;
+			Bit::Uint64 SendCalls;
+			Bit::Uint64 ReceivedDatagrams;
+			Bit::Uint64 SentDatagrams;
+			Bit::Uint64 ReceivedBytes;
+			Bit::Uint64 SentBytes;
+			Bit::Uint64 DroppedDatagrams;	///< Failed sends and truncated receives.
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		DatagramSocket( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destructor, closes the socket.
+		///
+		////////////////////////////////////////////////////////////////
+		~DatagramSocket( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Open and bind the socket.
+		///
+		/// \param p_Port Local port, 0 for any port.
+		/// \param p_Address Local address, 0 for any address.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Open( const Bit::Uint16 p_Port, const Bit::Uint32 p_Address = 0 );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Close the socket.
+		///
+		////////////////////////////////////////////////////////////////
+		void Close( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if the socket is open.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool IsOpen( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the bound local port.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint16 GetPort( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Wait until there is data to receive.
+		///
+		/// \return true if data is available, false on timeout.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Wait( const Bit::Time & p_Timeout );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Receive a batch of datagrams, without blocking.
+		///
+		/// The received datagrams are valid until the next call.
+		///
+		/// \return Number of received datagrams.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType Receive( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get a received datagram.
+		///
+		////////////////////////////////////////////////////////////////
+		const Datagram & GetReceived( const Bit::SizeType p_Index ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Queue a datagram for sending.
+		///
+		/// The queue is flushed if it is full.
+		///
+		/// \return false if the datagram is too large.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Queue(	const Bit::Uint32 p_Address, const Bit::Uint16 p_Port,
+							const void * p_pData, const Bit::SizeType p_Size );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Send all queued datagrams.
+		///
+		/// \return Number of sent datagrams.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType Flush( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of queued datagrams.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetQueuedCount( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the statistics.
+		///
+		////////////////////////////////////////////////////////////////
+		const Statistics & GetStatistics( ) const;
+
+	private:
+
+		// Copy not allowed
+		DatagramSocket( const DatagramSocket & );
+		DatagramSocket & operator =( const DatagramSocket & );
+
+		// Private variables
+		Bit::Int64				m_Handle;
+		Bit::Int32				m_Poll;
+		Bit::Uint16				m_Port;
+		Bit::Uint8 *			m_pBuffer;		///< Data of the received and the queued datagrams, left uninitialized.
+		std::vector<Datagram>	m_Received;
+		std::vector<Datagram>	m_Queued;
+		Bit::SizeType			m_ReceivedCount;
+		Bit::SizeType			m_QueuedCount;
+		Statistics				m_Statistics;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
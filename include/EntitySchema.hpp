@@ -0,0 +1,206 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_ENTITY_SCHEMA_HPP
+#define PONG_ENTITY_SCHEMA_HPP
+
+#include <Bit/Build.hpp>
+#include <Ball.hpp>
+#include <Player.hpp>
+#include <string>
+#include <cstring>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Fixed size field of a schema record.
+	///
+	/// Stores the value little endian at a constant offset
+	/// from the start of the record, without any bounds checks.
+	///
+	////////////////////////////////////////////////////////////////
+	template<typename T, Bit::SizeType Offset>
+	struct SchemaField
+	{
+		typedef T Type;
+
+		static const Bit::SizeType Begin = Offset;
+		static const Bit::SizeType End = Offset + sizeof( T );
+
+		static void Write( Bit::Uint8 * p_pRecord, const T p_Value )
+		{
+			Bit::Uint8 bytes[ sizeof( T ) ];
+			std::memcpy( bytes, &p_Value, sizeof( T ) );
+			for( Bit::SizeType i = 0; i < sizeof( T ); i++ )
+			{
+				p_pRecord[ Offset + i ] = bytes[ IsLittleEndian( ) ? i : sizeof( T ) - 1 - i ];
+			}
+		}
+
+		static T Read( const Bit::Uint8 * p_pRecord )
+		{
+			Bit::Uint8 bytes[ sizeof( T ) ];
+			for( Bit::SizeType i = 0; i < sizeof( T ); i++ )
+			{
+				bytes[ IsLittleEndian( ) ? i : sizeof( T ) - 1 - i ] = p_pRecord[ Offset + i ];
+			}
+			T value;
+			std::memcpy( &value, bytes, sizeof( T ) );
+			return value;
+		}
+
+	private:
+
+		static Bit::Bool IsLittleEndian( )
+		{
+			const Bit::Uint16 value = 1;
+			return *reinterpret_cast<const Bit::Uint8 *>( &value ) == 1;
+		}
+
+	};
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Record layouts of the snapshot message.
+	///
+	/// Every field is placed directly after the previous one,
+	/// see Snapshot for how the records are put together.
+	///
+	////////////////////////////////////////////////////////////////
+	namespace SnapshotSchema
+	{
+		struct Header
+		{
+			typedef SchemaField<Bit::Uint32, 0>						Sequence;
+			typedef SchemaField<Bit::Uint32, Sequence::End>			Tick;
+			typedef SchemaField<Bit::Uint8, Tick::End>				Level;
+			typedef SchemaField<Bit::Uint16, Level::End>			FirstBall;
+			typedef SchemaField<Bit::Uint16, FirstBall::End>		BallCount;
+			typedef SchemaField<Bit::Uint16, BallCount::End>		TotalBallCount;
+
+			static const Bit::SizeType Size = TotalBallCount::End;
+		};
+
+		struct Player
+		{
+			typedef SchemaField<Bit::Float32, 0>					PositionX;
+			typedef SchemaField<Bit::Float32, PositionX::End>		PositionY;
+
+			static const Bit::SizeType Size = PositionY::End;
+		};
+
+		// Level 0.
+		struct Ball
+		{
+			typedef SchemaField<Bit::Float32, 0>					PositionX;
+			typedef SchemaField<Bit::Float32, PositionX::End>		PositionY;
+			typedef SchemaField<Bit::Float32, PositionY::End>		Rotation;
+
+			static const Bit::SizeType Size = Rotation::End;
+		};
+
+		// Level 1 and higher.
+		struct QuantizedBall
+		{
+			typedef SchemaField<Bit::Uint16, 0>						PositionX;
+			typedef SchemaField<Bit::Uint16, PositionX::End>		PositionY;
+
+			static const Bit::SizeType Size = PositionY::End;
+		};
+	}
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Replicated variables of an entity class.
+	///
+	/// Specialized once per entity, Visit calls the visitor
+	/// with the name and member pointer of every variable
+	/// that is replicated by the entity manager.
+	///
+	////////////////////////////////////////////////////////////////
+	template<typename T>
+	struct EntitySchema;
+
+	template<>
+	struct EntitySchema<Ball>
+	{
+		static const char * GetName( ) { return "Ball"; }
+
+		// The positions and rotations are sent with the snapshots.
+		template<typename Visitor>
+		static void Visit( Visitor & p_Visitor )
+		{
+			p_Visitor( "Size",		&Ball::Size );
+			p_Visitor( "Direction",	&Ball::Direction );
+		}
+	};
+
+	template<>
+	struct EntitySchema<Player>
+	{
+		static const char * GetName( ) { return "Player"; }
+
+		template<typename Visitor>
+		static void Visit( Visitor & p_Visitor )
+		{
+			p_Visitor( "Size",		&Player::Size );
+		}
+	};
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Shared schema of the client and the server.
+	///
+	////////////////////////////////////////////////////////////////
+	namespace Schema
+	{
+		////////////////////////////////////////////////////////////////
+		/// \brief Link and register all the entity classes.
+		///
+		////////////////////////////////////////////////////////////////
+		void Register( Bit::Net::EntityManager & p_EntityManager );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the hash of the entity schemas and snapshot records.
+		///
+		/// Covers the names, sizes and offsets of every field,
+		/// builds with different layouts get different hashes.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 GetHash( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the connection identifier, "NetPong-" and the hash in hex.
+		///
+		/// Used by both Connect and Start, a client built
+		/// with a different schema is refused by the server.
+		///
+		////////////////////////////////////////////////////////////////
+		const std::string & GetIdentifier( );
+	}
+
+}
+
+#endif
\ No newline at end of file
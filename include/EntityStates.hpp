@@ -0,0 +1,107 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_ENTITY_STATES_HPP
+#define PONG_ENTITY_STATES_HPP
+
+#include <Bit/Build.hpp>
+#include <vector>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Hot state of all balls, structure of arrays.
+	///
+	/// Element i belongs to the i:th ball of the entity store.
+	///
+	////////////////////////////////////////////////////////////////
+	struct BallStates
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Resize all arrays.
+		///
+		////////////////////////////////////////////////////////////////
+		void Resize( const Bit::SizeType p_Count )
+		{
+			PositionX.resize( p_Count, 0.0f );
+			PositionY.resize( p_Count, 0.0f );
+			Rotation.resize( p_Count, 0.0 );
+			Radius.resize( p_Count, 0.0f );
+		}
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of balls.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetCount( ) const
+		{
+			return PositionX.size( );
+		}
+
+		std::vector<Bit::Float32> PositionX;
+		std::vector<Bit::Float32> PositionY;
+		std::vector<Bit::Float64> Rotation;
+		std::vector<Bit::Float32> Radius;
+
+	};
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Hot state of all players, structure of arrays.
+	///
+	/// Element i belongs to the i:th player of the entity store.
+	///
+	////////////////////////////////////////////////////////////////
+	struct PlayerStates
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Resize all arrays.
+		///
+		////////////////////////////////////////////////////////////////
+		void Resize( const Bit::SizeType p_Count )
+		{
+			PositionX.resize( p_Count, 0.0f );
+			PositionY.resize( p_Count, 0.0f );
+		}
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of players.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetCount( ) const
+		{
+			return PositionX.size( );
+		}
+
+		std::vector<Bit::Float32> PositionX;
+		std::vector<Bit::Float32> PositionY;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,170 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_ENTITY_STORE_HPP
+#define PONG_ENTITY_STORE_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/Net/EntityManager.hpp>
+#include <string>
+#include <vector>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Owner of all entities of one type.
+	///
+	/// Entities are created through the entity manager by name,
+	/// and deleted by the store, either one by one or all at once
+	/// when the store is cleared or destroyed.
+	///
+	////////////////////////////////////////////////////////////////
+	template<typename T>
+	class EntityStore
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor.
+		///
+		/// \param p_EntityManager Entity manager that the type is linked to.
+		/// \param p_Name Linked name of the entity type.
+		///
+		////////////////////////////////////////////////////////////////
+		EntityStore( Bit::Net::EntityManager & p_EntityManager, const std::string & p_Name );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destructor, destroys all entities.
+		///
+		////////////////////////////////////////////////////////////////
+		~EntityStore( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Create an entity.
+		///
+		/// \return Pointer to the entity, NULL if the type is not linked.
+		///
+		////////////////////////////////////////////////////////////////
+		T * Create( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destroy the last created entity.
+		///
+		////////////////////////////////////////////////////////////////
+		void DestroyLast( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destroy all entities.
+		///
+		////////////////////////////////////////////////////////////////
+		void Clear( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of entities.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetCount( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get an entity, in order of creation.
+		///
+		////////////////////////////////////////////////////////////////
+		T * Get( const Bit::SizeType p_Index ) const;
+
+	private:
+
+		// Copy not allowed
+		EntityStore( const EntityStore & );
+		EntityStore & operator =( const EntityStore & );
+
+		// Private variables
+		Bit::Net::EntityManager &	m_EntityManager;
+		std::string					m_Name;
+		std::vector<T *>			m_Entities;
+
+	};
+
+	template<typename T>
+	EntityStore<T>::EntityStore( Bit::Net::EntityManager & p_EntityManager, const std::string & p_Name ) :
+		m_EntityManager( p_EntityManager ),
+		m_Name( p_Name )
+	{
+	}
+
+	template<typename T>
+	EntityStore<T>::~EntityStore( )
+	{
+		Clear( );
+	}
+
+	template<typename T>
+	T * EntityStore<T>::Create( )
+	{
+		T * pEntity = reinterpret_cast<T *>( m_EntityManager.CreateEntityByName( m_Name ) );
+		if( pEntity )
+		{
+			m_Entities.push_back( pEntity );
+		}
+		return pEntity;
+	}
+
+	template<typename T>
+	void EntityStore<T>::DestroyLast( )
+	{
+		if( m_Entities.empty( ) )
+		{
+			return;
+		}
+
+		delete m_Entities.back( );
+		m_Entities.pop_back( );
+	}
+
+	template<typename T>
+	void EntityStore<T>::Clear( )
+	{
+		// Destroy in reverse order of creation.
+		while( m_Entities.empty( ) == false )
+		{
+			DestroyLast( );
+		}
+	}
+
+	template<typename T>
+	Bit::SizeType EntityStore<T>::GetCount( ) const
+	{
+		return m_Entities.size( );
+	}
+
+	template<typename T>
+	T * EntityStore<T>::Get( const Bit::SizeType p_Index ) const
+	{
+		return m_Entities[ p_Index ];
+	}
+
+}
+
+#endif
\ No newline at end of file
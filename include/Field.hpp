@@ -0,0 +1,57 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_FIELD_HPP
+#define PONG_FIELD_HPP
+
+#include <Bit/Build.hpp>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Layout of the playing field, in meters.
+	///
+	////////////////////////////////////////////////////////////////
+	namespace Field
+	{
+		const Bit::Float32 Width			= 6.0f;
+		const Bit::Float32 Height			= 3.0f;
+		const Bit::Float32 BallRadius		= 0.20f;
+		const Bit::Float32 BallSpeed		= 2.0f;		///< Horizontal meters per second, the ball is served at half of it vertically.
+		const Bit::Float32 PlayerWidth		= 0.20f;
+		const Bit::Float32 PlayerHeight		= 0.64f;
+		const Bit::Float32 PlayerOffset		= 0.50f;	///< Distance between the side and the player.
+		const Bit::Float32 PlayerSpeed		= 2.0f;		///< Meters per second.
+		const Bit::Float32 BorderWidth		= 20.0f;
+		const Bit::Float32 BorderThickness	= 0.2f;
+
+		// Multi-ball mode
+		const Bit::Float32 SmallBallRadius	= 0.05f;
+		const Bit::Float32 SmallBallSpeed	= 1.5f;		///< Meters per second.
+	}
+
+}
+
+#endif
\ No newline at end of file
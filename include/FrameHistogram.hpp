@@ -0,0 +1,122 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_FRAME_HISTOGRAM_HPP
+#define PONG_FRAME_HISTOGRAM_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Time.hpp>
+#include <ostream>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Histogram of frame times.
+	///
+	/// Fixed buckets of a tenth of a millisecond up to 100 ms,
+	/// the last bucket holds everything longer.
+	/// Adding a frame never allocates.
+	///
+	////////////////////////////////////////////////////////////////
+	class FrameHistogram
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Number of buckets.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::SizeType BucketCount = 1000;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Width of a bucket, in microseconds.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::Uint64 BucketWidth = 100;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		FrameHistogram( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Add a frame.
+		///
+		////////////////////////////////////////////////////////////////
+		void Add( const Bit::Time & p_Time );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Remove all frames.
+		///
+		////////////////////////////////////////////////////////////////
+		void Reset( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of frames.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint64 GetCount( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the mean frame time.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Time GetMean( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the longest frame time.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Time GetMax( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get a percentile, the upper edge of its bucket.
+		///
+		/// \param p_Percentile Percentile, 0 to 100.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Time GetPercentile( const Bit::Float64 p_Percentile ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Print the summary and the histogram in 1 ms rows.
+		///
+		////////////////////////////////////////////////////////////////
+		void Print( std::ostream & p_Stream, const char * p_pName ) const;
+
+	private:
+
+		// Private variables
+		Bit::Uint32	m_Buckets[ BucketCount ];
+		Bit::Uint64	m_Count;
+		Bit::Uint64	m_Total;	///< Microseconds.
+		Bit::Uint64	m_Max;		///< Microseconds.
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,103 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_FRAME_PACER_HPP
+#define PONG_FRAME_PACER_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Timer.hpp>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Paces a loop to a target frame rate.
+	///
+	/// Frames are scheduled on a fixed grid of deadlines. The pacer
+	/// sleeps until shortly before the deadline and spins the rest,
+	/// the spin margin follows the measured oversleep of the system.
+	/// A loop falling behind by more than a frame starts a new grid
+	/// instead of rushing to catch up.
+	///
+	////////////////////////////////////////////////////////////////
+	class FramePacer
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor.
+		///
+		/// \param p_FrameRate Frames per second, 0 for unlimited.
+		///
+		////////////////////////////////////////////////////////////////
+		FramePacer( const Bit::Uint32 p_FrameRate );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Set the frame rate, 0 for unlimited.
+		///
+		////////////////////////////////////////////////////////////////
+		void SetFrameRate( const Bit::Uint32 p_FrameRate );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the frame rate, 0 for unlimited.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 GetFrameRate( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Wait for the next frame, called at the end of every frame.
+		///
+		////////////////////////////////////////////////////////////////
+		void Wait( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the time between the last two frames.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Time GetFrameTime( ) const;
+
+	private:
+
+		// Private constants
+		static const Bit::Uint64 MinSpinTime = 200;		///< Microseconds.
+		static const Bit::Uint64 MaxSpinTime = 4000;	///< Microseconds.
+
+		// Private functions
+		Bit::Uint64 GetTime( );
+
+		// Private variables
+		Bit::Timer	m_Clock;
+		Bit::Uint32	m_FrameRate;
+		Bit::Uint64	m_Period;		///< Microseconds between deadlines, 0 for unlimited.
+		Bit::Uint64	m_Deadline;		///< Next deadline, 0 before the first frame.
+		Bit::Uint64	m_LastFrame;
+		Bit::Uint64	m_FrameTime;
+		Bit::Uint64	m_Oversleep;	///< Smoothed oversleep of the system, in microseconds.
+
+	};
+
+}
+
+#endif
\ No newline at end of file
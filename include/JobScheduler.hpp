@@ -0,0 +1,182 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_JOB_SCHEDULER_HPP
+#define PONG_JOB_SCHEDULER_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Thread.hpp>
+#include <Bit/System/Mutex.hpp>
+#include <Bit/System/Semaphore.hpp>
+#include <AllocationTracker.hpp>
+#include <atomic>
+#include <vector>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Work-stealing job scheduler with a fixed pool of threads.
+	///
+	/// ParallelFor spreads the jobs evenly over the queues of the
+	/// workers and the calling thread, which works as well.
+	/// A thread takes jobs from the back of its own queue, and steals
+	/// from the front of the other queues when its own is empty,
+	/// so uneven jobs are balanced out.
+	/// ParallelFor returns when all jobs are done, a barrier.
+	///
+	////////////////////////////////////////////////////////////////
+	class JobScheduler
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Job function type, called with the job index.
+		///
+		////////////////////////////////////////////////////////////////
+		typedef void ( *JobFunction )( void * p_pContext, const Bit::SizeType p_Index );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		JobScheduler( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destructor, stops the threads.
+		///
+		////////////////////////////////////////////////////////////////
+		~JobScheduler( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Start the threads.
+		///
+		/// \param p_ThreadCount Number of threads including the calling
+		///		thread, 0 for one thread per core.
+		///
+		////////////////////////////////////////////////////////////////
+		void Start( const Bit::SizeType p_ThreadCount );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Stop the threads.
+		///
+		////////////////////////////////////////////////////////////////
+		void Stop( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of threads, including the calling thread.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetThreadCount( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Run jobs 0 to p_JobCount - 1 and wait for all of them.
+		///
+		/// Must only be called from one thread at a time.
+		///
+		////////////////////////////////////////////////////////////////
+		void ParallelFor( const Bit::SizeType p_JobCount, JobFunction p_Function, void * p_pContext );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Run jobs 0 to p_JobCount - 1 and wait for all of them.
+		///
+		/// \param p_Function Function object, called as p_Function( SizeType p_Index ).
+		///
+		////////////////////////////////////////////////////////////////
+		template<typename Function>
+		void ParallelFor( const Bit::SizeType p_JobCount, Function & p_Function );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of jobs stolen from other queues.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint64 GetStealCount( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the allocations made by jobs on the worker threads.
+		///
+		/// Jobs on the calling thread count towards its own counters.
+		///
+		////////////////////////////////////////////////////////////////
+		AllocationCounters GetWorkerAllocations( ) const;
+
+	private:
+
+		// Private structures
+		struct Queue
+		{
+			Bit::Mutex					Mutex;
+			std::vector<Bit::SizeType>	Jobs;
+			Bit::SizeType				Front;
+			Bit::SizeType				Back;
+		};
+
+		struct Worker
+		{
+			Bit::Thread		Thread;
+			Bit::Semaphore	Wake;
+		};
+
+		// Private functions
+		template<typename Function>
+		static void CallFunction( void * p_pContext, const Bit::SizeType p_Index );
+		void WorkerLoop( Worker * p_pWorker, const Bit::SizeType p_Queue );
+		Bit::Bool RunJobs( const Bit::SizeType p_Queue );
+		Bit::Bool PopJob( const Bit::SizeType p_Queue, Bit::SizeType & p_Job );
+		Bit::Bool StealJob( const Bit::SizeType p_Queue, Bit::SizeType & p_Job );
+
+		// Copy not allowed
+		JobScheduler( const JobScheduler & );
+		JobScheduler & operator =( const JobScheduler & );
+
+		// Private variables
+		std::vector<Queue *>			m_Queues;	///< Queue 0 belongs to the calling thread.
+		std::vector<Worker *>			m_Workers;
+		std::atomic<bool>				m_Running;
+		std::atomic<Bit::SizeType>		m_Pending;
+		std::atomic<Bit::Uint64>		m_StealCount;
+		std::atomic<Bit::Uint64>		m_WorkerAllocations;
+		std::atomic<Bit::Uint64>		m_WorkerFrees;
+		std::atomic<Bit::Uint64>		m_WorkerBytes;
+		JobFunction						m_Function;
+		void *							m_pContext;
+
+	};
+
+	template<typename Function>
+	void JobScheduler::ParallelFor( const Bit::SizeType p_JobCount, Function & p_Function )
+	{
+		ParallelFor( p_JobCount, &JobScheduler::CallFunction<Function>, &p_Function );
+	}
+
+	template<typename Function>
+	void JobScheduler::CallFunction( void * p_pContext, const Bit::SizeType p_Index )
+	{
+		( *static_cast<Function *>( p_pContext ) )( p_Index );
+	}
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_LOCAL_TRANSPORT_HPP
+#define PONG_LOCAL_TRANSPORT_HPP
+
+#include <Bit/Build.hpp>
+#include <MessageRing.hpp>
+#include <atomic>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Messages of the local transport.
+	///
+	/// The payloads are the same as of the network messages.
+	///
+	////////////////////////////////////////////////////////////////
+	namespace LocalMessage
+	{
+		enum eType
+		{
+			Move = 1,		///< Upstream.
+			StopMove = 2,	///< Upstream.
+			TimeSync = 3,	///< Upstream.
+			SnapshotAck = 4,///< Upstream.
+			Snapshot = 5,	///< Downstream.
+			Batch = 6		///< Downstream.
+		};
+	}
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief In-process transport between a server and a client.
+	///
+	/// Used when the client joins a server hosted by the same process.
+	/// The connection and the join still go over the network,
+	/// the messages of the match are passed through the rings instead.
+	/// The server writes the downstream ring on its send thread and
+	/// reads the upstream ring on its tick thread, the client the other
+	/// way around on its main thread. Each ring has a single writer.
+	///
+	/// The batches are reliable and ordered, they only go through
+	/// the ring. When a batch does not fit, the server drops the client
+	/// from the transport and sets Overflow, the client then reconnects.
+	/// The inputs of the client are ordered the same way, they only go
+	/// through the ring and the client sets Overflow when one does not fit.
+	/// The unreliable snapshots leave half of the ring to the batches,
+	/// and take the network when it is fuller.
+	///
+	////////////////////////////////////////////////////////////////
+	struct LocalTransport
+	{
+
+		LocalTransport( ) :
+			Upstream( 64 * 1024 ),
+			Downstream( 1024 * 1024 )
+		{
+			Overflow = false;
+		}
+
+		MessageRing			Upstream;	///< Client to server.
+		MessageRing			Downstream;	///< Server to client, a few seconds of snapshots.
+		std::atomic<bool>	Overflow;	///< Set when a batch or an input did not fit, reset by the client when joining.
+
+	};
+
+}
+
+#endif
\ No newline at end of file
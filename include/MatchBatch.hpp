@@ -0,0 +1,201 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_MATCH_BATCH_HPP
+#define PONG_MATCH_BATCH_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Time.hpp>
+#include <PhysicsQuality.hpp>
+#include <Player.hpp>
+#include <EntityStates.hpp>
+#include <Packet.hpp>
+#include <vector>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Steps many classic matches together.
+	///
+	/// The player and ball states of all matches are stored as
+	/// structure of arrays, match i owns ball i and players 2i and 2i + 1.
+	/// The player movement, the ball movement, the bounces off the
+	/// borders and the players, and the ball reset test run as SIMD
+	/// kernels over these arrays, AVX or SSE2 when the compiler
+	/// targets it, scalar otherwise, or when PONG_SIMD_SCALAR is defined.
+	///
+	/// The kernels do the operations of the scalar code in the same
+	/// order, so the results equal StepScalar bit for bit.
+	/// Check compares them over many ticks.
+	///
+	////////////////////////////////////////////////////////////////
+	class MatchBatch
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		MatchBatch( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Replace all matches by new ones, at their start states.
+		///
+		////////////////////////////////////////////////////////////////
+		void Create( const Bit::SizeType p_MatchCount );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Step all matches.
+		///
+		////////////////////////////////////////////////////////////////
+		void Step( const Bit::Time & p_Time );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Step the matches p_First to p_First + p_Count - 1.
+		///
+		/// Steps of disjoint ranges touch disjoint data,
+		/// and can run on different threads at the same time.
+		///
+		////////////////////////////////////////////////////////////////
+		void Step( const Bit::SizeType p_First, const Bit::SizeType p_Count, const Bit::Time & p_Time );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Step the matches p_First to p_First + p_Count - 1
+		///		one at a time, with the scalar code only.
+		///
+		/// The reference of the kernels, slower than Step.
+		///
+		////////////////////////////////////////////////////////////////
+		void StepScalar( const Bit::SizeType p_First, const Bit::SizeType p_Count, const Bit::Time & p_Time );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Set the input of a player.
+		///
+		////////////////////////////////////////////////////////////////
+		void SetPlayerInput(	const Bit::SizeType p_Match, const Bit::SizeType p_Player,
+								const Bit::Bool p_IsMoving, const eDirection p_Direction );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Set the velocity of a player.
+		///
+		/// \param p_Velocity Mean velocity over the next step, from -1 to 1
+		///		   times the player speed, for inputs changing within the step.
+		///
+		////////////////////////////////////////////////////////////////
+		void SetPlayerVelocity( const Bit::SizeType p_Match, const Bit::SizeType p_Player, const Bit::Float32 p_Velocity );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Set the physics quality of the following steps.
+		///
+		/// Not to be changed while a step runs.
+		///
+		////////////////////////////////////////////////////////////////
+		void SetPhysicsQuality( const PhysicsQuality & p_Quality );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of matches.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetMatchCount( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the ball states of all matches.
+		///
+		////////////////////////////////////////////////////////////////
+		const BallStates & GetBallStates( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the player states of all matches.
+		///
+		////////////////////////////////////////////////////////////////
+		const PlayerStates & GetPlayerStates( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Write the state of all matches to a packet.
+		///
+		/// Stores the ball positions and velocities,
+		/// the player positions and the player inputs.
+		///
+		////////////////////////////////////////////////////////////////
+		void SaveState( Packet & p_Packet ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Read the state of all matches from a packet.
+		///
+		/// The matches have to be created with the same match count
+		/// as when the state was saved.
+		///
+		/// \return False if the match count differs or the packet is too small.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool LoadState( Packet & p_Packet );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the name of the kernel instruction set.
+		///
+		////////////////////////////////////////////////////////////////
+		static const char * GetInstructionSet( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Compare Step with StepScalar.
+		///
+		/// Steps two batches of matches from the same random states
+		/// with the same random inputs, one with the kernels and
+		/// one with the scalar code, and compares their states
+		/// after every tick. Prints the first difference.
+		///
+		/// \return true if the states are equal after every tick.
+		///
+		////////////////////////////////////////////////////////////////
+		static Bit::Bool Check( const Bit::SizeType p_MatchCount, const Bit::Uint32 p_TickCount, const Bit::Uint32 p_Seed );
+
+	private:
+
+		// Copy not allowed
+		MatchBatch( const MatchBatch & );
+		MatchBatch & operator =( const MatchBatch & );
+
+		// Private functions
+		void CopyPaddles( const Bit::SizeType p_First, const Bit::SizeType p_Count );
+
+		// Private variables
+		Bit::SizeType				m_MatchCount;
+		BallStates					m_BallStates;
+		std::vector<Bit::Float32>	m_BallVelocityX;
+		std::vector<Bit::Float32>	m_BallVelocityY;
+		PlayerStates				m_PlayerStates;
+		std::vector<Bit::Float32>	m_PlayerVelocities;	///< Mean velocity over the step, -1 to 1.
+		std::vector<Bit::Float32>	m_PaddleX[ 2 ];		///< Player positions per side, for the kernels.
+		std::vector<Bit::Float32>	m_PaddleY[ 2 ];
+		std::vector<Bit::Uint8>		m_BallResets;
+		PhysicsQuality				m_PhysicsQuality;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
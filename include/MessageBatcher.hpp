@@ -0,0 +1,183 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_MESSAGE_BATCHER_HPP
+#define PONG_MESSAGE_BATCHER_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Mutex.hpp>
+#include <Packet.hpp>
+#include <vector>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Packs the outgoing messages of each recipient into frames.
+	///
+	/// Messages queued during a tick are appended to the current
+	/// frame of the recipient, as records of
+	/// [ type : 1 byte ][ size : 2 bytes ][ payload ].
+	/// A new frame is started when the record would not fit in the MTU.
+	/// Flush hands every filled frame to a sender, once per tick,
+	/// so a recipient receives as few datagrams as possible.
+	///
+	////////////////////////////////////////////////////////////////
+	class MessageBatcher
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Bytes of the MTU reserved for the IP, UDP and
+		///		Bit::Net message headers.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::SizeType HeaderReserve = 64;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Size of the record header, type and payload size.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::SizeType RecordHeaderSize = 3;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor.
+		///
+		/// \param p_Mtu Maximum transmission unit, in bytes.
+		///
+		////////////////////////////////////////////////////////////////
+		MessageBatcher( const Bit::SizeType p_Mtu = 1200 );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Set the maximum transmission unit, in bytes.
+		///
+		////////////////////////////////////////////////////////////////
+		void SetMtu( const Bit::SizeType p_Mtu );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of bytes available for records in a frame.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetFrameCapacity( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Start batching messages for the given user.
+		///
+		////////////////////////////////////////////////////////////////
+		void AddUser( const Bit::Uint16 p_UserId );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Stop batching messages for the given user,
+		///		pending messages are dropped.
+		///
+		////////////////////////////////////////////////////////////////
+		void RemoveUser( const Bit::Uint16 p_UserId );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Queue a message for the given user.
+		///
+		/// \return false if the user is unknown or the payload is too large.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Queue( const Bit::Uint16 p_UserId, const Bit::Uint8 p_Type, const Packet & p_Payload );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Queue a message for all users.
+		///
+		////////////////////////////////////////////////////////////////
+		void Broadcast( const Bit::Uint8 p_Type, const Packet & p_Payload );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Send all pending frames.
+		///
+		/// \param p_Sender Function object called as
+		///		p_Sender( const Bit::Uint16 p_UserId, const Packet & p_Frame ),
+		///		once per frame.
+		///
+		////////////////////////////////////////////////////////////////
+		template<typename Sender>
+		void Flush( Sender p_Sender );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the total number of queued messages.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint64 GetMessageCount( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the total number of sent frames.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint64 GetFrameCount( ) const;
+
+	private:
+
+		// Private structures
+		struct Recipient
+		{
+			Recipient( );
+
+			Bit::Bool			Active;
+			std::vector<Packet>	Frames;
+			Bit::SizeType		FrameCount;
+		};
+
+		// Private functions
+		void QueueRecord( Recipient & p_Recipient, const Bit::Uint8 p_Type, const Packet & p_Payload );
+
+		// Private variables
+		Bit::Mutex				m_Mutex;
+		Bit::SizeType			m_Mtu;
+		std::vector<Recipient>	m_Recipients;
+		Bit::Uint64				m_MessageCount;
+		Bit::Uint64				m_FrameCount;
+
+	};
+
+	template<typename Sender>
+	void MessageBatcher::Flush( Sender p_Sender )
+	{
+		m_Mutex.Lock( );
+
+		for( Bit::SizeType i = 0; i < m_Recipients.size( ); i++ )
+		{
+			Recipient & recipient = m_Recipients[ i ];
+
+			for( Bit::SizeType j = 0; j < recipient.FrameCount; j++ )
+			{
+				p_Sender( static_cast<Bit::Uint16>( i ), recipient.Frames[ j ] );
+				recipient.Frames[ j ].Clear( );
+			}
+
+			m_FrameCount += recipient.FrameCount;
+			recipient.FrameCount = 0;
+		}
+
+		m_Mutex.Unlock( );
+	}
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_MESSAGE_HANDLER_HPP
+#define PONG_MESSAGE_HANDLER_HPP
+
+#include <Packet.hpp>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Base class of Pong message handlers.
+	///
+	////////////////////////////////////////////////////////////////
+	class MessageHandler
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destructor
+		///
+		////////////////////////////////////////////////////////////////
+		virtual ~MessageHandler( )
+		{
+		}
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Handle message function
+		///
+		/// \param p_Message The message payload, positioned at the
+		///		first byte of the payload.
+		///
+		////////////////////////////////////////////////////////////////
+		virtual void HandleMessage( Packet & p_Message ) = 0;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
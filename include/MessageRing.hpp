@@ -0,0 +1,138 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_MESSAGE_RING_HPP
+#define PONG_MESSAGE_RING_HPP
+
+#include <Bit/Build.hpp>
+#include <atomic>
+#include <vector>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Lock-free ring buffer of messages, one writer and one reader.
+	///
+	/// Each message is a record of a header, the type and the size,
+	/// followed by the payload, in one contiguous block of the buffer.
+	/// A record that does not fit before the end of the buffer
+	/// starts over at the beginning, so the reader gets the payload
+	/// in place, without copying it.
+	///
+	/// The positions of the writer and the reader are published
+	/// with release stores and read with acquire loads,
+	/// on separate cache lines.
+	///
+	////////////////////////////////////////////////////////////////
+	class MessageRing
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Size of a record header, records are aligned to it.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::SizeType HeaderSize = 8;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor.
+		///
+		/// \param p_Capacity Size of the buffer in bytes,
+		///		rounded up to a power of two.
+		///
+		////////////////////////////////////////////////////////////////
+		MessageRing( const Bit::SizeType p_Capacity );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Write a message, writer only.
+		///
+		/// \return false if the ring is full, the message is not written.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Write( const Bit::Uint8 p_Type, const void * p_pData, const Bit::SizeType p_Size );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the oldest message, reader only.
+		///
+		/// The payload stays valid until Pop.
+		///
+		/// \return Pointer to the payload, NULL if the ring is empty.
+		///
+		////////////////////////////////////////////////////////////////
+		const Bit::Uint8 * Read( Bit::Uint8 & p_Type, Bit::SizeType & p_Size );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Remove the message returned by Read, reader only.
+		///
+		////////////////////////////////////////////////////////////////
+		void Pop( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Remove all written messages, reader only.
+		///
+		////////////////////////////////////////////////////////////////
+		void Clear( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the size of the buffer.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetCapacity( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the bytes in use, writer only.
+		///
+		/// The reader may free more of them at any time.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetUsedSize( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of messages not written, the ring was full.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint64 GetFullCount( ) const;
+
+	private:
+
+		// Copy not allowed
+		MessageRing( const MessageRing & );
+		MessageRing & operator =( const MessageRing & );
+
+		// Private variables
+		std::vector<Bit::Uint8>		m_Buffer;
+		Bit::SizeType				m_Mask;
+		std::atomic<Bit::SizeType>	m_WritePosition;	///< Written by the writer.
+		std::atomic<Bit::Uint64>	m_FullCount;
+		Bit::Uint8					m_Padding[ 64 ];	///< Keeps the positions on separate cache lines.
+		std::atomic<Bit::SizeType>	m_ReadPosition;		///< Written by the reader.
+		Bit::SizeType				m_RecordSize;		///< Size of the record returned by Read.
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,172 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_MULTI_BALL_MATCH_HPP
+#define PONG_MULTI_BALL_MATCH_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Time.hpp>
+#include <Player.hpp>
+#include <EntityStates.hpp>
+#include <UniformGrid.hpp>
+#include <Packet.hpp>
+#include <vector>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Static obstacles, axis aligned boxes.
+	///
+	////////////////////////////////////////////////////////////////
+	struct Obstacles
+	{
+		std::vector<Bit::Float32> MinX;
+		std::vector<Bit::Float32> MinY;
+		std::vector<Bit::Float32> MaxX;
+		std::vector<Bit::Float32> MaxY;
+	};
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Match of the multi-ball game mode.
+	///
+	/// Many balls bounce between the players, the borders and
+	/// static obstacles. Ball pairs are found by a uniform grid,
+	/// obstacles by a static grid, so a step costs O( n )
+	/// instead of O( n^2 ) for n balls.
+	///
+	////////////////////////////////////////////////////////////////
+	class MultiBallMatch
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		MultiBallMatch( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Create the players, balls and obstacles.
+		///
+		/// \param p_Seed Seed of the obstacle layout and ball directions.
+		///
+		////////////////////////////////////////////////////////////////
+		void Create(	const Bit::SizeType p_BallCount, const Bit::SizeType p_ObstacleCount,
+						const Bit::Uint32 p_Seed );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Step the match.
+		///
+		////////////////////////////////////////////////////////////////
+		void Step( const Bit::Time & p_Time );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Set the input of a player.
+		///
+		////////////////////////////////////////////////////////////////
+		void SetPlayerInput( const Bit::SizeType p_Player, const Bit::Bool p_IsMoving, const eDirection p_Direction );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Set the velocity of a player.
+		///
+		/// \param p_Velocity Mean velocity over the next step, from -1 to 1
+		///		   times the player speed, for inputs changing within the step.
+		///
+		////////////////////////////////////////////////////////////////
+		void SetPlayerVelocity( const Bit::SizeType p_Player, const Bit::Float32 p_Velocity );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the ball states.
+		///
+		////////////////////////////////////////////////////////////////
+		const BallStates & GetBallStates( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the player states.
+		///
+		////////////////////////////////////////////////////////////////
+		const PlayerStates & GetPlayerStates( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the obstacles.
+		///
+		////////////////////////////////////////////////////////////////
+		const Obstacles & GetObstacles( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Write the ball and player state to a packet.
+		///
+		/// The obstacles are not written, they are created
+		/// again from the seed.
+		///
+		////////////////////////////////////////////////////////////////
+		void SaveState( Packet & p_Packet ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Read the ball and player state from a packet.
+		///
+		/// The match has to be created with the same ball count
+		/// as when the state was saved.
+		///
+		/// \return False if the ball count differs or the packet is too small.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool LoadState( Packet & p_Packet );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Create the obstacle layout of a seed.
+		///
+		/// Used by both the server and the clients, which only
+		/// receive the seed and the obstacle count.
+		///
+		////////////////////////////////////////////////////////////////
+		static void CreateObstacles( const Bit::Uint32 p_Seed, const Bit::SizeType p_Count, Obstacles & p_Obstacles );
+
+	private:
+
+		// Private functions
+		void CollideBalls( const Bit::SizeType p_A, const Bit::SizeType p_B );
+		void CollideBox(	const Bit::SizeType p_Ball,
+							const Bit::Float32 p_MinX, const Bit::Float32 p_MinY,
+							const Bit::Float32 p_MaxX, const Bit::Float32 p_MaxY );
+		void ResetBall( const Bit::SizeType p_Ball );
+
+		// Private variables
+		BallStates					m_BallStates;
+		std::vector<Bit::Float32>	m_VelocityX;
+		std::vector<Bit::Float32>	m_VelocityY;
+		PlayerStates				m_PlayerStates;
+		Bit::Float32				m_PlayerVelocities[ 2 ];
+		Obstacles					m_Obstacles;
+		UniformGrid					m_BallGrid;
+		UniformGrid					m_ObstacleGrid;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
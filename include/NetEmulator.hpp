@@ -0,0 +1,222 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_NET_EMULATOR_HPP
+#define PONG_NET_EMULATOR_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Time.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Bit/System/Thread.hpp>
+#include <Bit/System/Mutex.hpp>
+#include <DatagramSocket.hpp>
+#include <map>
+#include <queue>
+#include <vector>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Network conditions of one direction of a link.
+	///
+	////////////////////////////////////////////////////////////////
+	struct NetConditions
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor, a perfect network.
+		///
+		////////////////////////////////////////////////////////////////
+		NetConditions( );
+
+		Bit::Time		Latency;		///< One way delay.
+		Bit::Time		Jitter;			///< Maximum random deviation from the latency, does not reorder.
+		Bit::Float32	LossRate;		///< Chance of a datagram being lost, 0 to 1.
+		Bit::Float32	DuplicateRate;	///< Chance of a datagram being sent twice, 0 to 1.
+		Bit::Float32	ReorderRate;	///< Chance of a datagram being held back, 0 to 1.
+		Bit::Time		ReorderDelay;	///< Extra delay of held back datagrams, later datagrams overtake them.
+		Bit::Uint32		Bandwidth;		///< Bytes per second, 0 for unlimited.
+		Bit::Time		MaxQueueDelay;	///< Datagrams queued longer than this by the bandwidth cap are dropped.
+
+	};
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Loopback UDP proxy emulating network conditions.
+	///
+	/// Clients connect to the proxy port instead of the server.
+	/// Every client gets its own socket towards the server,
+	/// so the server sees one address per client. Sessions without
+	/// datagrams for 30 seconds are closed.
+	/// The datagrams of both directions are delayed, lost, duplicated,
+	/// reordered and rate limited by the conditions of the direction.
+	///
+	/// The proxy runs on its own thread, with a resolution of about a millisecond.
+	///
+	////////////////////////////////////////////////////////////////
+	class NetEmulator
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Link direction enumerator.
+		///
+		////////////////////////////////////////////////////////////////
+		enum eLink
+		{
+			Upstream,	///< Client to server.
+			Downstream,	///< Server to client.
+			LinkCount
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Statistics structure, per direction.
+		///
+		////////////////////////////////////////////////////////////////
+		struct Statistics
+		{
+			Statistics( );
+
+			Bit::Uint64 Datagrams;	///< Datagrams entering the link.
+			Bit::Uint64 Bytes;		///< Bytes entering the link.
+			Bit::Uint64 Delivered;	///< Datagrams leaving the link, duplicates included.
+			Bit::Uint64 Lost;
+			Bit::Uint64 Duplicated;
+			Bit::Uint64 Reordered;
+			Bit::Uint64 Dropped;	///< Dropped by the bandwidth cap.
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		NetEmulator( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destructor, stops the proxy.
+		///
+		////////////////////////////////////////////////////////////////
+		~NetEmulator( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Start the proxy.
+		///
+		/// \param p_Port Port the clients connect to.
+		/// \param p_ServerAddress Address of the server, in host byte order.
+		/// \param p_ServerPort Port of the server.
+		/// \param p_Seed Seed of the random conditions.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Start(	const Bit::Uint16 p_Port, const Bit::Uint32 p_ServerAddress,
+							const Bit::Uint16 p_ServerPort, const Bit::Uint32 p_Seed = 1 );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Stop the proxy, pending datagrams are discarded.
+		///
+		////////////////////////////////////////////////////////////////
+		void Stop( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Set the conditions of a direction, can be changed while running.
+		///
+		////////////////////////////////////////////////////////////////
+		void SetConditions( const eLink p_Link, const NetConditions & p_Conditions );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the conditions of a direction.
+		///
+		////////////////////////////////////////////////////////////////
+		NetConditions GetConditions( const eLink p_Link );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the statistics of a direction.
+		///
+		////////////////////////////////////////////////////////////////
+		Statistics GetStatistics( const eLink p_Link );
+
+	private:
+
+		// Private constants
+		static const Bit::Uint64 SessionTimeout = 30000000;	///< Microseconds without datagrams before a session expires.
+
+		// Private structures
+		struct Session
+		{
+			Bit::Uint32		Address;
+			Bit::Uint16		Port;
+			DatagramSocket	Socket;		///< Socket towards the server.
+			Bit::Uint64		LastActive;	///< Time of the last datagram of either direction, in microseconds.
+			Bit::SizeType	Pending;	///< Delayed datagrams of the session.
+		};
+
+		struct Delayed
+		{
+			Bit::Uint64				Release;	///< Release time, in microseconds.
+			Bit::Uint64				Sequence;
+			eLink					Link;
+			Session *				pSession;
+			std::vector<Bit::Uint8>	Data;
+
+			Bit::Bool operator <( const Delayed & p_Delayed ) const;
+		};
+
+		// Private functions
+		void Run( );
+		void Schedule(	const eLink p_Link, const NetConditions & p_Conditions, Session * p_pSession,
+						const DatagramSocket::Datagram & p_Datagram, const Bit::Uint64 p_Now );
+		void ExpireSessions( const Bit::Uint64 p_Now );
+		Bit::Float32 NextChance( );
+		Bit::Uint64 GetTime( );
+
+		// Copy not allowed
+		NetEmulator( const NetEmulator & );
+		NetEmulator & operator =( const NetEmulator & );
+
+		// Private typedefs
+		typedef std::map<Bit::Uint64, Session *> SessionMap;
+
+		// Private variables
+		Bit::Thread				m_Thread;
+		Bit::Mutex				m_Mutex;		///< Guards the conditions, statistics and running flag.
+		Bit::Bool				m_Running;
+		Bit::Timer				m_Timer;
+		DatagramSocket			m_Socket;		///< Socket towards the clients.
+		Bit::Uint32				m_ServerAddress;
+		Bit::Uint16				m_ServerPort;
+		Bit::Uint32				m_Random;
+		Bit::Uint64				m_Sequence;
+		SessionMap				m_Sessions;
+		std::priority_queue<Delayed>	m_Delayed;
+		NetConditions			m_Conditions[ LinkCount ];
+		Statistics				m_Statistics[ LinkCount ];
+		Bit::Uint64				m_LastRelease[ LinkCount ];	///< Keeps jittered datagrams in order.
+		Bit::Uint64				m_LinkFree[ LinkCount ];	///< Time the bandwidth capped link is free.
+
+	};
+
+}
+
+#endif
\ No newline at end of file
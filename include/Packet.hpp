@@ -0,0 +1,165 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_PACKET_HPP
+#define PONG_PACKET_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Vector2.hpp>
+#include <vector>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Byte buffer for Pong's own network messages.
+	///
+	/// Values are stored in little endian byte order.
+	/// Reading past the end of the buffer returns zero values
+	/// and marks the packet as invalid.
+	///
+	////////////////////////////////////////////////////////////////
+	class Packet
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		Packet( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Clear the data and rewind the read position.
+		///
+		/// The allocated memory is kept, for reuse.
+		///
+		////////////////////////////////////////////////////////////////
+		void Clear( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Reserve memory for the given number of bytes.
+		///
+		////////////////////////////////////////////////////////////////
+		void Reserve( const Bit::SizeType p_Size );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Replace the data with a copy of the given bytes.
+		///
+		////////////////////////////////////////////////////////////////
+		void Assign( const void * p_pData, const Bit::SizeType p_Size );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Resize the data, new bytes are zero initialized.
+		///
+		////////////////////////////////////////////////////////////////
+		void Resize( const Bit::SizeType p_Size );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Write functions.
+		///
+		////////////////////////////////////////////////////////////////
+		void WriteByte( const Bit::Uint8 p_Value );
+		void WriteUint16( const Bit::Uint16 p_Value );
+		void WriteUint32( const Bit::Uint32 p_Value );
+		void WriteUint64( const Bit::Uint64 p_Value );
+		void WriteInt( const Bit::Int32 p_Value );
+		void WriteFloat( const Bit::Float32 p_Value );
+		void WriteVector2( const Bit::Vector2f32 & p_Value );
+		void WriteArray( const void * p_pData, const Bit::SizeType p_Size );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Read functions.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint8 ReadByte( );
+		Bit::Uint16 ReadUint16( );
+		Bit::Uint32 ReadUint32( );
+		Bit::Uint64 ReadUint64( );
+		Bit::Int32 ReadInt( );
+		Bit::Float32 ReadFloat( );
+		Bit::Vector2f32 ReadVector2( );
+		Bit::Bool ReadArray( void * p_pData, const Bit::SizeType p_Size );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Skip bytes at the read position.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Skip( const Bit::SizeType p_Size );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Move the read position to the beginning.
+		///
+		////////////////////////////////////////////////////////////////
+		void Rewind( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the data pointer.
+		///
+		////////////////////////////////////////////////////////////////
+		const Bit::Uint8 * GetData( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the writable data pointer.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint8 * GetData( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the size of the data, in bytes.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetSize( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the read position.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetReadPosition( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of bytes left to read.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetRemainingSize( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if all reads so far were inside the data.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool IsValid( ) const;
+
+	private:
+
+		// Private variables
+		std::vector<Bit::Uint8>	m_Data;
+		Bit::SizeType			m_ReadPosition;
+		Bit::Bool				m_Valid;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,59 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_PHYSICS_QUALITY_HPP
+#define PONG_PHYSICS_QUALITY_HPP
+
+#include <Bit/Build.hpp>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Cost and accuracy of a physics step.
+	///
+	/// Each step is split into the substeps, in all game modes.
+	/// The matches resolve their collisions directly,
+	/// the substeps are the only cost to scale.
+	///
+	////////////////////////////////////////////////////////////////
+	struct PhysicsQuality
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		PhysicsQuality( const Bit::Uint32 p_Substeps = 1 ) :
+			Substeps( p_Substeps )
+		{
+		}
+
+		Bit::Uint32	Substeps;	///< Substeps per tick, at least 1.
+
+	};
+
+}
+
+#endif
\ No newline at end of file
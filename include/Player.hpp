@@ -26,6 +26,7 @@
 
 #include <Bit/Network/Net/Entity.hpp>
 #include <Bit/System/Vector2.hpp>
+#include <cstddef>
 
 namespace Pong
 {
@@ -54,6 +55,18 @@ namespace Pong
 		// Constructor.
 		Player();
 
+		////////////////////////////////////////////////////////////////
+		/// \brief Allocate players from the player block pool.
+		///
+		////////////////////////////////////////////////////////////////
+		static void * operator new( std::size_t p_Size );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Return players to the player block pool.
+		///
+		////////////////////////////////////////////////////////////////
+		static void operator delete( void * p_pPointer, std::size_t p_Size );
+
 		// Variables
 		Bit::Net::Variable<Bit::Vector2f32> Position;
 		Bit::Net::Variable<Bit::Vector2f32> Size;
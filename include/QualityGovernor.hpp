@@ -0,0 +1,166 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_QUALITY_GOVERNOR_HPP
+#define PONG_QUALITY_GOVERNOR_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Time.hpp>
+#include <PhysicsQuality.hpp>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Scales the physics quality to the tick budget.
+	///
+	/// The qualities between the maximum and the minimum form
+	/// a ladder of levels, level 0 is the maximum quality.
+	/// The load of a tick is its time divided by the budget.
+	/// The governor steps down a level as soon as a few ticks in a row
+	/// run close to the budget, and steps back up only after the
+	/// smoothed load stayed well below it for a while, so the
+	/// quality does not flap at the edge of the budget.
+	///
+	////////////////////////////////////////////////////////////////
+	class QualityGovernor
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Load above which a tick is too close to the budget.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::Uint32 HighLoadPercent = 85;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Smoothed load below which the quality can be raised.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::Uint32 LowLoadPercent = 60;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Ticks in a row above the high load to step down.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::Uint32 DowngradeTicks = 3;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Ticks below the low load to step up.
+		///
+		/// Doubled, up to 16 times, whenever a step up
+		/// is undone by the next step down.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::Uint32 UpgradeTicks = 120;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Statistics structure.
+		///
+		////////////////////////////////////////////////////////////////
+		struct Statistics
+		{
+			Statistics( );
+
+			Bit::Uint64	Downgrades;
+			Bit::Uint64	Upgrades;
+			Bit::Uint64	ReducedTicks;	///< Ticks stepped below the maximum quality.
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor, a single level of default quality.
+		///
+		////////////////////////////////////////////////////////////////
+		QualityGovernor( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Set the bounds and start at the maximum quality.
+		///
+		/// Each value of the minimum is raised to at most the maximum.
+		///
+		////////////////////////////////////////////////////////////////
+		void Create( const PhysicsQuality & p_Maximum, const PhysicsQuality & p_Minimum );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Add the time of a tick.
+		///
+		/// \return True if the quality level changed.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Update( const Bit::Time & p_TickTime, const Bit::Time & p_Budget );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the quality of the current level.
+		///
+		////////////////////////////////////////////////////////////////
+		const PhysicsQuality & GetQuality( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the current level, 0 is the maximum quality.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 GetLevel( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of levels.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 GetLevelCount( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the smoothed load, 1 is the full budget.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Float64 GetLoad( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the statistics.
+		///
+		////////////////////////////////////////////////////////////////
+		const Statistics & GetStatistics( ) const;
+
+	private:
+
+		// Private functions
+		void SetLevel( const Bit::Uint32 p_Level );
+
+		// Private variables
+		PhysicsQuality	m_Maximum;
+		PhysicsQuality	m_Minimum;
+		PhysicsQuality	m_Quality;
+		Bit::Uint32		m_Level;
+		Bit::Uint32		m_LevelCount;
+		Bit::Float64	m_Load;
+		Bit::Uint32		m_HighTicks;	///< Ticks in a row above the high load.
+		Bit::Uint32		m_LowTicks;		///< Ticks in a row with the smoothed load below the low load.
+		Bit::Uint32		m_UpgradeTicks;	///< Current ticks below the low load to step up.
+		Bit::Bool		m_Upgraded;		///< The last change was a step up.
+		Statistics		m_Statistics;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,224 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_ROLLBACK_CLIENT_HPP
+#define PONG_ROLLBACK_CLIENT_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Window/SimpleRenderWindow.hpp>
+#include <Bit/System/Timer.hpp>
+#include <RollbackSession.hpp>
+#include <DatagramSocket.hpp>
+#include <ClientSettings.hpp>
+#include <ServerSettings.hpp>
+#include <FrameHistogram.hpp>
+#include <Packet.hpp>
+#include <vector>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Client of a rollback match, played against a peer.
+	///
+	/// Both peers simulate the match with a RollbackSession,
+	/// one tick per frame, and send each other only their inputs
+	/// over a DatagramSocket. Every datagram repeats the local inputs
+	/// not yet acknowledged by the peer, so lost datagrams need
+	/// no resends. The peer ahead in ticks waits a frame now and
+	/// then, so both peers predict about as far ahead.
+	///
+	/// Every datagram also carries the player of the sender,
+	/// peers playing the same player are refused, and the checksum
+	/// of the latest confirmed state, see RollbackSession::GetChecksum.
+	/// Checksums differing from the local ones are reported as desyncs.
+	///
+	/// Headless clients are played by a bot.
+	///
+	////////////////////////////////////////////////////////////////
+	class RollbackClient
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Identifier of the rollback datagrams.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::Uint32 Magic = 0x4E50524B;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Milliseconds without datagrams before the peer is lost.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::Uint32 PeerTimeout = 5000;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		RollbackClient( const ClientSettings & p_Settings = ClientSettings( ) );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destructor.
+		///
+		////////////////////////////////////////////////////////////////
+		~RollbackClient( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Wait for the peer and create the match.
+		///
+		/// Both peers must pass the same match settings
+		/// and opposite players.
+		///
+		/// \param p_Port Local port.
+		/// \param p_PeerAddress Address of the peer, in host byte order.
+		/// \param p_PeerPort Port of the peer.
+		/// \param p_Match Mode, ball count, obstacle count and seed of the match.
+		/// \param p_LocalPlayer Player of this peer, 0 or 1.
+		/// \param p_Timeout Time to wait for the peer.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Connect(	const Bit::Uint16 p_Port, const Bit::Uint32 p_PeerAddress,
+							const Bit::Uint16 p_PeerPort, const ServerSettings & p_Match,
+							const Bit::SizeType p_LocalPlayer, const Bit::Time & p_Timeout );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Run the match, until closed or the peer is lost.
+		///
+		/// \return false if the peers desynchronized.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Run( );
+
+	private:
+
+		// Private constants
+		static const Bit::SizeType ChecksumHistory = 4;
+
+		// Private structures
+		struct HeadlessShape
+		{
+			Bit::Vector2f32	Position;
+			Bit::Float32	Rotation;
+		};
+
+		struct Checksum
+		{
+			Bit::Uint32	Tick;
+			Bit::Uint32	Value;
+		};
+
+		// Copy not allowed
+		RollbackClient( const RollbackClient & );
+		RollbackClient & operator =( const RollbackClient & );
+
+		// Private functions
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Send the unacknowledged local inputs.
+		///
+		////////////////////////////////////////////////////////////////
+		void SendInputs( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Receive the datagrams of the peer.
+		///
+		/// \return Number of datagrams received from the peer.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType ReceiveInputs( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Take the checksums of the newly confirmed states
+		///		and compare them with the checksum of the peer.
+		///
+		////////////////////////////////////////////////////////////////
+		void UpdateChecksums( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the local input, from the keys or the bot.
+		///
+		////////////////////////////////////////////////////////////////
+		RollbackSession::eInput GetLocalInput( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Handle the window events.
+		///
+		////////////////////////////////////////////////////////////////
+		void HandleEvents( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Draw the shapes, or only transform them if headless.
+		///
+		////////////////////////////////////////////////////////////////
+		void Draw( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Create graphics
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool CreateGraphics( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destroy graphics
+		///
+		////////////////////////////////////////////////////////////////
+		void DestroyGraphics( );
+
+		// Private variables
+		ClientSettings					m_Settings;
+		RollbackSession					m_Session;
+		DatagramSocket					m_Socket;
+		Packet							m_Packet;
+		Bit::Uint32						m_PeerAddress;
+		Bit::Uint16						m_PeerPort;
+		Bit::Uint32						m_MatchHash;		///< Hash of the match settings, datagrams of other matches are dropped.
+		Bit::Uint32						m_PeerAck;			///< Local inputs confirmed by the peer are of earlier ticks.
+		Bit::Uint32						m_PeerTick;			///< Latest tick of the peer.
+		Bit::Int32						m_PeerAdvantage;	///< Ticks the peer is ahead of this peer, as seen by the peer.
+		Bit::Uint64						m_WaitFrames;		///< Frames waited for the peer to catch up or to confirm.
+		Bit::Timer						m_PeerTimer;		///< Time since the last datagram of the peer.
+		Bit::Bool						m_SameSide;			///< The peer plays the player of this peer.
+		Checksum						m_Checksums[ ChecksumHistory ];	///< Latest local checksums, by tick.
+		Bit::Uint32						m_ChecksumTick;		///< Next tick to take the checksum of.
+		Bit::Uint32						m_PeerChecksumTick;	///< Tick of the latest checksum of the peer, 0 for none.
+		Bit::Uint32						m_PeerChecksum;
+		Bit::Uint32						m_CheckedTick;		///< Latest tick compared with the peer.
+		Bit::Uint64						m_Desyncs;
+		Bit::Bool						m_KeyUp;
+		Bit::Bool						m_KeyDown;
+		Bit::SimpleRenderWindow *		m_pWindow;
+		Bit::Shape *					m_pPlayerShapes[ 2 ];
+		std::vector<Bit::Shape *>		m_BallShapes;
+		std::vector<Bit::Shape *>		m_ObstacleShapes;
+		std::vector<HeadlessShape>		m_HeadlessShapes;
+		FrameHistogram					m_FrameTimes;
+		FrameHistogram					m_FrameCosts;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
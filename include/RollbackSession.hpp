@@ -0,0 +1,265 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_ROLLBACK_SESSION_HPP
+#define PONG_ROLLBACK_SESSION_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Time.hpp>
+#include <GameMode.hpp>
+#include <MatchBatch.hpp>
+#include <MultiBallMatch.hpp>
+#include <Packet.hpp>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Peer to peer match, simulated locally by both peers.
+	///
+	/// The peers exchange only their inputs. The local input is
+	/// applied at once, the remote input is predicted to repeat the
+	/// last confirmed one. When a confirmed remote input differs from
+	/// its prediction, the match state of that tick is restored and
+	/// the ticks since are simulated again.
+	///
+	/// The state before each tick is saved in a ring buffer,
+	/// with the SaveState functions of the matches. Both modes keep
+	/// their whole state in what they save, so a restored tick steps
+	/// exactly like the first time.
+	///
+	/// The session does no I/O, see RollbackClient.
+	///
+	////////////////////////////////////////////////////////////////
+	class RollbackSession
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Ticks of saved states and inputs.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::Uint32 HistorySize = 64;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Microseconds per tick, the tick rate of the server.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::Uint32 TickInterval = 16667;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Ticks to run ahead of the confirmed remote input.
+		///
+		/// The session stalls beyond this, see CanAdvance.
+		/// Less than half of the history, so the inputs not yet
+		/// confirmed by the remote peer are still in the history.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::Uint32 MaxPrediction = 30;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Ticks between the states compared by the peers, see GetChecksum.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::Uint32 ChecksumInterval = 30;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Input values.
+		///
+		////////////////////////////////////////////////////////////////
+		enum eInput
+		{
+			Stop,
+			MoveUp,
+			MoveDown
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Statistics structure.
+		///
+		////////////////////////////////////////////////////////////////
+		struct Statistics
+		{
+			Statistics( );
+
+			Bit::Uint64	Ticks;
+			Bit::Uint64	Rollbacks;			///< Mispredictions, each restoring a saved state.
+			Bit::Uint64	ResimulatedTicks;
+			Bit::Uint32	MaxRollbackTicks;	///< Most ticks simulated again by a single rollback.
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		RollbackSession( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Create the match, both peers must pass the same values.
+		///
+		/// \param p_Mode Game mode.
+		/// \param p_BallCount Balls, multi-ball mode only.
+		/// \param p_ObstacleCount Obstacles, multi-ball mode only.
+		/// \param p_Seed Seed of the obstacle layout, multi-ball mode only.
+		/// \param p_LocalPlayer Player of the local peer, 0 or 1.
+		///
+		////////////////////////////////////////////////////////////////
+		void Create(	const GameMode::eMode p_Mode, const Bit::SizeType p_BallCount,
+						const Bit::SizeType p_ObstacleCount, const Bit::Uint32 p_Seed,
+						const Bit::SizeType p_LocalPlayer );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if the next tick can be simulated.
+		///
+		/// False while the local tick is MaxPrediction ticks ahead
+		/// of the confirmed remote input.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool CanAdvance( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Set the local input of the next tick.
+		///
+		////////////////////////////////////////////////////////////////
+		void SetLocalInput( const eInput p_Input );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Add a confirmed remote input.
+		///
+		/// The inputs must be added in tick order, others are ignored.
+		/// Marks a rollback if the input was mispredicted.
+		///
+		/// \return false if the input was ignored.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool AddRemoteInput( const Bit::Uint32 p_Tick, const Bit::Uint8 p_Input );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Simulate the next tick.
+		///
+		/// Rolls back and simulates the mispredicted ticks again first.
+		///
+		////////////////////////////////////////////////////////////////
+		void Advance( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the next tick to simulate.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 GetTick( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the tick of the next expected remote input.
+		///
+		/// The remote inputs of all earlier ticks are confirmed.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 GetRemoteTick( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the checksum of the state before a confirmed tick.
+		///
+		/// The state is final once the inputs of all earlier ticks
+		/// are confirmed, peers simulating the same way get the same
+		/// checksum. A restore missing hidden state shows up as a
+		/// different checksum.
+		///
+		/// \return false if the tick is not confirmed yet, a rollback
+		///		is pending or the state is no longer in the history.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool GetChecksum( const Bit::Uint32 p_Tick, Bit::Uint32 & p_Checksum ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the local input of a tick still in the history.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint8 GetLocalInput( const Bit::Uint32 p_Tick ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the player of the local peer.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::SizeType GetLocalPlayer( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the game mode.
+		///
+		////////////////////////////////////////////////////////////////
+		GameMode::eMode GetMode( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the ball states of the latest tick.
+		///
+		////////////////////////////////////////////////////////////////
+		const BallStates & GetBallStates( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the player states of the latest tick.
+		///
+		////////////////////////////////////////////////////////////////
+		const PlayerStates & GetPlayerStates( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the obstacles, multi-ball mode only.
+		///
+		////////////////////////////////////////////////////////////////
+		const Obstacles & GetObstacles( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the statistics.
+		///
+		////////////////////////////////////////////////////////////////
+		const Statistics & GetStatistics( ) const;
+
+	private:
+
+		// Copy not allowed
+		RollbackSession( const RollbackSession & );
+		RollbackSession & operator =( const RollbackSession & );
+
+		// Private functions
+		void Simulate( const Bit::Uint32 p_Tick );
+		void SaveState( const Bit::Uint32 p_Tick );
+		void LoadState( const Bit::Uint32 p_Tick );
+
+		// Private variables
+		GameMode::eMode	m_Mode;
+		MatchBatch		m_Matches;				///< A single match, classic mode.
+		MultiBallMatch	m_MultiBallMatch;
+		Bit::SizeType	m_LocalPlayer;
+		Bit::Uint32		m_Tick;
+		Bit::Uint32		m_RemoteTick;
+		Bit::Uint32		m_RollbackTick;			///< Earliest mispredicted tick, NoRollback if none.
+		Bit::Uint8		m_LocalInput;
+		Bit::Uint8		m_Inputs[ 2 ][ HistorySize ];	///< Inputs by player and tick, predicted past the remote tick.
+		Packet			m_States[ HistorySize ];		///< State before each tick.
+		Statistics		m_Statistics;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
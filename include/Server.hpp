@@ -27,10 +27,31 @@
 #include <Bit/Build.hpp>
 #include <Bit/Network/net/Server.hpp>
 #include <Bit/System/Thread.hpp>
+#include <Bit/System/Mutex.hpp>
+#include <Bit/System/Semaphore.hpp>
+#include <Bit/System/Timer.hpp>
 #include <Bit/System/Keyboard.hpp>
-#include <Bit/System/Phys2/Scene.hpp>
 #include <Ball.hpp>
 #include <Player.hpp>
+#include <EntityStore.hpp>
+#include <MatchBatch.hpp>
+#include <MultiBallMatch.hpp>
+#include <Packet.hpp>
+#include <MessageBatcher.hpp>
+#include <SnapshotController.hpp>
+#include <JobScheduler.hpp>
+#include <AllocationTracker.hpp>
+#include <QualityGovernor.hpp>
+#include <Checkpoint.hpp>
+#include <ControlSocket.hpp>
+#include <LocalTransport.hpp>
+#include <TripleBuffer.hpp>
+#include <EntityStates.hpp>
+#include <ServerSettings.hpp>
+#include <map>
+#include <atomic>
+#include <string>
+#include <random>
 
 namespace Pong
 {
@@ -47,12 +68,36 @@ namespace Pong
 
 		// Friend classes
 		friend class PlayerMessageListener;
+		friend class JoinMessageListener;
+		friend class PingMessageListener;
+		friend class SnapshotAckMessageListener;
 
 		////////////////////////////////////////////////////////////////
-		/// \brief Default constructor.
+		/// \brief Tick statistics structure.
 		///
 		////////////////////////////////////////////////////////////////
-		Server( );
+		struct TickStatistics
+		{
+			TickStatistics( );
+
+			Bit::Uint64	Ticks;
+			Bit::Uint64	Overruns;		///< Ticks taking longer than the tick interval.
+			Bit::Time	MaxTickTime;
+			Bit::Time	TotalTickTime;
+			Bit::Uint32	QualityLevel;		///< Current physics quality level, 0 is the maximum quality.
+			Bit::Uint64	QualityDowngrades;
+			Bit::Uint64	QualityUpgrades;
+			Bit::Uint64	ReducedQualityTicks;	///< Ticks stepped below the maximum physics quality.
+			Bit::Uint64	SkippedStates;		///< Published states replaced before the send thread took them.
+			Bit::Uint64	CoalescedFrames;	///< Frames appended to a queued frame of the user, the queue was full.
+			Bit::Uint64	DroppedFrames;		///< Frames dropped with the queue full and no queued frame of the user.
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		Server( const ServerSettings & p_Settings = ServerSettings( ) );
 
 		////////////////////////////////////////////////////////////////
 		/// \brief Destructor.
@@ -72,6 +117,45 @@ namespace Pong
 		////////////////////////////////////////////////////////////////
 		void MainUpdate( );
 
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the tick statistics.
+		///
+		////////////////////////////////////////////////////////////////
+		TickStatistics GetTickStatistics( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get a player of the networked match, 0 or 1.
+		///
+		////////////////////////////////////////////////////////////////
+		Player * GetPlayer( const Bit::SizeType p_Index ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get a ball of the networked match.
+		///
+		////////////////////////////////////////////////////////////////
+		Ball * GetBall( const Bit::SizeType p_Index ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the server clock, in microseconds.
+		///
+		/// Clients estimate the same clock with Client::ServerTimeNow.
+		/// A server taking over continues the clock of the previous one.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint64 GetTime( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the local transport for a client hosted by this process.
+		///
+		/// Only one client can use it at a time.
+		///
+		/// \param p_Port Port the client joins.
+		///
+		/// \return NULL if the server is not hosted on the port.
+		///
+		////////////////////////////////////////////////////////////////
+		LocalTransport * GetLocalTransport( const Bit::Uint16 p_Port );
+
 	protected:
 
 		////////////////////////////////////////////////////////////////
@@ -88,13 +172,337 @@ namespace Pong
 
 	private:
 
+		// Private constants
+		static const Bit::SizeType MatchesPerJob = 64;
+		static const Bit::Uint32 TickInterval = 16667;	///< Microseconds per tick, 60 ticks per second.
+		static const Bit::Uint32 MaxInputBacklog = 2;	///< Client ticks of queued inputs applied one tick at a time.
+		static const Bit::SizeType MaxQueuedInputs = 32;	///< Queued inputs per slot, later inputs are dropped.
+		static const Bit::SizeType MaxQueuedFrames = 256;	///< Frames queued for the send thread, later frames are coalesced.
+		static const Bit::Uint32 HandoverTimeout = 2000;	///< Milliseconds to wait for the previous server to hand over.
+
+		// Private structures
+		struct Slot
+		{
+			Bit::Bool	Connected;
+			Bit::Bool	Reserved;		///< Kept for a resume since the disconnection.
+			Bit::Uint16	UserId;
+			Bit::Uint64	Token;			///< Resume token, 0 for none.
+			Bit::Uint64	DisconnectTime;	///< Server clock, in microseconds.
+		};
+
+		struct MatchSummary
+		{
+			Bit::Uint32		BallCount;
+			Bit::Float32	BallX;			///< Position of the first ball.
+			Bit::Float32	BallY;
+			Bit::Float32	PlayerY[ 2 ];
+		};
+
+		struct Input
+		{
+			Bit::Uint8	Slot;
+			Bit::Bool	IsMoving;
+			eDirection	Direction;
+			Bit::Uint32	Tick;			///< Server tick estimated by the client.
+			Bit::Uint32	Offset;			///< Microseconds into the tick.
+		};
+
+		struct Join
+		{
+			Bit::Uint16	UserId;
+			Bit::Uint64	Token;
+			Bit::Bool	Local;			///< Client hosted by this process.
+		};
+
+		struct PublishedState
+		{
+			Bit::Uint32		Tick;
+			BallStates		Balls;			///< The balls of the networked match only.
+			PlayerStates	Players;
+		};
+
+		struct QueuedFrame
+		{
+			Bit::Uint16	UserId;
+			Packet		Frame;
+		};
+
+		struct Ping
+		{
+			Bit::Uint16	UserId;
+			Bit::Uint32	Sequence;
+			Bit::Uint64	ClientSend;
+			Bit::Uint64	ServerReceive;
+		};
+
+		// Private functions
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Ask the server writing the checkpoints to hand over.
+		///
+		/// Waits for the final checkpoint of the previous server,
+		/// or uses the newest one if the previous server does not answer.
+		///
+		/// \return False if there is no checkpoint to continue from.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool TakeOver( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Continue from the taken over checkpoint, if any,
+		///		   and prepare the checkpoints of this server.
+		///
+		////////////////////////////////////////////////////////////////
+		void RestoreCheckpoint( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Write a checkpoint if one is due.
+		///
+		/// Writes the final checkpoint and stops the server
+		/// if another server requested a handover.
+		///
+		////////////////////////////////////////////////////////////////
+		void WriteCheckpoint( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Write the state of all matches and slots.
+		///
+		/// \param p_Tick The tick to continue from.
+		///
+		////////////////////////////////////////////////////////////////
+		void SaveState( Packet & p_Packet, const Bit::Uint32 p_Tick );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Read the state of all matches and slots.
+		///
+		/// The slots are reserved for a resume, the users
+		/// reconnect with their resume tokens.
+		///
+		/// \return False if the state was saved with other settings.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool LoadState( Packet & p_Packet );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the player slot of a user.
+		///
+		/// \return The slot, or -1 if the user has not joined.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Int32 GetSlot( const Bit::Uint16 p_UserId );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Give the joined users a slot and queue their baselines.
+		///
+		/// Users with the resume token of a reserved slot get it back,
+		/// other users get a free slot and a new token.
+		///
+		////////////////////////////////////////////////////////////////
+		void AcceptJoins( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Queue the baseline of a user.
+		///
+		/// \param p_Slot Slot of the user, or -1 if the server is full.
+		///
+		////////////////////////////////////////////////////////////////
+		void QueueBaseline( const Bit::Uint16 p_UserId, const Bit::Int32 p_Slot, const Bit::Uint64 p_Token );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Queue the replies to the received time sync pings.
+		///
+		////////////////////////////////////////////////////////////////
+		void QueueTimeSyncReplies( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Send the due snapshots of a published state, on the send thread.
+		///
+		/// Each client is sent snapshots at its own rate and detail,
+		/// unreliably, outside of the batches.
+		///
+		////////////////////////////////////////////////////////////////
+		void SendSnapshots( const PublishedState & p_State );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Queue all batched messages of this tick for the send thread.
+		///
+		////////////////////////////////////////////////////////////////
+		void FlushMessages( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Send the frames queued by the flushes, on the send thread.
+		///
+		/// Switches the joined local client to the local transport
+		/// right after its baseline went out.
+		///
+		////////////////////////////////////////////////////////////////
+		void SendFrames( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Queue the input of a move or stop move message.
+		///
+		////////////////////////////////////////////////////////////////
+		void QueueInput( const Bit::Uint16 p_UserId, const Bit::Bool p_Move, Packet & p_Message );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Queue a time sync ping, replied by the next flush.
+		///
+		////////////////////////////////////////////////////////////////
+		void QueuePing( const Bit::Uint16 p_UserId, Packet & p_Message );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Pass a snapshot acknowledgement to the snapshot controller.
+		///
+		////////////////////////////////////////////////////////////////
+		void AckSnapshot( const Bit::Uint16 p_UserId, Packet & p_Message );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Handle the messages of the local transport.
+		///
+		////////////////////////////////////////////////////////////////
+		void ReceiveLocalMessages( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Send a message over the local transport.
+		///
+		/// Batches are never sent over the network once the user joined
+		/// locally, a batch not fitting the ring drops the user from the
+		/// local transport and the client reconnects.
+		///
+		/// \return false if the message is to be sent over the network,
+		///		true if it was written or discarded.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool SendLocal( const Bit::Uint16 p_UserId, const LocalMessage::eType p_Type, const Packet & p_Message );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Create the matches of the game mode.
+		///
+		////////////////////////////////////////////////////////////////
+		void CreateMatches( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destroy all matches.
+		///
+		////////////////////////////////////////////////////////////////
+		void DestroyMatches( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Step all matches.
+		///
+		////////////////////////////////////////////////////////////////
+		void StepMatches( const Bit::Time & p_Time );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if no player holds a slot any longer, for draining.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool IsDrained( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Copy the summaries of all matches, for the control thread.
+		///
+		////////////////////////////////////////////////////////////////
+		void SummarizeMatches( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Execute a control command, on the control thread.
+		///
+		/// \return The reply to the command.
+		///
+		////////////////////////////////////////////////////////////////
+		std::string HandleCommand( const std::string & p_Command );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Apply the received inputs of this step.
+		///
+		/// The inputs take effect at their offset within the tick,
+		/// the player velocity of the step is the mean of the pieces.
+		///
+		////////////////////////////////////////////////////////////////
+		void ApplyInputs( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Let bots play the slots of the first match without a connected user.
+		///
+		////////////////////////////////////////////////////////////////
+		void PlayFreeSlots( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Publish a copy of the states of the first match.
+		///
+		/// The send thread serializes and sends the newest copy,
+		/// the tick never waits for it.
+		///
+		////////////////////////////////////////////////////////////////
+		void PublishStates( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Copy a published state to the entities, on the send thread.
+		///
+		////////////////////////////////////////////////////////////////
+		void UpdateEntities( const PublishedState & p_State );
+
 		// Private variables
+		ServerSettings		m_Settings;
+		MessageBatcher		m_MessageBatcher;
 		Bit::Thread			m_MainThread;
+		EntityStore<Ball>	m_Balls;
+		EntityStore<Player>	m_Players;
 		Ball *				m_pBall;
 		Player *			m_pPlayers[ 2 ];
-		Bit::Keyboard		m_Keyboard;
-		Bit::Phys2::Scene	m_Scene;
-		Bit::Phys2::Body *	m_pBodies[ 3 ];
+		Bit::Thread			m_ControlThread;
+		Bit::Thread			m_SendThread;		///< The only thread sending messages, over the network and the local transport.
+		Bit::Semaphore		m_SendSemaphore;	///< Released by the tick when a state is published and the frames are queued.
+		ControlSocket		m_ControlSocket;	///< Accessed by the control thread only.
+		Bit::Keyboard		m_Keyboard;			///< Polled by the control thread.
+		std::atomic<bool>	m_StopRequested;
+		std::atomic<bool>	m_Draining;			///< Refuse new users, stop when the players left.
+		std::atomic<bool>	m_SummaryRequested;
+		Bit::Semaphore		m_SummarySemaphore;	///< Released by the tick when the summaries are copied.
+		std::vector<MatchSummary>	m_MatchSummaries;
+		MatchBatch						m_Matches;
+		std::vector<MultiBallMatch *>	m_MultiBallMatches;
+		JobScheduler					m_JobScheduler;
+		Bit::Mutex						m_TickMutex;
+		TickStatistics					m_TickStatistics;
+		AllocationReport				m_AllocationReport;	///< Accessed by the main thread only, except for resets.
+		QualityGovernor					m_QualityGovernor;	///< Accessed by the main thread only.
+		Bit::Timer						m_Clock;
+		Bit::Uint64						m_ClockOffset;		///< Added to the clock, to continue the clock of a previous server.
+		Bit::Uint32						m_Tick;
+		Bit::Uint64						m_TickTime;			///< Server clock at the start of the current tick.
+		Bit::Mutex						m_InputMutex;
+		std::vector<Input>				m_Inputs;			///< Inputs waiting for their step, in order of arrival, reserved.
+		Bit::Float32					m_InputVelocities[ 2 ];	///< Mean velocity of the players over the step, -1 to 1.
+		Bit::Mutex						m_SlotMutex;		///< Guards the slots.
+		Slot							m_Slots[ 2 ];
+		Bit::Mutex						m_JoinMutex;
+		std::vector<Join>				m_Joins;			///< Joins waiting for a slot, reserved.
+		std::mt19937_64					m_TokenGenerator;
+		Packet							m_BaselinePacket;
+		Bit::Mutex						m_PingMutex;
+		std::vector<Ping>				m_Pings;			///< Pings waiting for a reply, reserved.
+		Packet							m_TimeSyncPacket;
+		SnapshotController::Limits		m_SnapshotLimits;
+		Bit::Mutex						m_SnapshotMutex;	///< Guards the snapshot controllers.
+		std::map<Bit::Uint16, SnapshotController>	m_SnapshotControllers;
+		TripleBuffer<PublishedState>	m_PublishedStates;	///< Written by the tick, read by the send thread.
+		Packet							m_SnapshotPacket;	///< Accessed by the send thread only.
+		Bit::Mutex						m_FrameMutex;		///< Guards the queued frames.
+		std::vector<QueuedFrame>		m_QueuedFrames;		///< Flushed by the tick, MaxQueuedFrames long, the first m_QueuedFrameCount are in use.
+		Bit::SizeType					m_QueuedFrameCount;
+		Bit::Int32						m_QueuedLocalUserId;	///< Joined local client, -1 for none.
+		Bit::SizeType					m_QueuedLocalFrameCount;	///< Queued frames up to the baseline of the joined local client.
+		std::vector<QueuedFrame>		m_SendingFrames;	///< Swapped with the queued frames, accessed by the send thread only.
+		Checkpoint						m_Checkpoint;
+		Packet							m_CheckpointPacket;	///< Reserved to the checkpoint capacity.
+		Bit::Uint16						m_Port;
+		LocalTransport					m_LocalTransport;
+		std::atomic<Bit::Int32>			m_LocalUserId;		///< User of the local transport, -1 for none.
+		std::atomic<Bit::Int32>			m_OverflowUserId;	///< Dropped from the local transport, its batches are discarded until it disconnects.
+		Bit::Int32						m_PendingLocalUserId;	///< Accepted by the tick, queued with its baseline by the flush.
+		Packet							m_LocalMessage;
 
 	};
 
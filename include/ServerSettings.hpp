@@ -0,0 +1,95 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_SERVER_SETTINGS_HPP
+#define PONG_SERVER_SETTINGS_HPP
+
+#include <Bit/Build.hpp>
+#include <GameMode.hpp>
+#include <AllocationTracker.hpp>
+#include <PhysicsQuality.hpp>
+#include <string>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Pong server settings.
+	///
+	////////////////////////////////////////////////////////////////
+	struct ServerSettings
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor, default settings.
+		///
+		////////////////////////////////////////////////////////////////
+		ServerSettings( ) :
+			Mtu( 1200 ),
+			MatchCount( 1 ),
+			Mode( GameMode::Classic ),
+			BallCount( 200 ),
+			ObstacleCount( 16 ),
+			Seed( 1 ),
+			WorkerCount( 0 ),
+			AllocationCheck( AllocationReport::GetDefaultCheck( ) ),
+			SnapshotMinRate( 10 ),
+			SnapshotMaxRate( 60 ),
+			ClientMinBandwidth( 2000 ),
+			ClientMaxBandwidth( 64000 ),
+			ResumeTimeout( 10000 ),
+			CheckpointInterval( 30 ),
+			Takeover( false ),
+			Bots( false ),
+			MaxPhysicsQuality( 2 ),
+			MinPhysicsQuality( 1 )
+		{
+		}
+
+		Bit::Uint16		Mtu;			///< Maximum transmission unit of outgoing batches, in bytes.
+		Bit::SizeType	MatchCount;		///< Number of matches stepped by the server, the first one is networked.
+		GameMode::eMode	Mode;			///< Game mode of all matches.
+		Bit::Uint16		BallCount;		///< Balls per match, multi-ball mode only.
+		Bit::Uint16		ObstacleCount;	///< Obstacles per match, multi-ball mode only.
+		Bit::Uint32		Seed;			///< Seed of the obstacle layouts, multi-ball mode only.
+		Bit::SizeType	WorkerCount;	///< Threads stepping the matches, 0 for one per core.
+		AllocationReport::eCheck AllocationCheck;	///< What to do with allocating steady state ticks.
+		Bit::Uint32		SnapshotMinRate;	///< Snapshots per second sent to the slowest clients.
+		Bit::Uint32		SnapshotMaxRate;	///< Snapshots per second sent to the fastest clients.
+		Bit::Uint32		ClientMinBandwidth;	///< Bytes per second of snapshots a client is always given.
+		Bit::Uint32		ClientMaxBandwidth;	///< Bytes per second of snapshots a client is given at most.
+		Bit::Uint32		ResumeTimeout;		///< Milliseconds the slot of a disconnected player is kept for a resume.
+		std::string		CheckpointPath;		///< File of the match state checkpoints, empty for none.
+		Bit::Uint32		CheckpointInterval;	///< Ticks between checkpoints, 0 for handovers only.
+		Bit::Bool		Takeover;			///< Continue the matches of the server writing the checkpoints.
+		Bit::Bool		Bots;				///< Bots play all matches, and the free slots of the first one.
+		std::string		ControlPath;		///< Unix domain socket of the control commands, empty for none.
+		PhysicsQuality	MaxPhysicsQuality;	///< Physics quality while the ticks fit the budget.
+		PhysicsQuality	MinPhysicsQuality;	///< Lowest physics quality under load, equal to the maximum for a fixed quality.
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,102 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_SNAPSHOT_HPP
+#define PONG_SNAPSHOT_HPP
+
+#include <Bit/Build.hpp>
+#include <Packet.hpp>
+#include <EntityStates.hpp>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Snapshot message format, the hot state of the networked match.
+	///
+	/// Layout: sequence (Uint32), tick (Uint32), level (Uint8),
+	/// first ball (Uint16), ball count (Uint16), total ball count (Uint16),
+	/// the positions of both players (2 x 2 Float32) and the balls.
+	/// Level 0 balls are positions and rotations as floats,
+	/// higher levels only carry positions quantized to 16 bits.
+	///
+	////////////////////////////////////////////////////////////////
+	class Snapshot
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Size of everything but the balls, in bytes.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::SizeType HeaderSize = 31;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Header structure.
+		///
+		////////////////////////////////////////////////////////////////
+		struct Header
+		{
+			Bit::Uint32 Sequence;
+			Bit::Uint32 Tick;
+			Bit::Uint32 Level;
+			Bit::Uint16 FirstBall;
+			Bit::Uint16 BallCount;
+			Bit::Uint16 TotalBallCount;
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the size of a ball at a detail level, in bytes.
+		///
+		////////////////////////////////////////////////////////////////
+		static Bit::SizeType GetBallSize( const Bit::Uint32 p_Level );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Write a snapshot.
+		///
+		/// The balls p_Header.FirstBall and onwards are written,
+		/// wrapping around at p_Header.TotalBallCount.
+		///
+		////////////////////////////////////////////////////////////////
+		static void Write(	Packet & p_Packet, const Header & p_Header,
+							const BallStates & p_Balls, const PlayerStates & p_Players );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Read a snapshot.
+		///
+		/// Only the received balls are written to p_Balls,
+		/// level 1 and higher leave the rotations untouched.
+		///
+		/// \return false if the snapshot is malformed.
+		///
+		////////////////////////////////////////////////////////////////
+		static Bit::Bool Read(	Packet & p_Packet, Header & p_Header,
+								BallStates & p_Balls, PlayerStates & p_Players );
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,221 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_SNAPSHOT_CONTROLLER_HPP
+#define PONG_SNAPSHOT_CONTROLLER_HPP
+
+#include <Bit/Build.hpp>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Snapshot rate and detail control of one client.
+	///
+	/// Tracks the sent snapshots and the acknowledgements of the client,
+	/// estimates the loss, round trip and delivery rate of the link,
+	/// and keeps a bandwidth budget: multiplicative decrease on loss or
+	/// growing round trips, additive increase otherwise.
+	/// The snapshot interval and detail level are the most frequent and
+	/// detailed combination within the budget.
+	///
+	////////////////////////////////////////////////////////////////
+	class SnapshotController
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Highest detail level, more balls are left out per level.
+		///
+		/// Level 0 sends all balls at full precision, level 1 sends
+		/// quantized positions, higher levels send a rotating half,
+		/// quarter, eighth of the balls.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::Uint32 MaxLevel = 4;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Number of snapshots tracked for acknowledgement.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::SizeType HistorySize = 64;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Limits structure.
+		///
+		////////////////////////////////////////////////////////////////
+		struct Limits
+		{
+			Limits( );
+
+			Bit::Uint32	TickRate;		///< Server ticks per second.
+			Bit::Uint32	MinInterval;	///< Ticks between snapshots, at most.
+			Bit::Uint32	MaxInterval;	///< Ticks between snapshots, at least.
+			Bit::Uint32	MinBandwidth;	///< Bytes per second the budget never goes below.
+			Bit::Uint32	MaxBandwidth;	///< Bytes per second the budget never goes above.
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor.
+		///
+		/// \param p_Limits Limits of the controller.
+		/// \param p_BallCount Number of balls in the snapshots.
+		///
+		////////////////////////////////////////////////////////////////
+		SnapshotController( const Limits & p_Limits, const Bit::SizeType p_BallCount );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if a snapshot is due at a tick.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool IsDue( const Bit::Uint32 p_Tick ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the detail level of the next snapshot.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 GetLevel( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the interval between snapshots, in ticks.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 GetInterval( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the sequence of the next snapshot.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 GetSequence( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the first ball of the next snapshot.
+		///
+		/// Levels leaving balls out rotate through all balls.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint16 GetFirstBall( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Record a sent snapshot.
+		///
+		/// \return Sequence number of the snapshot.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 OnSent( const Bit::Uint32 p_Tick, const Bit::SizeType p_Size, const Bit::Uint64 p_Time );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Record an acknowledgement.
+		///
+		/// \param p_Sequence Newest received sequence.
+		/// \param p_Bits Bit i is set if sequence p_Sequence - 1 - i was received.
+		/// \param p_Time Receive time, in microseconds.
+		///
+		////////////////////////////////////////////////////////////////
+		void OnAck( const Bit::Uint32 p_Sequence, const Bit::Uint32 p_Bits, const Bit::Uint64 p_Time );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Adapt the budget, interval and level, called every tick.
+		///
+		////////////////////////////////////////////////////////////////
+		void Update( const Bit::Uint64 p_Time );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the size of a snapshot at a detail level, in bytes.
+		///
+		////////////////////////////////////////////////////////////////
+		static Bit::SizeType GetSnapshotSize( const Bit::Uint32 p_Level, const Bit::SizeType p_BallCount );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of balls sent at a detail level.
+		///
+		////////////////////////////////////////////////////////////////
+		static Bit::SizeType GetBallCount( const Bit::Uint32 p_Level, const Bit::SizeType p_BallCount );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the bandwidth budget, in bytes per second.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 GetBudget( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the acknowledged bytes per second of the last period.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint32 GetDeliveryRate( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the snapshot loss rate of the last period, 0 to 1.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Float32 GetLossRate( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the smoothed round trip time, in microseconds.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Uint64 GetRoundTripTime( ) const;
+
+	private:
+
+		// Private structures
+		struct Record
+		{
+			Bit::Uint32		Sequence;
+			Bit::Uint32		Size;
+			Bit::Uint64		Time;
+			Bit::Bool		Pending;
+		};
+
+		// Private functions
+		void Acknowledge( const Bit::Uint32 p_Sequence, const Bit::Uint64 p_Time );
+		void ChooseRate( );
+
+		// Private variables
+		Limits			m_Limits;
+		Bit::SizeType	m_BallCount;
+		Record			m_History[ HistorySize ];
+		Bit::Uint32		m_Sequence;			///< Sequence of the next snapshot.
+		Bit::Uint16		m_FirstBall;
+		Bit::Uint32		m_LastTick;
+		Bit::Bool		m_HasSent;
+		Bit::Uint32		m_Level;
+		Bit::Uint32		m_Interval;
+		Bit::Float64	m_Budget;
+		Bit::Uint64		m_PeriodStart;
+		Bit::Uint32		m_PeriodSent;
+		Bit::Uint32		m_PeriodAcked;
+		Bit::Uint32		m_PeriodLost;
+		Bit::Uint64		m_PeriodBytes;
+		Bit::Uint32		m_DeliveryRate;
+		Bit::Float32	m_LossRate;
+		Bit::Uint64		m_RoundTrip;
+		Bit::Uint64		m_MinRoundTrip;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
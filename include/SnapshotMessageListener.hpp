@@ -0,0 +1,81 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_SNAPSHOT_MESSAGE_LISTENER_HPP
+#define PONG_SNAPSHOT_MESSAGE_LISTENER_HPP
+
+#include <Bit/Network/Net/HostMessageListener.hpp>
+#include <Packet.hpp>
+#include <EntityStates.hpp>
+
+namespace Pong
+{
+
+	// Forward declarations
+	class Client;
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Snapshot message listener, applies the snapshots to
+	///		the entities of the client and tracks the acknowledgements.
+	///
+	////////////////////////////////////////////////////////////////
+	class SnapshotMessageListener : public Bit::Net::HostMessageListener
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		////////////////////////////////////////////////////////////////
+		SnapshotMessageListener( Client * p_pClient );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Handle message function
+		///
+		////////////////////////////////////////////////////////////////
+		virtual void HandleMessage( Bit::Net::HostMessageDecoder & p_Message );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Handle a snapshot of the local transport.
+		///
+		////////////////////////////////////////////////////////////////
+		void HandleSnapshot( const Bit::Uint8 * p_pData, const Bit::SizeType p_Size );
+
+	private:
+
+		// Private functions
+		void Apply( );
+
+		// Private variables
+		Client *		m_pClient;
+		Packet			m_Message;
+		BallStates		m_Balls;
+		PlayerStates	m_Players;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,147 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_TIME_SYNC_HPP
+#define PONG_TIME_SYNC_HPP
+
+#include <Bit/Build.hpp>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Estimates the clock of a remote host from ping/pong samples.
+	///
+	/// Each sample has four timestamps in microseconds, NTP style:
+	/// the client send time, the server receive and send times,
+	/// and the client receive time.
+	/// The offset is only trusted from samples with a round trip close
+	/// to the shortest one of the recent samples, since queued samples
+	/// are asymmetric. The drift between the clocks is measured as the
+	/// change of that offset over minutes.
+	///
+	////////////////////////////////////////////////////////////////
+	class TimeSync
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Number of samples kept.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::SizeType WindowSize = 16;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Number of samples needed to be synchronized.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::SizeType MinSamples = 4;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		TimeSync( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Forget all samples.
+		///
+		////////////////////////////////////////////////////////////////
+		void Reset( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Add a sample and update the estimate.
+		///
+		/// \param p_ClientSend Local time the ping was sent.
+		/// \param p_ServerReceive Remote time the ping was received.
+		/// \param p_ServerSend Remote time the pong was sent.
+		/// \param p_ClientReceive Local time the pong was received.
+		///
+		/// \return false if the sample is invalid.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool AddSample(	const Bit::Int64 p_ClientSend, const Bit::Int64 p_ServerReceive,
+								const Bit::Int64 p_ServerSend, const Bit::Int64 p_ClientReceive );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if there are enough samples for an estimate.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool IsSynchronized( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the remote time at a local time, in microseconds.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Int64 GetServerTime( const Bit::Int64 p_ClientTime ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the smoothed round trip time, in microseconds.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Int64 GetRoundTripTime( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the shortest round trip time of the window, in microseconds.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Int64 GetMinRoundTripTime( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the estimated drift, remote seconds gained per local second.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Float64 GetDrift( ) const;
+
+	private:
+
+		// Private structures
+		struct Sample
+		{
+			Bit::Int64 Time;		///< Local receive time.
+			Bit::Int64 Offset;
+			Bit::Int64 RoundTrip;
+		};
+
+		// Private functions
+		void Estimate( );
+
+		// Private variables
+		Sample			m_Samples[ WindowSize ];
+		Bit::SizeType	m_SampleCount;	///< Total number of samples added.
+		Bit::Int64		m_RoundTrip;
+		Bit::Int64		m_MinRoundTrip;
+		Bit::Int64		m_Offset;		///< Offset at the base time.
+		Bit::Int64		m_BaseTime;		///< Mean time of the good samples.
+		Bit::Float64	m_Drift;
+		Bit::Bool		m_AnchorSet;
+		Bit::Int64		m_AnchorTime;	///< Start of the drift measurement.
+		Bit::Int64		m_AnchorOffset;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -21,10 +21,10 @@
 //    source distribution.
 // ///////////////////////////////////////////////////////////////////////////
 
-#ifndef PONG_INIT_MESSAGE_LISTENER_HPP
-#define PONG_INIT_MESSAGE_LISTENER_HPP
+#ifndef PONG_TIME_SYNC_MESSAGE_LISTENER_HPP
+#define PONG_TIME_SYNC_MESSAGE_LISTENER_HPP
 
-#include <Bit/Network/Net/HostMessageListener.hpp>
+#include <MessageHandler.hpp>
 
 namespace Pong
 {
@@ -32,8 +32,8 @@ namespace Pong
 	// Forward declarations
 	class Client;
 
-	// Player user message
-	class InitMessageListener : public Bit::Net::HostMessageListener
+	// Time sync message handler, the server's reply to a ping
+	class TimeSyncMessageListener : public MessageHandler
 	{
 
 	public:
@@ -42,13 +42,13 @@ namespace Pong
 		/// \brief Constructor
 		///
 		////////////////////////////////////////////////////////////////
-		InitMessageListener( Client * p_pClient );
+		TimeSyncMessageListener( Client * p_pClient );
 
 		////////////////////////////////////////////////////////////////
 		/// \brief Handle message function
 		///
 		////////////////////////////////////////////////////////////////
-		virtual void HandleMessage( Bit::Net::HostMessageDecoder & p_Message );
+		virtual void HandleMessage( Packet & p_Message );
 
 	private:
 
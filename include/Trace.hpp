@@ -0,0 +1,135 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_TRACE_HPP
+#define PONG_TRACE_HPP
+
+#include <Bit/Build.hpp>
+#include <string>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Opt-in timeline tracing, written as Chrome trace JSON.
+	///
+	/// Spans are recorded into a ring buffer per thread, the newest
+	/// spans of every thread are kept. Recording takes no locks and
+	/// never allocates, except for the first span of a thread.
+	/// When disabled, a span costs one atomic load.
+	///
+	/// The written file opens in chrome://tracing and Perfetto.
+	/// Timestamps can be shifted to the server clock, so traces of
+	/// clients and servers in different processes line up.
+	///
+	////////////////////////////////////////////////////////////////
+	class Trace
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Spans kept per thread, older spans are overwritten.
+		///
+		////////////////////////////////////////////////////////////////
+		static const Bit::SizeType BufferSize = 65536;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Enable or disable the recording.
+		///
+		////////////////////////////////////////////////////////////////
+		static void Enable( const Bit::Bool p_Enabled );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if the recording is enabled.
+		///
+		////////////////////////////////////////////////////////////////
+		static Bit::Bool IsEnabled( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Name the calling thread in the timeline.
+		///
+		/// \param p_pName Name of the thread, must be a string literal.
+		///
+		////////////////////////////////////////////////////////////////
+		static void SetThreadName( const char * p_pName );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the trace clock, in microseconds.
+		///
+		////////////////////////////////////////////////////////////////
+		static Bit::Uint64 GetTime( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Record a span of the calling thread.
+		///
+		/// \param p_pName Name of the span, must be a string literal.
+		/// \param p_Begin Trace clock at the beginning of the span.
+		/// \param p_End Trace clock at the end of the span.
+		///
+		////////////////////////////////////////////////////////////////
+		static void Record( const char * p_pName, const Bit::Uint64 p_Begin, const Bit::Uint64 p_End );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Write the recorded spans of all threads.
+		///
+		/// Disable the recording first, spans recorded while writing
+		/// may be left out.
+		///
+		/// \param p_Path Path of the JSON file.
+		/// \param p_pProcessName Name of the process in the timeline.
+		/// \param p_ClockOffset Microseconds added to the trace clock,
+		///		the server clock minus the trace clock lines up processes.
+		///
+		/// \return false if the file could not be written.
+		///
+		////////////////////////////////////////////////////////////////
+		static Bit::Bool Write( const std::string & p_Path, const char * p_pProcessName, const Bit::Int64 p_ClockOffset );
+
+	};
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Scoped span of the trace.
+	///
+	////////////////////////////////////////////////////////////////
+	class TraceScope
+	{
+
+	public:
+
+		TraceScope( const char * p_pName );
+		~TraceScope( );
+
+	private:
+
+		const char *	m_pName;
+		Bit::Uint64		m_Begin;
+		Bit::Bool		m_Enabled;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
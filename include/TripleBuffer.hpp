@@ -0,0 +1,170 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_TRIPLE_BUFFER_HPP
+#define PONG_TRIPLE_BUFFER_HPP
+
+#include <Bit/Build.hpp>
+#include <atomic>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Lock free triple buffer, one writer and one reader thread.
+	///
+	/// The writer fills the write buffer and publishes it,
+	/// the reader acquires the newest published buffer.
+	/// Neither side waits for the other, a buffer published
+	/// before the reader acquired the previous one replaces it.
+	///
+	////////////////////////////////////////////////////////////////
+	template<typename T>
+	class TripleBuffer
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		TripleBuffer( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Set all buffers to a value, nothing is published.
+		///
+		/// Not thread safe, call it before the threads start.
+		///
+		////////////////////////////////////////////////////////////////
+		void Reset( const T & p_Value );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the buffer to write, by the writer thread.
+		///
+		////////////////////////////////////////////////////////////////
+		T & GetWriteBuffer( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Publish the write buffer, by the writer thread.
+		///
+		/// The write buffer is then one of the other buffers,
+		/// holding an older value.
+		///
+		/// \return false if the previously published buffer
+		///		was replaced before the reader acquired it.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Publish( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Acquire the newest published buffer, by the reader thread.
+		///
+		/// \return false if nothing was published since the last call,
+		///		the read buffer is left as it is.
+		///
+		////////////////////////////////////////////////////////////////
+		Bit::Bool Acquire( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the acquired buffer, by the reader thread.
+		///
+		////////////////////////////////////////////////////////////////
+		const T & GetReadBuffer( ) const;
+
+	private:
+
+		// Copy not allowed
+		TripleBuffer( const TripleBuffer & );
+		TripleBuffer & operator =( const TripleBuffer & );
+
+		// Private constants
+		static const Bit::Uint8 IndexMask = 0x03;
+		static const Bit::Uint8 Fresh = 0x04;	///< Set while the middle buffer is not acquired.
+
+		// Private variables
+		T						m_Buffers[ 3 ];
+		Bit::Uint8				m_Write;		///< Accessed by the writer only.
+		Bit::Uint8				m_Read;			///< Accessed by the reader only.
+		std::atomic<Bit::Uint8>	m_Middle;		///< Index of the buffer between them, and the fresh flag.
+
+	};
+
+	template<typename T>
+	TripleBuffer<T>::TripleBuffer( ) :
+		m_Write( 0 ),
+		m_Read( 1 )
+	{
+		m_Middle = 2;
+	}
+
+	template<typename T>
+	void TripleBuffer<T>::Reset( const T & p_Value )
+	{
+		for( Bit::SizeType i = 0; i < 3; i++ )
+		{
+			m_Buffers[ i ] = p_Value;
+		}
+		m_Write = 0;
+		m_Read = 1;
+		m_Middle = 2;
+	}
+
+	template<typename T>
+	T & TripleBuffer<T>::GetWriteBuffer( )
+	{
+		return m_Buffers[ m_Write ];
+	}
+
+	template<typename T>
+	Bit::Bool TripleBuffer<T>::Publish( )
+	{
+		// Release the written buffer, take the middle one.
+		const Bit::Uint8 previous = m_Middle.exchange( m_Write | Fresh, std::memory_order_acq_rel );
+		m_Write = previous & IndexMask;
+		return ( previous & Fresh ) == 0;
+	}
+
+	template<typename T>
+	Bit::Bool TripleBuffer<T>::Acquire( )
+	{
+		if( ( m_Middle.load( std::memory_order_relaxed ) & Fresh ) == 0 )
+		{
+			return false;
+		}
+
+		// Only the writer sets the fresh flag, the middle is still fresh.
+		m_Read = m_Middle.exchange( m_Read, std::memory_order_acq_rel ) & IndexMask;
+		return true;
+	}
+
+	template<typename T>
+	const T & TripleBuffer<T>::GetReadBuffer( ) const
+	{
+		return m_Buffers[ m_Read ];
+	}
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,182 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef PONG_UNIFORM_GRID_HPP
+#define PONG_UNIFORM_GRID_HPP
+
+#include <Bit/Build.hpp>
+#include <vector>
+
+namespace Pong
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup Pong
+	/// \brief Uniform grid broadphase.
+	///
+	/// Points are sorted into cells with a counting sort, stable and
+	/// without allocations once the grid has grown to its working size.
+	/// With a cell size of at least twice the largest radius, every
+	/// overlapping pair of circles is found in neighbouring cells.
+	///
+	/// Boxes are stored in every cell they overlap, for static geometry
+	/// that is queried by point.
+	///
+	////////////////////////////////////////////////////////////////
+	class UniformGrid
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		UniformGrid( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Set the area and cell size, and clear the grid.
+		///
+		/// Points outside of the area are stored in the border cells.
+		///
+		////////////////////////////////////////////////////////////////
+		void Create(	const Bit::Float32 p_MinX, const Bit::Float32 p_MinY,
+						const Bit::Float32 p_MaxX, const Bit::Float32 p_MaxY,
+						const Bit::Float32 p_CellSize );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Sort points into the cells.
+		///
+		////////////////////////////////////////////////////////////////
+		void BuildPoints( const Bit::Float32 * p_pX, const Bit::Float32 * p_pY, const Bit::SizeType p_Count );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Store boxes in every cell they overlap.
+		///
+		/// \param p_Margin Distance the boxes are grown by.
+		///
+		////////////////////////////////////////////////////////////////
+		void BuildBoxes(	const Bit::Float32 * p_pMinX, const Bit::Float32 * p_pMinY,
+							const Bit::Float32 * p_pMaxX, const Bit::Float32 * p_pMaxY,
+							const Bit::SizeType p_Count, const Bit::Float32 p_Margin );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Call a function for every pair of points in the same
+		///		or in neighbouring cells, each pair once.
+		///
+		/// \param p_Function Called as p_Function( SizeType p_A, SizeType p_B ).
+		///
+		////////////////////////////////////////////////////////////////
+		template<typename Function>
+		void ForEachPair( Function p_Function ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Call a function for every item in the cell of a point.
+		///
+		/// \param p_Function Called as p_Function( SizeType p_Item ).
+		///
+		////////////////////////////////////////////////////////////////
+		template<typename Function>
+		void ForEachInCell( const Bit::Float32 p_X, const Bit::Float32 p_Y, Function p_Function ) const;
+
+	private:
+
+		// Private functions
+		Bit::SizeType GetColumn( const Bit::Float32 p_X ) const;
+		Bit::SizeType GetRow( const Bit::Float32 p_Y ) const;
+
+		// Private variables
+		Bit::Float32				m_MinX;
+		Bit::Float32				m_MinY;
+		Bit::Float32				m_InverseCellSize;
+		Bit::SizeType				m_Columns;
+		Bit::SizeType				m_Rows;
+		std::vector<Bit::Uint32>	m_CellStarts;	///< First item of each cell, one extra at the end.
+		std::vector<Bit::Uint32>	m_Items;		///< Items sorted by cell.
+		std::vector<Bit::Uint32>	m_ItemCells;	///< Cell of each point.
+
+	};
+
+	template<typename Function>
+	void UniformGrid::ForEachPair( Function p_Function ) const
+	{
+		for( Bit::SizeType row = 0; row < m_Rows; row++ )
+		{
+			for( Bit::SizeType column = 0; column < m_Columns; column++ )
+			{
+				const Bit::SizeType cell = row * m_Columns + column;
+				const Bit::Uint32 begin = m_CellStarts[ cell ];
+				const Bit::Uint32 end = m_CellStarts[ cell + 1 ];
+
+				for( Bit::Uint32 i = begin; i < end; i++ )
+				{
+					const Bit::SizeType a = m_Items[ i ];
+
+					// Pairs inside of the cell.
+					for( Bit::Uint32 j = i + 1; j < end; j++ )
+					{
+						p_Function( a, static_cast<Bit::SizeType>( m_Items[ j ] ) );
+					}
+
+					// Pairs with the forward neighbours, right, below left, below and below right,
+					// the other four neighbours visit this cell instead.
+					static const int offsets[ 4 ][ 2 ] = { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+					for( Bit::SizeType k = 0; k < 4; k++ )
+					{
+						const int neighbourColumn = static_cast<int>( column ) + offsets[ k ][ 0 ];
+						const int neighbourRow = static_cast<int>( row ) + offsets[ k ][ 1 ];
+						if( neighbourColumn < 0 || neighbourColumn >= static_cast<int>( m_Columns ) ||
+							neighbourRow >= static_cast<int>( m_Rows ) )
+						{
+							continue;
+						}
+
+						const Bit::SizeType neighbour = static_cast<Bit::SizeType>( neighbourRow ) * m_Columns + neighbourColumn;
+						for( Bit::Uint32 j = m_CellStarts[ neighbour ]; j < m_CellStarts[ neighbour + 1 ]; j++ )
+						{
+							p_Function( a, static_cast<Bit::SizeType>( m_Items[ j ] ) );
+						}
+					}
+				}
+			}
+		}
+	}
+
+	template<typename Function>
+	void UniformGrid::ForEachInCell( const Bit::Float32 p_X, const Bit::Float32 p_Y, Function p_Function ) const
+	{
+		if( m_CellStarts.empty( ) )
+		{
+			return;
+		}
+
+		const Bit::SizeType cell = GetRow( p_Y ) * m_Columns + GetColumn( p_X );
+		for( Bit::Uint32 i = m_CellStarts[ cell ]; i < m_CellStarts[ cell + 1 ]; i++ )
+		{
+			p_Function( static_cast<Bit::SizeType>( m_Items[ i ] ) );
+		}
+	}
+
+}
+
+#endif
\ No newline at end of file
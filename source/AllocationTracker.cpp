@@ -0,0 +1,348 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <AllocationTracker.hpp>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#if defined( _MSC_VER ) && defined( _DEBUG )
+	#include <crtdbg.h>
+	#define PONG_ALLOCATION_HOOK
+#endif
+// Bit/System/MemoryLeak.hpp is not included, this file replaces the global operator new.
+
+#if defined( _MSC_VER )
+	#define PONG_THREAD_LOCAL __declspec( thread )
+#else
+	#define PONG_THREAD_LOCAL __thread
+#endif
+
+// Thread local counters, plain integers, safe to use before any constructor runs.
+static PONG_THREAD_LOCAL Bit::Uint64 g_Allocations = 0;
+static PONG_THREAD_LOCAL Bit::Uint64 g_Frees = 0;
+static PONG_THREAD_LOCAL Bit::Uint64 g_Bytes = 0;
+
+#if defined( PONG_ALLOCATION_HOOK )
+
+	// Count every allocation of the debug heap, except the internal ones of the CRT.
+	static int AllocationHook(	int p_Type, void * p_pData, size_t p_Size, int p_BlockType,
+								long p_Request, const unsigned char * p_pFile, int p_Line )
+	{
+		if( _BLOCK_TYPE( p_BlockType ) == _CRT_BLOCK )
+		{
+			return TRUE;
+		}
+
+		if( p_Type == _HOOK_ALLOC || p_Type == _HOOK_REALLOC )
+		{
+			Pong::AllocationTracker::RecordAllocation( p_Size );
+		}
+		else if( p_Type == _HOOK_FREE )
+		{
+			Pong::AllocationTracker::RecordFree( );
+		}
+
+		return TRUE;
+	}
+
+	static int InstallAllocationHook( )
+	{
+		_CrtSetAllocHook( AllocationHook );
+		return 0;
+	}
+
+	static const int g_AllocationHook = InstallAllocationHook( );
+
+#else
+
+	// Replaced global allocation functions.
+	void * operator new( std::size_t p_Size )
+	{
+		Pong::AllocationTracker::RecordAllocation( p_Size );
+		void * pMemory = std::malloc( p_Size ? p_Size : 1 );
+		if( pMemory == NULL )
+		{
+			throw std::bad_alloc( );
+		}
+		return pMemory;
+	}
+
+	void * operator new[ ]( std::size_t p_Size )
+	{
+		return operator new( p_Size );
+	}
+
+	void * operator new( std::size_t p_Size, const std::nothrow_t & ) throw( )
+	{
+		Pong::AllocationTracker::RecordAllocation( p_Size );
+		return std::malloc( p_Size ? p_Size : 1 );
+	}
+
+	void * operator new[ ]( std::size_t p_Size, const std::nothrow_t & p_Nothrow ) throw( )
+	{
+		return operator new( p_Size, p_Nothrow );
+	}
+
+	void operator delete( void * p_pMemory ) throw( )
+	{
+		if( p_pMemory )
+		{
+			Pong::AllocationTracker::RecordFree( );
+			std::free( p_pMemory );
+		}
+	}
+
+	void operator delete[ ]( void * p_pMemory ) throw( )
+	{
+		operator delete( p_pMemory );
+	}
+
+	void operator delete( void * p_pMemory, const std::nothrow_t & ) throw( )
+	{
+		operator delete( p_pMemory );
+	}
+
+	void operator delete[ ]( void * p_pMemory, const std::nothrow_t & ) throw( )
+	{
+		operator delete( p_pMemory );
+	}
+
+#endif
+
+namespace Pong
+{
+
+	// Allocation counters structure
+	AllocationCounters::AllocationCounters( ) :
+		Allocations( 0 ),
+		Frees( 0 ),
+		Bytes( 0 )
+	{
+	}
+
+	AllocationCounters AllocationCounters::operator -( const AllocationCounters & p_Counters ) const
+	{
+		AllocationCounters counters;
+		counters.Allocations = Allocations - p_Counters.Allocations;
+		counters.Frees = Frees - p_Counters.Frees;
+		counters.Bytes = Bytes - p_Counters.Bytes;
+		return counters;
+	}
+
+	AllocationCounters & AllocationCounters::operator +=( const AllocationCounters & p_Counters )
+	{
+		Allocations += p_Counters.Allocations;
+		Frees += p_Counters.Frees;
+		Bytes += p_Counters.Bytes;
+		return *this;
+	}
+
+	// Allocation tracker class
+	AllocationCounters AllocationTracker::GetThreadCounters( )
+	{
+		AllocationCounters counters;
+		counters.Allocations = g_Allocations;
+		counters.Frees = g_Frees;
+		counters.Bytes = g_Bytes;
+		return counters;
+	}
+
+	void AllocationTracker::RecordAllocation( const Bit::SizeType p_Size )
+	{
+		g_Allocations++;
+		g_Bytes += p_Size;
+	}
+
+	void AllocationTracker::RecordFree( )
+	{
+		g_Frees++;
+	}
+
+	// Allocation report class
+	AllocationReport::eCheck AllocationReport::GetDefaultCheck( )
+	{
+	#if defined( NDEBUG )
+		return Off;
+	#else
+		return Report;
+	#endif
+	}
+
+	AllocationReport::AllocationReport( const char * p_pName, const eCheck p_Check, const Bit::Uint32 p_WarmUpFrames ) :
+		m_pName( p_pName ),
+		m_Check( p_Check ),
+		m_WarmUpFrames( p_WarmUpFrames ),
+		m_SteadyFrames( 0 ),
+		m_Frame( 0 ),
+		m_Violations( 0 ),
+		m_PhaseCount( 0 ),
+		m_pCurrentPhase( NULL )
+	{
+	}
+
+	void AllocationReport::SetCheck( const eCheck p_Check )
+	{
+		m_Check = p_Check;
+	}
+
+	void AllocationReport::ResetSteadyState( )
+	{
+		m_SteadyFrames = 0;
+	}
+
+	void AllocationReport::BeginFrame( )
+	{
+		for( Bit::SizeType i = 0; i < m_PhaseCount; i++ )
+		{
+			m_Phases[ i ].Counters = AllocationCounters( );
+		}
+		m_pCurrentPhase = NULL;
+	}
+
+	Bit::Bool AllocationReport::EndFrame( )
+	{
+		EndPhase( );
+
+		m_FrameCounters = AllocationCounters( );
+		for( Bit::SizeType i = 0; i < m_PhaseCount; i++ )
+		{
+			m_FrameCounters += m_Phases[ i ].Counters;
+		}
+
+		const Bit::Bool steady = m_SteadyFrames >= m_WarmUpFrames;
+		if( steady == false )
+		{
+			m_SteadyFrames++;
+		}
+		m_Frame++;
+
+		if( steady == false || m_FrameCounters.Allocations == 0 )
+		{
+			return true;
+		}
+
+		// Report the first violation, then at every power of two to not flood the output.
+		m_Violations++;
+		if( m_Check != Off && ( m_Violations & ( m_Violations - 1 ) ) == 0 )
+		{
+			PrintFrame( );
+		}
+
+		assert( m_Check != Assert && "Steady state frame allocated." );
+
+		return false;
+	}
+
+	void AllocationReport::BeginPhase( const char * p_pName )
+	{
+		EndPhase( );
+
+		m_pCurrentPhase = FindPhase( p_pName );
+		m_PhaseStart = AllocationTracker::GetThreadCounters( );
+	}
+
+	void AllocationReport::EndPhase( )
+	{
+		if( m_pCurrentPhase == NULL )
+		{
+			return;
+		}
+
+		m_pCurrentPhase->Counters += AllocationTracker::GetThreadCounters( ) - m_PhaseStart;
+		m_pCurrentPhase = NULL;
+	}
+
+	void AllocationReport::Add( const char * p_pName, const AllocationCounters & p_Counters )
+	{
+		Phase * pPhase = FindPhase( p_pName );
+		if( pPhase )
+		{
+			pPhase->Counters += p_Counters;
+		}
+	}
+
+	const AllocationCounters & AllocationReport::GetFrameCounters( ) const
+	{
+		return m_FrameCounters;
+	}
+
+	Bit::Uint64 AllocationReport::GetViolationCount( ) const
+	{
+		return m_Violations;
+	}
+
+	AllocationReport::Phase * AllocationReport::FindPhase( const char * p_pName )
+	{
+		for( Bit::SizeType i = 0; i < m_PhaseCount; i++ )
+		{
+			if( m_Phases[ i ].pName == p_pName || std::strcmp( m_Phases[ i ].pName, p_pName ) == 0 )
+			{
+				return &m_Phases[ i ];
+			}
+		}
+
+		// Phases are added on first use, and kept for the following frames.
+		if( m_PhaseCount == MaxPhases )
+		{
+			return NULL;
+		}
+
+		Phase * pPhase = &m_Phases[ m_PhaseCount++ ];
+		pPhase->pName = p_pName;
+		pPhase->Counters = AllocationCounters( );
+		return pPhase;
+	}
+
+	void AllocationReport::PrintFrame( ) const
+	{
+		std::cout	<< m_pName << " " << m_Frame << " allocated " << m_FrameCounters.Allocations
+					<< " times, " << m_FrameCounters.Bytes << " bytes, in steady state ("
+					<< m_Violations << " frames so far):";
+
+		for( Bit::SizeType i = 0; i < m_PhaseCount; i++ )
+		{
+			const AllocationCounters & counters = m_Phases[ i ].Counters;
+			if( counters.Allocations > 0 )
+			{
+				std::cout << " " << m_Phases[ i ].pName << " " << counters.Allocations << "/" << counters.Bytes;
+			}
+		}
+
+		std::cout << std::endl;
+	}
+
+	// Allocation scope class
+	AllocationScope::AllocationScope( AllocationReport & p_Report, const char * p_pName ) :
+		m_Report( p_Report )
+	{
+		m_Report.BeginPhase( p_pName );
+	}
+
+	AllocationScope::~AllocationScope( )
+	{
+		m_Report.EndPhase( );
+	}
+
+}
\ No newline at end of file
@@ -21,3 +21,36 @@
 //    source distribution.
 // ///////////////////////////////////////////////////////////////////////////
 
+#include <Ball.hpp>
+#include <BlockPool.hpp>
+#include <new>
+
+namespace Pong
+{
+
+	// Block pool of all balls, allocated 64 at a time.
+	static BlockPool g_BallPool( sizeof( Ball ), 64 );
+
+	void * Ball::operator new( std::size_t p_Size )
+	{
+		// Derived classes are larger than the blocks.
+		if( p_Size != sizeof( Ball ) )
+		{
+			return ::operator new( p_Size );
+		}
+
+		return g_BallPool.Allocate( );
+	}
+
+	void Ball::operator delete( void * p_pPointer, std::size_t p_Size )
+	{
+		if( p_Size != sizeof( Ball ) )
+		{
+			::operator delete( p_pPointer );
+			return;
+		}
+
+		g_BallPool.Free( p_pPointer );
+	}
+
+}
@@ -0,0 +1,144 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <BaselineMessageListener.hpp>
+#include <Snapshot.hpp>
+#include <Client.hpp>
+#include <iostream>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+	BaselineMessageListener::BaselineMessageListener( Client * p_pClient ) :
+		m_pClient( p_pClient ),
+		m_HasSetup( false ),
+		m_Mode( 0 ),
+		m_ObstacleCount( 0 ),
+		m_Seed( 0 ),
+		m_BallCount( 0 )
+	{
+	}
+
+	void BaselineMessageListener::HandleMessage( Packet & p_Message )
+	{
+		// Ignore the message if already initialized.
+		if( m_pClient->m_Initialized.Get( ) == true )
+		{
+			return;
+		}
+
+		// Error check the message size
+		if( p_Message.GetRemainingSize( ) < 28 + Snapshot::HeaderSize )
+		{
+			return;
+		}
+
+		// Read the slot, the server is full if there is none.
+		const Bit::Uint8 slot = p_Message.ReadByte( );
+		if( slot > 1 )
+		{
+			m_pClient->m_Initialized.Set( false );
+			m_pClient->m_InitSemaphore.Release( );
+			return;
+		}
+
+		// Read the resume token and the match setup.
+		const Bit::Uint64 token = p_Message.ReadUint64( );
+		const Bit::Uint8 mode = p_Message.ReadByte( );
+		const Bit::Uint16 obstacleCount = p_Message.ReadUint16( );
+		const Bit::Uint32 seed = p_Message.ReadUint32( );
+		const Bit::Float32 ballRadius = p_Message.ReadFloat( );
+		const Bit::Float32 playerWidth = p_Message.ReadFloat( );
+		const Bit::Float32 playerHeight = p_Message.ReadFloat( );
+
+		// Read the state of every entity.
+		Snapshot::Header header;
+		if( Snapshot::Read( p_Message, header, m_Balls, m_Players ) == false || header.BallCount != header.TotalBallCount )
+		{
+			m_pClient->m_Initialized.Set( false );
+			m_pClient->m_InitSemaphore.Release( );
+			return;
+		}
+
+		// A server that took over with other settings runs another setup,
+		// the main thread draws the entities and shapes of the first one.
+		if( m_HasSetup &&
+			( mode != m_Mode || obstacleCount != m_ObstacleCount || seed != m_Seed || header.TotalBallCount != m_BallCount ) )
+		{
+			std::cout << "The server runs another match setup, can not resume." << std::endl;
+			m_pClient->m_ResumeToken = 0;
+			m_pClient->m_Initialized.Set( false );
+			m_pClient->m_InitSemaphore.Release( );
+			return;
+		}
+		const Bit::Bool resume = m_HasSetup;
+		m_HasSetup = true;
+		m_Mode = mode;
+		m_ObstacleCount = obstacleCount;
+		m_Seed = seed;
+		m_BallCount = header.TotalBallCount;
+
+		m_pClient->m_UserId.Set( slot );
+		m_pClient->m_ResumeToken = token;
+		m_pClient->m_GameMode = mode == GameMode::MultiBall ? GameMode::MultiBall : GameMode::Classic;
+
+		// Create the balls of the server on the first baseline, the first ball always exists.
+		while( m_pClient->m_Balls.GetCount( ) < header.TotalBallCount )
+		{
+			m_pClient->m_Balls.Create( );
+		}
+
+		// Set the state of every entity, the first frame is correct.
+		for( Bit::SizeType i = 0; i < header.TotalBallCount; i++ )
+		{
+			Ball * pBall = m_pClient->m_Balls.Get( i );
+			pBall->Position.Set( Bit::Vector2f32( m_Balls.PositionX[ i ], m_Balls.PositionY[ i ] ) );
+			pBall->Rotation.Set( m_Balls.Rotation[ i ] );
+			pBall->Size.Set( Bit::Vector2f32( ballRadius, ballRadius ) );
+		}
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			m_pClient->m_pPlayers[ i ]->Position.Set( Bit::Vector2f32( m_Players.PositionX[ i ], m_Players.PositionY[ i ] ) );
+			m_pClient->m_pPlayers[ i ]->Size.Set( Bit::Vector2f32( playerWidth, playerHeight ) );
+		}
+
+		// The tick of the baseline stands in for the server tick until the clock is synchronized.
+		m_pClient->m_TimeSyncMutex.Lock( );
+		if( m_pClient->m_TickInterval == 0 )
+		{
+			m_pClient->m_ServerTick = header.Tick;
+		}
+		m_pClient->m_TimeSyncMutex.Unlock( );
+
+		// Create the same obstacle layout as the server, a resume keeps it.
+		if( resume == false )
+		{
+			MultiBallMatch::CreateObstacles( seed, obstacleCount, m_pClient->m_Obstacles );
+		}
+
+		// Set the initialized flag and release the semaphore
+		m_pClient->m_Initialized.Set( true );
+		m_pClient->m_InitSemaphore.Release( );
+	}
+
+}
@@ -0,0 +1,90 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <BatchMessageListener.hpp>
+#include <MessageBatcher.hpp>
+#include <Trace.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	BatchMessageListener::BatchMessageListener( )
+	{
+		for( Bit::SizeType i = 0; i < 256; i++ )
+		{
+			m_pHandlers[ i ] = NULL;
+		}
+	}
+
+	void BatchMessageListener::Hook( MessageHandler * p_pHandler, const Bit::Uint8 p_Type )
+	{
+		m_pHandlers[ p_Type ] = p_pHandler;
+	}
+
+	void BatchMessageListener::HandleMessage( Bit::Net::HostMessageDecoder & p_Message )
+	{
+		TraceScope trace( "BatchMessageListener::HandleMessage" );
+
+		// Copy the frame out of the decoder.
+		const Bit::SizeType size = p_Message.GetMessageSize( );
+		if( size == 0 )
+		{
+			return;
+		}
+		m_Frame.Resize( size );
+		p_Message.ReadArray( m_Frame.GetData( ), size );
+
+		Dispatch( m_Frame.GetData( ), size );
+	}
+
+	void BatchMessageListener::Dispatch( const Bit::Uint8 * p_pFrame, const Bit::SizeType p_Size )
+	{
+		Bit::SizeType position = 0;
+
+		while( position + MessageBatcher::RecordHeaderSize <= p_Size )
+		{
+			// Read the record header
+			const Bit::Uint8 type = p_pFrame[ position ];
+			const Bit::SizeType size =	static_cast<Bit::SizeType>( p_pFrame[ position + 1 ] ) |
+										( static_cast<Bit::SizeType>( p_pFrame[ position + 2 ] ) << 8 );
+			position += MessageBatcher::RecordHeaderSize;
+
+			// Error check the record size, the rest of the frame is corrupt.
+			if( position + size > p_Size )
+			{
+				return;
+			}
+
+			// Dispatch the payload
+			if( m_pHandlers[ type ] )
+			{
+				m_Record.Assign( p_pFrame + position, size );
+				m_pHandlers[ type ]->HandleMessage( m_Record );
+			}
+
+			position += size;
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <BlockPool.hpp>
+#include <new>
+
+namespace Pong
+{
+
+	BlockPool::BlockPool( const Bit::SizeType p_BlockSize, const Bit::SizeType p_BlocksPerChunk ) :
+		m_BlockSize( p_BlockSize ),
+		m_BlocksPerChunk( p_BlocksPerChunk ? p_BlocksPerChunk : 1 ),
+		m_pFreeList( NULL ),
+		m_UsedCount( 0 )
+	{
+		// The free list is stored inside of the free blocks,
+		// round the block size up to keep each block 16 byte aligned.
+		if( m_BlockSize < sizeof( void * ) )
+		{
+			m_BlockSize = sizeof( void * );
+		}
+		m_BlockSize = ( m_BlockSize + 15 ) & ~static_cast<Bit::SizeType>( 15 );
+	}
+
+	BlockPool::~BlockPool( )
+	{
+		for( Bit::SizeType i = 0; i < m_Chunks.size( ); i++ )
+		{
+			::operator delete( m_Chunks[ i ] );
+		}
+	}
+
+	void * BlockPool::Allocate( )
+	{
+		m_Mutex.Lock( );
+
+		// Allocate a new chunk and add its blocks to the free list.
+		if( m_pFreeList == NULL )
+		{
+			Bit::Uint8 * pChunk = static_cast<Bit::Uint8 *>( ::operator new( m_BlockSize * m_BlocksPerChunk ) );
+			m_Chunks.push_back( pChunk );
+
+			for( Bit::SizeType i = m_BlocksPerChunk; i > 0; i-- )
+			{
+				void * pBlock = pChunk + ( ( i - 1 ) * m_BlockSize );
+				*static_cast<void **>( pBlock ) = m_pFreeList;
+				m_pFreeList = pBlock;
+			}
+		}
+
+		// Pop a block from the free list.
+		void * pBlock = m_pFreeList;
+		m_pFreeList = *static_cast<void **>( pBlock );
+		m_UsedCount++;
+
+		m_Mutex.Unlock( );
+		return pBlock;
+	}
+
+	void BlockPool::Free( void * p_pBlock )
+	{
+		if( p_pBlock == NULL )
+		{
+			return;
+		}
+
+		m_Mutex.Lock( );
+
+		*static_cast<void **>( p_pBlock ) = m_pFreeList;
+		m_pFreeList = p_pBlock;
+		m_UsedCount--;
+
+		m_Mutex.Unlock( );
+	}
+
+	Bit::SizeType BlockPool::GetBlockSize( ) const
+	{
+		return m_BlockSize;
+	}
+
+	Bit::SizeType BlockPool::GetUsedCount( ) const
+	{
+		return m_UsedCount;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bot.hpp>
+#include <Field.hpp>
+#include <cmath>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Global variables
+
+	// Distance to the target within which the paddle stands still, so it does not jitter.
+	static const Bit::Float32 g_DeadZone = Field::PlayerHeight * 0.25f;
+
+	// Bot class
+	void Bot::Think(	const Bit::Float32 p_PaddleY, const Bit::Float32 p_TargetY,
+						bool & p_IsMoving, eDirection & p_Direction )
+	{
+		if( p_TargetY > p_PaddleY + g_DeadZone )
+		{
+			p_IsMoving = true;
+			p_Direction = eDirection::Up;
+		}
+		else if( p_TargetY < p_PaddleY - g_DeadZone )
+		{
+			p_IsMoving = true;
+			p_Direction = eDirection::Down;
+		}
+		else
+		{
+			p_IsMoving = false;
+		}
+	}
+
+	Bit::Float32 Bot::FindTarget(	const BallStates & p_Balls, const Bit::SizeType p_First,
+									const Bit::SizeType p_Count, const Bit::Float32 p_PaddleX )
+	{
+		Bit::Float32 target = Field::Height * 0.5f;
+		Bit::Float32 nearest = Field::Width * 2.0f;
+
+		for( Bit::SizeType i = p_First; i < p_First + p_Count; i++ )
+		{
+			const Bit::Float32 distance = std::fabs( p_Balls.PositionX[ i ] - p_PaddleX );
+			if( distance < nearest )
+			{
+				nearest = distance;
+				target = p_Balls.PositionY[ i ];
+			}
+		}
+
+		return target;
+	}
+
+	void Bot::Play( MatchBatch & p_Matches, const Bit::SizeType p_First, const Bit::SizeType p_Count )
+	{
+		const BallStates & balls = p_Matches.GetBallStates( );
+		const PlayerStates & players = p_Matches.GetPlayerStates( );
+		const Bit::SizeType end = p_First + p_Count < p_Matches.GetMatchCount( ) ? p_First + p_Count : p_Matches.GetMatchCount( );
+
+		for( Bit::SizeType i = p_First; i < end; i++ )
+		{
+			for( Bit::SizeType j = 0; j < 2; j++ )
+			{
+				bool isMoving = false;
+				eDirection direction = eDirection::Up;
+				Think( players.PositionY[ i * 2 + j ], balls.PositionY[ i ], isMoving, direction );
+				p_Matches.SetPlayerInput( i, j, isMoving, direction );
+			}
+		}
+	}
+
+	void Bot::Play( MultiBallMatch & p_Match )
+	{
+		const BallStates & balls = p_Match.GetBallStates( );
+		const PlayerStates & players = p_Match.GetPlayerStates( );
+
+		for( Bit::SizeType j = 0; j < 2; j++ )
+		{
+			bool isMoving = false;
+			eDirection direction = eDirection::Up;
+			const Bit::Float32 target = FindTarget( balls, 0, balls.GetCount( ), players.PositionX[ j ] );
+			Think( players.PositionY[ j ], target, isMoving, direction );
+			p_Match.SetPlayerInput( j, isMoving, direction );
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,355 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Checkpoint.hpp>
+#include <atomic>
+#include <cstring>
+#if defined( BIT_PLATFORM_WINDOWS )
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Global variables
+	static const Bit::Uint32 g_Magic = 0x4B43504E; // "NPCK"
+	static const Bit::Uint32 g_Version = 3;
+	static const Bit::SizeType g_HeaderSize = 64;
+
+	// Global functions
+
+	// FNV-1a hash, to detect a slot that was overwritten while read.
+	static Bit::Uint32 Checksum( const Bit::Uint8 * p_pData, const Bit::SizeType p_Size )
+	{
+		Bit::Uint32 hash = 2166136261U;
+		for( Bit::SizeType i = 0; i < p_Size; i++ )
+		{
+			hash = ( hash ^ p_pData[ i ] ) * 16777619U;
+		}
+		return hash;
+	}
+
+	// Header of the file, shared by the processes mapping it.
+	struct Checkpoint::Header
+	{
+		Bit::Uint32					Magic;
+		Bit::Uint32					Version;
+		Bit::Uint64					Capacity;
+		std::atomic<Bit::Uint32>	Control;		///< 0 owned, 1 handover requested, 2 released.
+		std::atomic<Bit::Uint32>	Sequence;		///< Number of written checkpoints, the newest is in slot Sequence % 2.
+		Bit::Uint64					Sizes[ 2 ];
+		Bit::Uint32					Checksums[ 2 ];
+	};
+
+	enum eControl
+	{
+		Owned = 0,
+		HandoverRequested = 1,
+		Released = 2
+	};
+
+	// Checkpoint class
+	Checkpoint::Checkpoint( ) :
+		m_File( -1 ),
+		m_Mapping( -1 ),
+		m_pData( NULL ),
+		m_Size( 0 ),
+		m_pHeader( NULL )
+	{
+		static_assert( sizeof( Header ) <= g_HeaderSize, "The checkpoint header does not fit." );
+	}
+
+	Checkpoint::~Checkpoint( )
+	{
+		Close( );
+	}
+
+	Bit::Bool Checkpoint::Create( const std::string & p_Path, const Bit::SizeType p_Capacity )
+	{
+		Close( );
+
+		if( Map( p_Path, g_HeaderSize + p_Capacity * 2, true ) == false )
+		{
+			return false;
+		}
+
+		// The file is zero filled, which is a valid state of the atomics.
+		m_pHeader->Magic = g_Magic;
+		m_pHeader->Version = g_Version;
+		m_pHeader->Capacity = p_Capacity;
+		m_pHeader->Sizes[ 0 ] = m_pHeader->Sizes[ 1 ] = 0;
+		m_pHeader->Checksums[ 0 ] = m_pHeader->Checksums[ 1 ] = 0;
+		m_pHeader->Control.store( Owned );
+		m_pHeader->Sequence.store( 0 );
+		return true;
+	}
+
+	Bit::Bool Checkpoint::Open( const std::string & p_Path )
+	{
+		Close( );
+
+		if( Map( p_Path, 0, false ) == false )
+		{
+			return false;
+		}
+
+		if( m_Size < g_HeaderSize ||
+			m_pHeader->Magic != g_Magic ||
+			m_pHeader->Version != g_Version ||
+			g_HeaderSize + m_pHeader->Capacity * 2 > m_Size )
+		{
+			Close( );
+			return false;
+		}
+
+		return true;
+	}
+
+	void Checkpoint::Close( )
+	{
+		if( m_File == -1 )
+		{
+			return;
+		}
+
+	#if defined( BIT_PLATFORM_WINDOWS )
+		if( m_pData )
+		{
+			UnmapViewOfFile( m_pData );
+		}
+		if( m_Mapping != -1 )
+		{
+			CloseHandle( reinterpret_cast<HANDLE>( m_Mapping ) );
+		}
+		CloseHandle( reinterpret_cast<HANDLE>( m_File ) );
+	#else
+		if( m_pData )
+		{
+			munmap( m_pData, m_Size );
+		}
+		close( static_cast<int>( m_File ) );
+	#endif
+
+		m_File = -1;
+		m_Mapping = -1;
+		m_pData = NULL;
+		m_Size = 0;
+		m_pHeader = NULL;
+	}
+
+	Bit::Bool Checkpoint::IsOpen( ) const
+	{
+		return m_pHeader != NULL;
+	}
+
+	Bit::SizeType Checkpoint::GetCapacity( ) const
+	{
+		return m_pHeader ? static_cast<Bit::SizeType>( m_pHeader->Capacity ) : 0;
+	}
+
+	Bit::Bool Checkpoint::Write( const Packet & p_Packet )
+	{
+		if( m_pHeader == NULL || p_Packet.GetSize( ) > m_pHeader->Capacity )
+		{
+			return false;
+		}
+
+		// Only this process writes, the other slot is the newest checkpoint.
+		const Bit::Uint32 sequence = m_pHeader->Sequence.load( std::memory_order_relaxed ) + 1;
+		const Bit::Uint32 slot = sequence % 2;
+
+		std::memcpy( GetSlot( slot ), p_Packet.GetData( ), p_Packet.GetSize( ) );
+		m_pHeader->Sizes[ slot ] = p_Packet.GetSize( );
+		m_pHeader->Checksums[ slot ] = Checksum( p_Packet.GetData( ), p_Packet.GetSize( ) );
+		m_pHeader->Sequence.store( sequence, std::memory_order_release );
+		return true;
+	}
+
+	Bit::Bool Checkpoint::Read( Packet & p_Packet ) const
+	{
+		if( m_pHeader == NULL )
+		{
+			return false;
+		}
+
+		// Retry if the writer wrapped around to the slot while it was copied.
+		for( Bit::SizeType attempt = 0; attempt < 4; attempt++ )
+		{
+			const Bit::Uint32 sequence = m_pHeader->Sequence.load( std::memory_order_acquire );
+			if( sequence == 0 )
+			{
+				return false;
+			}
+
+			const Bit::Uint32 slot = sequence % 2;
+			const Bit::Uint64 size = m_pHeader->Sizes[ slot ];
+			const Bit::Uint32 checksum = m_pHeader->Checksums[ slot ];
+			if( size > m_pHeader->Capacity )
+			{
+				continue;
+			}
+
+			p_Packet.Clear( );
+			p_Packet.WriteArray( GetSlot( slot ), static_cast<Bit::SizeType>( size ) );
+
+			std::atomic_thread_fence( std::memory_order_acquire );
+			if( m_pHeader->Sequence.load( std::memory_order_relaxed ) - sequence < 2 &&
+				Checksum( p_Packet.GetData( ), p_Packet.GetSize( ) ) == checksum )
+			{
+				return true;
+			}
+		}
+
+		p_Packet.Clear( );
+		return false;
+	}
+
+	void Checkpoint::RequestHandover( )
+	{
+		if( m_pHeader )
+		{
+			m_pHeader->Control.store( HandoverRequested );
+		}
+	}
+
+	Bit::Bool Checkpoint::IsHandoverRequested( ) const
+	{
+		return m_pHeader && m_pHeader->Control.load( ) == HandoverRequested;
+	}
+
+	void Checkpoint::Release( )
+	{
+		if( m_pHeader )
+		{
+			m_pHeader->Control.store( Released );
+		}
+	}
+
+	Bit::Bool Checkpoint::IsReleased( ) const
+	{
+		return m_pHeader && m_pHeader->Control.load( ) == Released;
+	}
+
+	void Checkpoint::Acquire( )
+	{
+		if( m_pHeader )
+		{
+			m_pHeader->Control.store( Owned );
+		}
+	}
+
+	Bit::Bool Checkpoint::Map( const std::string & p_Path, const Bit::SizeType p_Size, const Bit::Bool p_Create )
+	{
+		Bit::SizeType size = p_Size;
+
+	#if defined( BIT_PLATFORM_WINDOWS )
+		HANDLE file = CreateFileA(	p_Path.c_str( ), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+									NULL, p_Create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+		if( file == INVALID_HANDLE_VALUE )
+		{
+			return false;
+		}
+		m_File = reinterpret_cast<Bit::Int64>( file );
+
+		if( p_Create == false )
+		{
+			LARGE_INTEGER fileSize;
+			if( GetFileSizeEx( file, &fileSize ) == FALSE || fileSize.QuadPart == 0 )
+			{
+				Close( );
+				return false;
+			}
+			size = static_cast<Bit::SizeType>( fileSize.QuadPart );
+		}
+
+		// The mapping grows a new file to the mapped size.
+		const Bit::Uint64 mappingSize = static_cast<Bit::Uint64>( size );
+		HANDLE mapping = CreateFileMappingA(	file, NULL, PAGE_READWRITE,
+												static_cast<DWORD>( mappingSize >> 32 ),
+												static_cast<DWORD>( mappingSize & 0xFFFFFFFF ), NULL );
+		if( mapping == NULL )
+		{
+			Close( );
+			return false;
+		}
+		m_Mapping = reinterpret_cast<Bit::Int64>( mapping );
+
+		void * pData = MapViewOfFile( mapping, FILE_MAP_ALL_ACCESS, 0, 0, size );
+		if( pData == NULL )
+		{
+			Close( );
+			return false;
+		}
+	#else
+		int file = open( p_Path.c_str( ), p_Create ? ( O_RDWR | O_CREAT | O_TRUNC ) : O_RDWR, 0644 );
+		if( file < 0 )
+		{
+			return false;
+		}
+		m_File = static_cast<Bit::Int64>( file );
+
+		if( p_Create )
+		{
+			if( ftruncate( file, static_cast<off_t>( size ) ) != 0 )
+			{
+				Close( );
+				return false;
+			}
+		}
+		else
+		{
+			struct stat status;
+			if( fstat( file, &status ) != 0 || status.st_size == 0 )
+			{
+				Close( );
+				return false;
+			}
+			size = static_cast<Bit::SizeType>( status.st_size );
+		}
+
+		void * pData = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0 );
+		if( pData == MAP_FAILED )
+		{
+			Close( );
+			return false;
+		}
+	#endif
+
+		m_pData = static_cast<Bit::Uint8 *>( pData );
+		m_Size = size;
+		m_pHeader = reinterpret_cast<Header *>( m_pData );
+		return true;
+	}
+
+	Bit::Uint8 * Checkpoint::GetSlot( const Bit::Uint32 p_Slot ) const
+	{
+		return m_pData + g_HeaderSize + static_cast<Bit::SizeType>( m_pHeader->Capacity ) * p_Slot;
+	}
+
+}
\ No newline at end of file
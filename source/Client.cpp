@@ -22,6 +22,11 @@
 // ///////////////////////////////////////////////////////////////////////////
 
 #include <Client.hpp>
+#include <Server.hpp>
+#include <MessageType.hpp>
+#include <EntitySchema.hpp>
+#include <Trace.hpp>
+#include <FramePacer.hpp>
 #include <Bit/System/Sleep.hpp>
 #include <iostream>
 #include <Bit/System/MemoryLeak.hpp>
@@ -30,49 +35,69 @@ namespace Pong
 {
 
 	// Client class
-	Client::Client( ) :
+	Client::Client( const ClientSettings & p_Settings ) :
+		m_Settings( p_Settings ),
 		m_pServer( NULL ),
+		m_Balls( m_EntityManager, "Ball" ),
+		m_Players( m_EntityManager, "Player" ),
 		m_pBall( NULL ),
-		//m_UserId( 0 ),
+		m_UserId( 0 ),
 		m_Initialized( false ),
-		m_InitMessageListener( this ),
+		m_ResumeToken( 0 ),
+		m_Port( 0 ),
+		m_BaselineMessageListener( this ),
 		m_pWindow( NULL ),
-		m_pBallShape( NULL )
+		m_GameMode( GameMode::Classic ),
+		m_AllocationReport( "Client frame", AllocationReport::GetDefaultCheck( ), 120 ),
+		m_TimeSyncMessageListener( this ),
+		m_PingSequence( 0 ),
+		m_LastPingTime( 0 ),
+		m_LastPongSequence( 0 ),
+		m_LastServerTime( 0 ),
+		m_ServerTick( 0 ),
+		m_ServerTickTime( 0 ),
+		m_TickInterval( 0 ),
+		m_SnapshotMessageListener( this ),
+		m_pLocalTransport( NULL ),
+		m_LocalSnapshotMessageListener( this ),
+		m_SnapshotAck( 0 ),
+		m_SnapshotAckBits( 0 ),
+		m_SnapshotAckPending( false )
 	{
+		// Start the local clock, the time sync maps it to the server clock.
+		m_Clock.Start( );
+
 		// Set the player shapes to NULL
 		m_pPlayerShapes[ 0 ] = NULL;
 		m_pPlayerShapes[ 1 ] = NULL;
 
-		// Hook initialization host message
-		HookHostMessage( &m_InitMessageListener, "Initialize" );
+		// Hook the batch host message and the messages inside of it
+		HookHostMessage( &m_BatchMessageListener, "Batch" );
+		m_BatchMessageListener.Hook( &m_BaselineMessageListener, MessageType::Baseline );
+		m_BatchMessageListener.Hook( &m_TimeSyncMessageListener, MessageType::TimeSync );
+
+		// Hook the snapshot host message, carrying the positions and rotations.
+		HookHostMessage( &m_SnapshotMessageListener, "Snapshot" );
 
-		// Link and register ball class
-		m_EntityManager.LinkEntity<Ball>( "Ball" );
-		m_EntityManager.RegisterVariable( "Ball", "Position",	&Ball::Position );
-		m_EntityManager.RegisterVariable( "Ball", "Rotation",	&Ball::Rotation);
-		m_EntityManager.RegisterVariable( "Ball", "Size",		&Ball::Size );
-		m_EntityManager.RegisterVariable( "Ball", "Direction",	&Ball::Direction );
+		// The same messages over the local transport, handled by the main thread.
+		m_LocalBatchMessageListener.Hook( &m_BaselineMessageListener, MessageType::Baseline );
+		m_LocalBatchMessageListener.Hook( &m_TimeSyncMessageListener, MessageType::TimeSync );
 
-		// Link and register player class
-		m_EntityManager.LinkEntity<Player>( "Player" );
-		m_EntityManager.RegisterVariable( "Player", "Position", &Player::Position );
-		m_EntityManager.RegisterVariable( "Player", "Size",		&Player::Size );
+		// Link and register the entity classes of the shared schema.
+		Schema::Register( m_EntityManager );
 
 		// Create a ball
-		m_pBall = reinterpret_cast<Ball *>( m_EntityManager.CreateEntityByName( "Ball" ) );
+		m_pBall = m_Balls.Create( );
 
 		// Create the players
-		m_pPlayers[ 0 ] = reinterpret_cast<Player *>( m_EntityManager.CreateEntityByName( "Player" ) );
-		m_pPlayers[ 1 ] = reinterpret_cast<Player *>( m_EntityManager.CreateEntityByName( "Player" ) );
+		m_pPlayers[ 0 ] = m_Players.Create( );
+		m_pPlayers[ 1 ] = m_Players.Create( );
 	}
 
 	Client::~Client( )
 	{
-		// Delete the ball
-		if( m_pBall )
-		{
-			delete m_pBall;
-		}
+		// Disconnect, before the entity stores delete the ball and the players.
+		Disconnect( );
 	}
 
 	Bit::Bool Client::Join(	Server * p_pServer,
@@ -80,11 +105,42 @@ namespace Pong
 							const Bit::Uint16 p_Port,
 							const Bit::Time & p_Timeout )
 	{
-		//m_Initialized.Set( false );
+		m_Initialized.Set( false );
+
+		// Forget the clock of any previous server.
+		m_TimeSyncMutex.Lock( );
+		m_TimeSync.Reset( );
+		m_PingSequence = 0;
+		m_LastPongSequence = 0;
+		m_LastServerTime = 0;
+		m_ServerTick = 0;
+		m_TickInterval = 0;
+		m_TimeSyncMutex.Unlock( );
+
+		// Snapshot sequences start over with every connection.
+		m_SnapshotMutex.Lock( );
+		m_SnapshotAck = 0;
+		m_SnapshotAckBits = 0;
+		m_SnapshotAckPending = false;
+		m_SnapshotMutex.Unlock( );
+
+		// Pass the messages of the match in-process if the server is hosted by this process.
+		// Drop what the server wrote for the previous connection.
+		m_pLocalTransport = NULL;
+		LocalTransport * pLocalTransport = NULL;
+		if( p_pServer && p_Address.GetAddress( ) == Bit::Address::Localhost.GetAddress( ) )
+		{
+			pLocalTransport = p_pServer->GetLocalTransport( p_Port );
+		}
+		if( pLocalTransport )
+		{
+			pLocalTransport->Downstream.Clear( );
+			pLocalTransport->Overflow = false;
+		}
 
 		// Connect to the server
 		Bit::Net::Client::eStatus status;
-		status = Connect( p_Address, p_Port, p_Timeout, "NetPong" );
+		status = Connect( p_Address, p_Port, p_Timeout, Schema::GetIdentifier( ) );
 
 		// Failed to connect
 		if( status != Bit::Net::Client::Succeeded )
@@ -93,125 +149,155 @@ namespace Pong
 			return false;
 		}
 
-		// Wait for the initialize message from the server
-		//m_InitSemaphore.Wait( p_Timeout );
+		// Join the game, with the resume token of the previous connection if any.
+		Packet join;
+		join.WriteUint64( m_ResumeToken );
+		if( pLocalTransport )
+		{
+			join.WriteByte( 1 );
+		}
+		Bit::Net::UserMessage * pMessage = CreateUserMessage( "Join" );
+		pMessage->WriteArray( join.GetData( ), join.GetSize( ) );
+		pMessage->Send( );
+		delete pMessage;
+
+		// Wait for the baseline from the server
+		m_InitSemaphore.Wait( p_Timeout );
 
-		// Check if we received the initialize message
-		/*if( m_Initialized.Get( ) == false )
+		// Check if we received the baseline
+		if( m_Initialized.Get( ) == false )
 		{
+			Disconnect( );
+			m_pServer = NULL;
 			return false;
 		}
-		*/
-		//std::cout << "User id: " << m_UserId.Get( ) << std::endl;
 
-		// Succeeded to connect
+		std::cout << "Player slot: " << m_UserId.Get( ) << std::endl;
+
+		// Succeeded to connect, remember the server for a resume.
+		// The server switched to the local transport after the baseline.
+		m_pLocalTransport = pLocalTransport;
 		m_pServer = p_pServer;
+		m_Address = p_Address;
+		m_Port = p_Port;
+		m_Timeout = p_Timeout;
 		return true;
 	}
 
+	Bit::Bool Client::Resume( )
+	{
+		if( m_ResumeToken == 0 )
+		{
+			return false;
+		}
+
+		std::cout << "Lost the connection, resuming." << std::endl;
+		return Join( m_pServer, m_Address, m_Port, m_Timeout );
+	}
+
 	Bit::Bool Client::Run( )
 	{
-		// Create graphics.
-		CreateGraphics( );
+		// Create graphics, headless clients run the frames without a window.
+		if( m_Settings.Headless == false )
+		{
+			CreateGraphics( );
+		}
+		else
+		{
+			m_HeadlessShapes.resize( 2 + m_Balls.GetCount( ) );
+		}
+		Trace::SetThreadName( "Client" );
+
+		// Pace the frames and measure them.
+		FramePacer pacer( m_Settings.FrameRate );
+		Bit::Timer frameTimer;
+		Bit::Uint64 frame = 0;
+		m_FrameTimes.Reset( );
+		m_FrameCosts.Reset( );
 
 		// Capture the lapsed time.
 		Bit::Timer lapsedTime;
 		lapsedTime.Start();
 
 		// Main loop
-		while( IsConnected( ) && m_pWindow->IsOpen( ) )
+		while( ( IsConnected( ) || Resume( ) ) && ( m_pWindow == NULL || m_pWindow->IsOpen( ) ) )
 		{
-			// Update the window
-			m_pWindow->Update( );
+			frameTimer.Start( );
+
+			// Trace the frame and count its allocations, per phase.
+			TraceScope frameTrace( "Frame" );
+			m_AllocationReport.BeginFrame( );
+			m_AllocationReport.BeginPhase( "Events" );
+
+			// Handle the messages of a server hosted by this process.
+			ReceiveLocalMessages( );
+
+			// Keep the server clock in sync.
+			UpdateTimeSync( );
 
-			// Handle window events.
-			Bit::Event wEvent;
-			while( m_pWindow->PollEvent( wEvent ) )
+			// Acknowledge the received snapshots.
+			SendSnapshotAck( );
+
+			if( m_pWindow )
 			{
-				// Check the window envent.
-				switch( wEvent.Type )
+				// Update the window
 				{
-					// Key press events
-					case Bit::Event::KeyJustPressed:
-					{
-						if( wEvent.Key == Bit::Keyboard::W )
-						{
-							// Pre-store the messages??
-							Bit::Net::UserMessage * pMessage = CreateUserMessage( "Move" );
-							pMessage->WriteByte( eDirection::Up );
-							pMessage->Send( );
-							delete pMessage;
-						}
-						else if( wEvent.Key == Bit::Keyboard::S )
-						{
-							// Pre-store the messages??
-							Bit::Net::UserMessage * pMessage = CreateUserMessage( "Move" );
-							pMessage->WriteByte( eDirection::Down );
-							pMessage->Send( );
-							delete pMessage;
-						}
-					}
-					break;
-					case Bit::Event::KeyJustReleased:
-					{
+					TraceScope trace( "Update" );
+					m_pWindow->Update( );
+				}
 
-						if (wEvent.Key == Bit::Keyboard::W)
-						{
-
-							// Pre-store the messages??
-							Bit::Net::UserMessage * pMessage = CreateUserMessage("StopMove");
-							pMessage->Send();
-							delete pMessage;
-						}
-						else if (wEvent.Key == Bit::Keyboard::S)
-						{
-							// Pre-store the messages??
-							Bit::Net::UserMessage * pMessage = CreateUserMessage("StopMove");
-							pMessage->Send();
-							delete pMessage;
-						}
-						else if( wEvent.Key == Bit::Keyboard::Num2 )
-						{
-							m_pWindow->Close( );
-						}
-					}
-					break;
-					case Bit::Event::Closed:
-					{
-						m_pWindow->Close( );
-					}
-					break;
+				// Handle window events.
+				{
+					TraceScope trace( "PollEvent" );
+					HandleEvents( );
+				}
 
-				default:
+				// Check again if the window is open
+				if( m_pWindow->IsOpen( ) == false )
+				{
 					break;
 				}
-
 			}
 
-			// Check again if the window is open
-			if( m_pWindow->IsOpen( ) == false )
+			// Render the shapes
+			m_AllocationReport.BeginPhase( "Render" );
 			{
-				break;
+				TraceScope trace( "Draw" );
+				Draw( );
 			}
 
-			// Render the shapes
-			for( Bit::SizeType i = 0; i < 2; i++ )
+			// Present the window, graphics.
+			m_AllocationReport.BeginPhase( "Present" );
+			if( m_pWindow )
 			{
-				m_pPlayerShapes[i]->SetPosition(m_pPlayers[i]->Position.Get() * 100.0f);
-				m_pWindow->Draw(m_pPlayerShapes[i], Bit::PrimitiveMode::LineStrip);
+				TraceScope trace( "Present" );
+				m_pWindow->Present( );
 			}
-			m_pBallShape->SetPosition(m_pBall->Position.Get() * 100.0f);
-			m_pBallShape->SetRotation(Bit::Radians(m_pBall->Rotation.Get()));
-			m_pWindow->Draw(m_pBallShape, Bit::PrimitiveMode::LineStrip);
+			m_AllocationReport.EndFrame( );
+			m_FrameCosts.Add( frameTimer.GetLapsedTime( ) );
 
-			// Present the window, graphics.
-			m_pWindow->Present( );
+			// Wait for the next frame, the frame time includes the wait.
+			{
+				TraceScope trace( "Pace" );
+				pacer.Wait( );
+			}
+			if( frame > 0 )
+			{
+				m_FrameTimes.Add( pacer.GetFrameTime( ) );
+			}
 
-			//std::cout << "Player: " << m_pPlayers[ m_UserId.Get( ) ]->Position.Get( ).x << "   " << m_pPlayers[ m_UserId.Get( ) ]->Position.Get( ).y << std::endl;
+			// Stop after the given number of frames, if any.
+			frame++;
+			if( m_Settings.FrameCount > 0 && frame >= m_Settings.FrameCount )
+			{
+				break;
+			}
 		}
 
 		lapsedTime.Stop();
 		std::cout << "Ran game for " << lapsedTime.GetTime().AsSeconds() << " seconds.\n";
+		m_FrameTimes.Print( std::cout, "Frame time" );
+		m_FrameCosts.Print( std::cout, "Frame cost" );
 
 
 		// Destroy the graphics
@@ -220,6 +306,336 @@ namespace Pong
 		return true;
 	}
 
+	void Client::SendMove( const eDirection p_Direction )
+	{
+		Bit::Uint32 offset = 0;
+		const Bit::Uint32 tick = ServerTickNow( offset );
+
+		Packet move;
+		move.WriteByte( static_cast<Bit::Uint8>( p_Direction ) );
+		move.WriteUint32( tick );
+		move.WriteUint32( offset );
+		if( SendLocal( LocalMessage::Move, move ) )
+		{
+			return;
+		}
+
+		Bit::Net::UserMessage * pMessage = CreateUserMessage( "Move" );
+		pMessage->WriteArray( move.GetData( ), move.GetSize( ) );
+		pMessage->Send( );
+		delete pMessage;
+	}
+
+	void Client::SendStopMove( )
+	{
+		Bit::Uint32 offset = 0;
+		const Bit::Uint32 tick = ServerTickNow( offset );
+
+		Packet stopMove;
+		stopMove.WriteUint32( tick );
+		stopMove.WriteUint32( offset );
+		if( SendLocal( LocalMessage::StopMove, stopMove ) )
+		{
+			return;
+		}
+
+		Bit::Net::UserMessage * pMessage = CreateUserMessage( "StopMove" );
+		pMessage->WriteArray( stopMove.GetData( ), stopMove.GetSize( ) );
+		pMessage->Send( );
+		delete pMessage;
+	}
+
+	Bit::Uint16 Client::GetUserId( )
+	{
+		return m_UserId.Get( );
+	}
+
+	Player * Client::GetPlayer( const Bit::SizeType p_Index ) const
+	{
+		return m_pPlayers[ p_Index ];
+	}
+
+	Ball * Client::GetBall( const Bit::SizeType p_Index ) const
+	{
+		return m_Balls.Get( p_Index );
+	}
+
+	Bit::SizeType Client::GetBallCount( ) const
+	{
+		return m_Balls.GetCount( );
+	}
+
+	void Client::UpdateTimeSync( )
+	{
+		const Bit::Int64 now = GetLocalTime( );
+
+		m_TimeSyncMutex.Lock( );
+		const Bit::Int64 interval = m_TimeSync.IsSynchronized( ) ? 1000000 : 100000;
+		const Bit::Bool due = m_PingSequence == 0 || now - m_LastPingTime >= interval;
+		if( due )
+		{
+			m_PingSequence++;
+			m_LastPingTime = now;
+		}
+		const Bit::Uint32 sequence = m_PingSequence;
+		m_TimeSyncMutex.Unlock( );
+
+		if( due == false )
+		{
+			return;
+		}
+
+		// Pings are unreliable, a lost ping is replaced by the next one.
+		Packet ping;
+		ping.WriteUint32( sequence );
+		ping.WriteUint64( static_cast<Bit::Uint64>( now ) );
+		if( SendLocal( LocalMessage::TimeSync, ping ) )
+		{
+			return;
+		}
+
+		Bit::Net::UserMessage * pMessage = CreateUserMessage( "TimeSync" );
+		pMessage->WriteArray( ping.GetData( ), ping.GetSize( ) );
+		pMessage->Send( false );
+		delete pMessage;
+	}
+
+	void Client::SendSnapshotAck( )
+	{
+		m_SnapshotMutex.Lock( );
+		const Bit::Bool pending = m_SnapshotAckPending;
+		const Bit::Uint32 sequence = m_SnapshotAck;
+		const Bit::Uint32 bits = m_SnapshotAckBits;
+		m_SnapshotAckPending = false;
+		m_SnapshotMutex.Unlock( );
+
+		if( pending == false )
+		{
+			return;
+		}
+
+		// Acknowledgements are unreliable, the bits repeat them in the next ones.
+		Packet ack;
+		ack.WriteUint32( sequence );
+		ack.WriteUint32( bits );
+		if( SendLocal( LocalMessage::SnapshotAck, ack ) )
+		{
+			return;
+		}
+
+		Bit::Net::UserMessage * pMessage = CreateUserMessage( "SnapshotAck" );
+		pMessage->WriteArray( ack.GetData( ), ack.GetSize( ) );
+		pMessage->Send( false );
+		delete pMessage;
+	}
+
+	Bit::Bool Client::IsTimeSynchronized( )
+	{
+		m_TimeSyncMutex.Lock( );
+		const Bit::Bool synchronized = m_TimeSync.IsSynchronized( );
+		m_TimeSyncMutex.Unlock( );
+		return synchronized;
+	}
+
+	Bit::Time Client::ServerTimeNow( )
+	{
+		const Bit::Int64 now = GetLocalTime( );
+
+		m_TimeSyncMutex.Lock( );
+		Bit::Int64 serverTime = m_TimeSync.GetServerTime( now );
+		if( serverTime < m_LastServerTime )
+		{
+			serverTime = m_LastServerTime;
+		}
+		m_LastServerTime = serverTime;
+		m_TimeSyncMutex.Unlock( );
+
+		return Bit::Microseconds( serverTime > 0 ? static_cast<Bit::Uint64>( serverTime ) : 0 );
+	}
+
+	Bit::Uint32 Client::ServerTickNow( )
+	{
+		Bit::Uint32 offset = 0;
+		return ServerTickNow( offset );
+	}
+
+	Bit::Uint32 Client::ServerTickNow( Bit::Uint32 & p_Offset )
+	{
+		const Bit::Int64 serverTime = static_cast<Bit::Int64>( ServerTimeNow( ).AsMicroseconds( ) );
+
+		m_TimeSyncMutex.Lock( );
+		Bit::Uint32 tick = m_ServerTick;
+		p_Offset = 0;
+		if( m_TickInterval > 0 && serverTime > m_ServerTickTime )
+		{
+			const Bit::Int64 elapsed = serverTime - m_ServerTickTime;
+			tick += static_cast<Bit::Uint32>( elapsed / m_TickInterval );
+			p_Offset = static_cast<Bit::Uint32>( elapsed % m_TickInterval );
+		}
+		m_TimeSyncMutex.Unlock( );
+
+		return tick;
+	}
+
+	Bit::Time Client::GetRoundTripTime( )
+	{
+		m_TimeSyncMutex.Lock( );
+		const Bit::Int64 roundTrip = m_TimeSync.GetRoundTripTime( );
+		m_TimeSyncMutex.Unlock( );
+
+		return Bit::Microseconds( static_cast<Bit::Uint64>( roundTrip ) );
+	}
+
+	Bit::Int64 Client::GetLocalTime( )
+	{
+		return static_cast<Bit::Int64>( m_Clock.GetLapsedTime( ).AsMicroseconds( ) );
+	}
+
+	const FrameHistogram & Client::GetFrameTimes( ) const
+	{
+		return m_FrameTimes;
+	}
+
+	const FrameHistogram & Client::GetFrameCosts( ) const
+	{
+		return m_FrameCosts;
+	}
+
+	void Client::ReceiveLocalMessages( )
+	{
+		if( m_pLocalTransport == NULL )
+		{
+			return;
+		}
+
+		TraceScope trace( "Local messages" );
+
+		// The batches are dispatched in place, out of the ring.
+		Bit::Uint8 type = 0;
+		Bit::SizeType size = 0;
+		const Bit::Uint8 * pData = NULL;
+		while( ( pData = m_pLocalTransport->Downstream.Read( type, size ) ) != NULL )
+		{
+			if( type == LocalMessage::Batch )
+			{
+				m_LocalBatchMessageListener.Dispatch( pData, size );
+			}
+			else if( type == LocalMessage::Snapshot )
+			{
+				m_LocalSnapshotMessageListener.HandleSnapshot( pData, size );
+			}
+
+			m_pLocalTransport->Downstream.Pop( );
+		}
+
+		// Batches or inputs are missing from a ring, join again.
+		if( m_pLocalTransport->Overflow.load( ) )
+		{
+			std::cout << "The local transport overflowed, reconnecting." << std::endl;
+			m_pLocalTransport = NULL;
+			Disconnect( );
+		}
+	}
+
+	Bit::Bool Client::SendLocal( const LocalMessage::eType p_Type, const Packet & p_Message )
+	{
+		if( m_pLocalTransport == NULL )
+		{
+			return false;
+		}
+
+		// The inputs must arrive in order, so none take the network past a full ring.
+		if( m_pLocalTransport->Overflow.load( ) == false &&
+			m_pLocalTransport->Upstream.Write( static_cast<Bit::Uint8>( p_Type ), p_Message.GetData( ), p_Message.GetSize( ) ) == false )
+		{
+			m_pLocalTransport->Overflow = true;
+		}
+		return true;
+	}
+
+	void Client::HandleEvents( )
+	{
+		Bit::Event wEvent;
+		while( m_pWindow->PollEvent( wEvent ) )
+		{
+			// Check the window envent.
+			switch( wEvent.Type )
+			{
+				// Key press events
+				case Bit::Event::KeyJustPressed:
+				{
+					if( wEvent.Key == Bit::Keyboard::W )
+					{
+						SendMove( eDirection::Up );
+					}
+					else if( wEvent.Key == Bit::Keyboard::S )
+					{
+						SendMove( eDirection::Down );
+					}
+				}
+				break;
+				case Bit::Event::KeyJustReleased:
+				{
+					if( wEvent.Key == Bit::Keyboard::W || wEvent.Key == Bit::Keyboard::S )
+					{
+						SendStopMove( );
+					}
+					else if( wEvent.Key == Bit::Keyboard::Num2 )
+					{
+						m_pWindow->Close( );
+					}
+				}
+				break;
+				case Bit::Event::Closed:
+				{
+					m_pWindow->Close( );
+				}
+				break;
+
+			default:
+				break;
+			}
+
+		}
+	}
+
+	void Client::Draw( )
+	{
+		// Headless clients transform the shapes without drawing them.
+		if( m_pWindow == NULL )
+		{
+			for( Bit::SizeType i = 0; i < 2; i++ )
+			{
+				m_HeadlessShapes[ i ].Position = m_pPlayers[ i ]->Position.Get( ) * 100.0f;
+				m_HeadlessShapes[ i ].Rotation = 0.0f;
+			}
+			for( Bit::SizeType i = 0; i + 2 < m_HeadlessShapes.size( ); i++ )
+			{
+				Ball * pBall = m_Balls.Get( i );
+				m_HeadlessShapes[ i + 2 ].Position = pBall->Position.Get( ) * 100.0f;
+				m_HeadlessShapes[ i + 2 ].Rotation = static_cast<Bit::Float32>( pBall->Rotation.Get( ) );
+			}
+			return;
+		}
+
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			m_pPlayerShapes[i]->SetPosition(m_pPlayers[i]->Position.Get() * 100.0f);
+			m_pWindow->Draw(m_pPlayerShapes[i], Bit::PrimitiveMode::LineStrip);
+		}
+		for( Bit::SizeType i = 0; i < m_BallShapes.size( ); i++ )
+		{
+			Ball * pBall = m_Balls.Get( i );
+			m_BallShapes[i]->SetPosition(pBall->Position.Get() * 100.0f);
+			m_BallShapes[i]->SetRotation(Bit::Radians(pBall->Rotation.Get()));
+			m_pWindow->Draw(m_BallShapes[i], Bit::PrimitiveMode::LineStrip);
+		}
+		for( Bit::SizeType i = 0; i < m_ObstacleShapes.size( ); i++ )
+		{
+			m_pWindow->Draw(m_ObstacleShapes[i], Bit::PrimitiveMode::LineStrip);
+		}
+	}
+
 	Bit::Bool Client::CreateGraphics( )
 	{
 		// Create the window
@@ -233,9 +649,27 @@ namespace Pong
 			m_pPlayerShapes[i]->SetSize(m_pPlayers[i]->Size.Get() * 100.0f);
 		}
 
-		m_pBallShape = m_pWindow->CreateCircleShape(30); 
-		m_pBallShape->SetPosition(m_pBall->Position.Get() * 100.0f);
-		m_pBallShape->SetSize( m_pBall->Size.Get( ) * 100.0f );
+		// Fewer segments for the small balls of the multi-ball mode.
+		const Bit::Uint32 segments = m_GameMode == GameMode::MultiBall ? 8 : 30;
+		m_BallShapes.resize( m_Balls.GetCount( ), NULL );
+		for( Bit::SizeType i = 0; i < m_BallShapes.size( ); i++ )
+		{
+			Ball * pBall = m_Balls.Get( i );
+			m_BallShapes[ i ] = m_pWindow->CreateCircleShape( segments );
+			m_BallShapes[ i ]->SetPosition( pBall->Position.Get( ) * 100.0f );
+			m_BallShapes[ i ]->SetSize( pBall->Size.Get( ) * 100.0f );
+		}
+
+		// Create the obstacle shapes, positioned by their centers like the players.
+		m_ObstacleShapes.resize( m_Obstacles.MinX.size( ), NULL );
+		for( Bit::SizeType i = 0; i < m_ObstacleShapes.size( ); i++ )
+		{
+			const Bit::Vector2f32 min( m_Obstacles.MinX[ i ], m_Obstacles.MinY[ i ] );
+			const Bit::Vector2f32 max( m_Obstacles.MaxX[ i ], m_Obstacles.MaxY[ i ] );
+			m_ObstacleShapes[ i ] = m_pWindow->CreateRectangleShape( );
+			m_ObstacleShapes[ i ]->SetPosition( ( min + max ) * 50.0f );
+			m_ObstacleShapes[ i ]->SetSize( ( max - min ) * 100.0f );
+		}
 		
 		return true;
 	}
@@ -251,7 +685,16 @@ namespace Pong
 					m_pWindow->DestroyShape( m_pPlayerShapes[ i ] );
 				}
 			}
-			m_pWindow->DestroyShape( m_pBallShape );
+			for( Bit::SizeType i = 0; i < m_BallShapes.size( ); i++ )
+			{
+				m_pWindow->DestroyShape( m_BallShapes[ i ] );
+			}
+			m_BallShapes.clear( );
+			for( Bit::SizeType i = 0; i < m_ObstacleShapes.size( ); i++ )
+			{
+				m_pWindow->DestroyShape( m_ObstacleShapes[ i ] );
+			}
+			m_ObstacleShapes.clear( );
 
 			delete m_pWindow;
 			m_pWindow = NULL;
@@ -0,0 +1,223 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <ControlSocket.hpp>
+#include <cstring>
+#if !defined( BIT_PLATFORM_WINDOWS )
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <sys/stat.h>
+	#include <poll.h>
+	#include <unistd.h>
+#endif
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Global variables
+
+	// Time a connection has to send its command.
+	static const int g_CommandTimeout = 1000;
+
+	// Control socket class
+	ControlSocket::ControlSocket( ) :
+		m_Handle( -1 ),
+		m_Connection( -1 )
+	{
+	}
+
+	ControlSocket::~ControlSocket( )
+	{
+		Close( );
+	}
+
+	Bit::Bool ControlSocket::Open( const std::string & p_Path )
+	{
+		Close( );
+
+	#if defined( BIT_PLATFORM_WINDOWS )
+		return false;
+	#else
+		sockaddr_un address;
+		std::memset( &address, 0, sizeof( address ) );
+		if( p_Path.empty( ) || p_Path.size( ) >= sizeof( address.sun_path ) )
+		{
+			return false;
+		}
+		address.sun_family = AF_UNIX;
+		std::memcpy( address.sun_path, p_Path.c_str( ), p_Path.size( ) );
+
+		const int handle = socket( AF_UNIX, SOCK_STREAM, 0 );
+		if( handle < 0 )
+		{
+			return false;
+		}
+		m_Handle = handle;
+
+		// Replace the socket of a previous process, but never another kind of file.
+		struct stat status;
+		if( lstat( p_Path.c_str( ), &status ) == 0 )
+		{
+			if( S_ISSOCK( status.st_mode ) == false )
+			{
+				Close( );
+				return false;
+			}
+			unlink( p_Path.c_str( ) );
+		}
+
+		// Only the user running the server may stop it, the socket file is created with these permissions.
+		if( fchmod( handle, S_IRUSR | S_IWUSR ) != 0 ||
+			bind( handle, reinterpret_cast<sockaddr *>( &address ), sizeof( address ) ) != 0 ||
+			listen( handle, 4 ) != 0 )
+		{
+			Close( );
+			return false;
+		}
+
+		m_Path = p_Path;
+		return true;
+	#endif
+	}
+
+	void ControlSocket::Close( )
+	{
+	#if !defined( BIT_PLATFORM_WINDOWS )
+		if( m_Connection >= 0 )
+		{
+			close( m_Connection );
+		}
+		if( m_Handle >= 0 )
+		{
+			close( m_Handle );
+		}
+		if( m_Path.empty( ) == false )
+		{
+			unlink( m_Path.c_str( ) );
+		}
+	#endif
+
+		m_Handle = -1;
+		m_Connection = -1;
+		m_Path.clear( );
+	}
+
+	Bit::Bool ControlSocket::IsOpen( ) const
+	{
+		return m_Handle >= 0;
+	}
+
+	Bit::Bool ControlSocket::Receive( std::string & p_Command, const Bit::Time & p_Timeout )
+	{
+		p_Command.clear( );
+
+	#if defined( BIT_PLATFORM_WINDOWS )
+		return false;
+	#else
+		if( m_Handle < 0 )
+		{
+			return false;
+		}
+
+		// Wait for a connection.
+		pollfd listenPoll;
+		listenPoll.fd = m_Handle;
+		listenPoll.events = POLLIN;
+		listenPoll.revents = 0;
+		if( poll( &listenPoll, 1, static_cast<int>( p_Timeout.AsMilliseconds( ) ) ) <= 0 )
+		{
+			return false;
+		}
+
+		const int connection = accept( m_Handle, NULL, NULL );
+		if( connection < 0 )
+		{
+			return false;
+		}
+
+		// Read a line, a slow or silent connection is dropped.
+		char buffer[ MaxCommandSize ];
+		Bit::SizeType size = 0;
+		while( size < MaxCommandSize && std::memchr( buffer, '\n', size ) == NULL )
+		{
+			pollfd connectionPoll;
+			connectionPoll.fd = connection;
+			connectionPoll.events = POLLIN;
+			connectionPoll.revents = 0;
+			if( poll( &connectionPoll, 1, g_CommandTimeout ) <= 0 )
+			{
+				break;
+			}
+
+			const ssize_t received = recv( connection, buffer + size, MaxCommandSize - size, 0 );
+			if( received <= 0 )
+			{
+				break;
+			}
+			size += static_cast<Bit::SizeType>( received );
+		}
+
+		// Trim the line break and the surrounding spaces.
+		const char * pEnd = static_cast<const char *>( std::memchr( buffer, '\n', size ) );
+		p_Command.assign( buffer, pEnd ? pEnd - buffer : size );
+		const std::string::size_type first = p_Command.find_first_not_of( " \t\r" );
+		const std::string::size_type last = p_Command.find_last_not_of( " \t\r" );
+		p_Command = first == std::string::npos ? std::string( ) : p_Command.substr( first, last - first + 1 );
+
+		if( p_Command.empty( ) )
+		{
+			close( connection );
+			return false;
+		}
+
+		m_Connection = connection;
+		return true;
+	#endif
+	}
+
+	void ControlSocket::Reply( const std::string & p_Reply )
+	{
+	#if !defined( BIT_PLATFORM_WINDOWS )
+		if( m_Connection < 0 )
+		{
+			return;
+		}
+
+		Bit::SizeType sent = 0;
+		while( sent < p_Reply.size( ) )
+		{
+			const ssize_t result = send( m_Connection, p_Reply.c_str( ) + sent, p_Reply.size( ) - sent, MSG_NOSIGNAL );
+			if( result <= 0 )
+			{
+				break;
+			}
+			sent += static_cast<Bit::SizeType>( result );
+		}
+
+		close( m_Connection );
+		m_Connection = -1;
+	#endif
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,427 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <DatagramSocket.hpp>
+#include <cstring>
+#include <algorithm>
+#if defined( BIT_PLATFORM_WINDOWS )
+	#include <winsock2.h>
+	typedef int SocketLength;
+#elif defined( BIT_PLATFORM_LINUX )
+	#include <sys/socket.h>
+	#include <sys/epoll.h>
+	#include <netinet/in.h>
+	#include <unistd.h>
+	#include <fcntl.h>
+	typedef socklen_t SocketLength;
+#endif
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Global functions
+	static sockaddr_in CreateAddress( const Bit::Uint32 p_Address, const Bit::Uint16 p_Port )
+	{
+		sockaddr_in address;
+		std::memset( &address, 0, sizeof( address ) );
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl( p_Address );
+		address.sin_port = htons( p_Port );
+		return address;
+	}
+
+	// Statistics structure
+	DatagramSocket::Statistics::Statistics( ) :
+		ReceiveCalls( 0 ),
+		SendCalls( 0 ),
+		ReceivedDatagrams( 0 ),
+		SentDatagrams( 0 ),
+		ReceivedBytes( 0 ),
+		SentBytes( 0 ),
+		DroppedDatagrams( 0 )
+	{
+	}
+
+	// Datagram socket class
+	DatagramSocket::DatagramSocket( ) :
+		m_Handle( -1 ),
+		m_Poll( -1 ),
+		m_Port( 0 ),
+		m_pBuffer( new Bit::Uint8[ BatchSize * 2 * MaxDatagramSize ] ),
+		m_Received( BatchSize ),
+		m_Queued( BatchSize ),
+		m_ReceivedCount( 0 ),
+		m_QueuedCount( 0 )
+	{
+		// Only the pages of the datagrams in use are ever touched.
+		for( Bit::SizeType i = 0; i < BatchSize; i++ )
+		{
+			m_Received[ i ].Data = m_pBuffer + i * MaxDatagramSize;
+			m_Queued[ i ].Data = m_pBuffer + ( BatchSize + i ) * MaxDatagramSize;
+		}
+	}
+
+	DatagramSocket::~DatagramSocket( )
+	{
+		Close( );
+		delete [ ] m_pBuffer;
+	}
+
+	Bit::Bool DatagramSocket::Open( const Bit::Uint16 p_Port, const Bit::Uint32 p_Address )
+	{
+		Close( );
+
+	#if defined( BIT_PLATFORM_WINDOWS )
+		WSADATA wsaData;
+		if( WSAStartup( MAKEWORD( 2, 2 ), &wsaData ) != 0 )
+		{
+			return false;
+		}
+	#endif
+
+		// Create the socket
+	#if defined( BIT_PLATFORM_WINDOWS )
+		SOCKET handle = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+		if( handle == INVALID_SOCKET )
+		{
+			return false;
+		}
+	#else
+		int handle = socket( AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP );
+		if( handle < 0 )
+		{
+			return false;
+		}
+	#endif
+		m_Handle = static_cast<Bit::Int64>( handle );
+
+		// Bind the socket
+		sockaddr_in address = CreateAddress( p_Address, p_Port );
+		if( bind( handle, reinterpret_cast<sockaddr *>( &address ), sizeof( address ) ) != 0 )
+		{
+			Close( );
+			return false;
+		}
+
+		// Get the bound port, the system picks one if the port is 0.
+		SocketLength addressLength = sizeof( address );
+		if( getsockname( handle, reinterpret_cast<sockaddr *>( &address ), &addressLength ) != 0 )
+		{
+			Close( );
+			return false;
+		}
+		m_Port = ntohs( address.sin_port );
+
+	#if defined( BIT_PLATFORM_WINDOWS )
+		// Set non blocking mode
+		u_long nonBlocking = 1;
+		ioctlsocket( handle, FIONBIO, &nonBlocking );
+	#else
+		// Create the epoll instance
+		m_Poll = epoll_create1( 0 );
+		if( m_Poll < 0 )
+		{
+			Close( );
+			return false;
+		}
+
+		epoll_event pollEvent;
+		std::memset( &pollEvent, 0, sizeof( pollEvent ) );
+		pollEvent.events = EPOLLIN;
+		pollEvent.data.fd = handle;
+		if( epoll_ctl( m_Poll, EPOLL_CTL_ADD, handle, &pollEvent ) != 0 )
+		{
+			Close( );
+			return false;
+		}
+	#endif
+
+		return true;
+	}
+
+	void DatagramSocket::Close( )
+	{
+		if( m_Handle == -1 )
+		{
+			return;
+		}
+
+	#if defined( BIT_PLATFORM_WINDOWS )
+		closesocket( static_cast<SOCKET>( m_Handle ) );
+		WSACleanup( );
+	#else
+		if( m_Poll >= 0 )
+		{
+			close( m_Poll );
+			m_Poll = -1;
+		}
+		close( static_cast<int>( m_Handle ) );
+	#endif
+
+		m_Handle = -1;
+		m_Port = 0;
+		m_ReceivedCount = 0;
+		m_QueuedCount = 0;
+	}
+
+	Bit::Bool DatagramSocket::IsOpen( ) const
+	{
+		return m_Handle != -1;
+	}
+
+	Bit::Uint16 DatagramSocket::GetPort( ) const
+	{
+		return m_Port;
+	}
+
+	Bit::Bool DatagramSocket::Wait( const Bit::Time & p_Timeout )
+	{
+		if( m_Handle == -1 )
+		{
+			return false;
+		}
+
+	#if defined( BIT_PLATFORM_WINDOWS )
+		SOCKET handle = static_cast<SOCKET>( m_Handle );
+		fd_set readSet;
+		FD_ZERO( &readSet );
+		FD_SET( handle, &readSet );
+
+		timeval timeout;
+		timeout.tv_sec = static_cast<long>( p_Timeout.AsMicroseconds( ) / 1000000 );
+		timeout.tv_usec = static_cast<long>( p_Timeout.AsMicroseconds( ) % 1000000 );
+
+		return select( 0, &readSet, NULL, NULL, &timeout ) > 0;
+	#else
+		epoll_event pollEvent;
+		const int timeout = static_cast<int>( ( p_Timeout.AsMicroseconds( ) + 999 ) / 1000 );
+		return epoll_wait( m_Poll, &pollEvent, 1, timeout ) > 0;
+	#endif
+	}
+
+	Bit::SizeType DatagramSocket::Receive( )
+	{
+		m_ReceivedCount = 0;
+
+		if( m_Handle == -1 )
+		{
+			return 0;
+		}
+
+	#if defined( BIT_PLATFORM_LINUX )
+		// Receive the whole batch with a single system call.
+		mmsghdr messages[ BatchSize ];
+		iovec buffers[ BatchSize ];
+		sockaddr_in addresses[ BatchSize ];
+		std::memset( messages, 0, sizeof( messages ) );
+
+		for( Bit::SizeType i = 0; i < BatchSize; i++ )
+		{
+			buffers[ i ].iov_base = m_Received[ i ].Data;
+			buffers[ i ].iov_len = MaxDatagramSize;
+			messages[ i ].msg_hdr.msg_iov = &buffers[ i ];
+			messages[ i ].msg_hdr.msg_iovlen = 1;
+			messages[ i ].msg_hdr.msg_name = &addresses[ i ];
+			messages[ i ].msg_hdr.msg_namelen = sizeof( addresses[ i ] );
+		}
+
+		m_Statistics.ReceiveCalls++;
+		const int count = recvmmsg( static_cast<int>( m_Handle ), messages, BatchSize, MSG_DONTWAIT, NULL );
+		if( count <= 0 )
+		{
+			return 0;
+		}
+
+		for( int i = 0; i < count; i++ )
+		{
+			// Drop the truncated datagrams, never hand out a part of one.
+			if( messages[ i ].msg_hdr.msg_flags & MSG_TRUNC )
+			{
+				m_Statistics.DroppedDatagrams++;
+				continue;
+			}
+
+			// Keep the received datagrams in front, the data buffers are swapped.
+			if( m_ReceivedCount != static_cast<Bit::SizeType>( i ) )
+			{
+				std::swap( m_Received[ m_ReceivedCount ].Data, m_Received[ i ].Data );
+			}
+
+			Datagram & datagram = m_Received[ m_ReceivedCount++ ];
+			datagram.Address = ntohl( addresses[ i ].sin_addr.s_addr );
+			datagram.Port = ntohs( addresses[ i ].sin_port );
+			datagram.Size = messages[ i ].msg_len;
+			m_Statistics.ReceivedBytes += datagram.Size;
+		}
+	#else
+		// Receive one datagram per system call until the socket is drained.
+		while( m_ReceivedCount < BatchSize )
+		{
+			Datagram & datagram = m_Received[ m_ReceivedCount ];
+			sockaddr_in address;
+			SocketLength addressLength = sizeof( address );
+
+			m_Statistics.ReceiveCalls++;
+			const int size = recvfrom(	static_cast<SOCKET>( m_Handle ), reinterpret_cast<char *>( datagram.Data ),
+										static_cast<int>( MaxDatagramSize ), 0,
+										reinterpret_cast<sockaddr *>( &address ), &addressLength );
+			if( size < 0 )
+			{
+				// Drop the truncated datagrams, never hand out a part of one.
+			#if defined( BIT_PLATFORM_WINDOWS )
+				if( WSAGetLastError( ) == WSAEMSGSIZE )
+				{
+					m_Statistics.DroppedDatagrams++;
+					continue;
+				}
+			#endif
+				break;
+			}
+
+			datagram.Address = ntohl( address.sin_addr.s_addr );
+			datagram.Port = ntohs( address.sin_port );
+			datagram.Size = static_cast<Bit::SizeType>( size );
+			m_Statistics.ReceivedBytes += datagram.Size;
+			m_ReceivedCount++;
+		}
+	#endif
+
+		m_Statistics.ReceivedDatagrams += m_ReceivedCount;
+		return m_ReceivedCount;
+	}
+
+	const DatagramSocket::Datagram & DatagramSocket::GetReceived( const Bit::SizeType p_Index ) const
+	{
+		return m_Received[ p_Index ];
+	}
+
+	Bit::Bool DatagramSocket::Queue(	const Bit::Uint32 p_Address, const Bit::Uint16 p_Port,
+										const void * p_pData, const Bit::SizeType p_Size )
+	{
+		if( p_Size > MaxDatagramSize )
+		{
+			return false;
+		}
+
+		if( m_QueuedCount == BatchSize )
+		{
+			Flush( );
+		}
+
+		Datagram & datagram = m_Queued[ m_QueuedCount++ ];
+		datagram.Address = p_Address;
+		datagram.Port = p_Port;
+		datagram.Size = p_Size;
+		if( p_Size > 0 )
+		{
+			std::memcpy( datagram.Data, p_pData, p_Size );
+		}
+		return true;
+	}
+
+	Bit::SizeType DatagramSocket::Flush( )
+	{
+		if( m_Handle == -1 || m_QueuedCount == 0 )
+		{
+			m_QueuedCount = 0;
+			return 0;
+		}
+
+		const Bit::Uint64 sentDatagrams = m_Statistics.SentDatagrams;
+		Bit::SizeType sent = 0;
+
+	#if defined( BIT_PLATFORM_LINUX )
+		// Send the whole queue with as few system calls as possible.
+		mmsghdr messages[ BatchSize ];
+		iovec buffers[ BatchSize ];
+		sockaddr_in addresses[ BatchSize ];
+		std::memset( messages, 0, sizeof( messages ) );
+
+		for( Bit::SizeType i = 0; i < m_QueuedCount; i++ )
+		{
+			addresses[ i ] = CreateAddress( m_Queued[ i ].Address, m_Queued[ i ].Port );
+			buffers[ i ].iov_base = m_Queued[ i ].Data;
+			buffers[ i ].iov_len = m_Queued[ i ].Size;
+			messages[ i ].msg_hdr.msg_iov = &buffers[ i ];
+			messages[ i ].msg_hdr.msg_iovlen = 1;
+			messages[ i ].msg_hdr.msg_name = &addresses[ i ];
+			messages[ i ].msg_hdr.msg_namelen = sizeof( addresses[ i ] );
+		}
+
+		while( sent < m_QueuedCount )
+		{
+			m_Statistics.SendCalls++;
+			const int count = sendmmsg(	static_cast<int>( m_Handle ), messages + sent,
+										static_cast<unsigned int>( m_QueuedCount - sent ), MSG_DONTWAIT );
+
+			// Drop the datagram that failed, the rest is retried.
+			if( count <= 0 )
+			{
+				m_Statistics.DroppedDatagrams++;
+				sent++;
+				continue;
+			}
+
+			for( int i = 0; i < count; i++ )
+			{
+				m_Statistics.SentBytes += m_Queued[ sent + i ].Size;
+			}
+			m_Statistics.SentDatagrams += count;
+			sent += static_cast<Bit::SizeType>( count );
+		}
+	#else
+		for( ; sent < m_QueuedCount; sent++ )
+		{
+			const Datagram & datagram = m_Queued[ sent ];
+			sockaddr_in address = CreateAddress( datagram.Address, datagram.Port );
+
+			m_Statistics.SendCalls++;
+			if( sendto(	static_cast<SOCKET>( m_Handle ), reinterpret_cast<const char *>( datagram.Data ),
+						static_cast<int>( datagram.Size ), 0,
+						reinterpret_cast<sockaddr *>( &address ), sizeof( address ) ) < 0 )
+			{
+				m_Statistics.DroppedDatagrams++;
+				continue;
+			}
+
+			m_Statistics.SentBytes += datagram.Size;
+			m_Statistics.SentDatagrams++;
+		}
+	#endif
+
+		m_QueuedCount = 0;
+		return static_cast<Bit::SizeType>( m_Statistics.SentDatagrams - sentDatagrams );
+	}
+
+	Bit::SizeType DatagramSocket::GetQueuedCount( ) const
+	{
+		return m_QueuedCount;
+	}
+
+	const DatagramSocket::Statistics & DatagramSocket::GetStatistics( ) const
+	{
+		return m_Statistics;
+	}
+
+}
\ No newline at end of file
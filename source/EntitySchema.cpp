@@ -0,0 +1,184 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <EntitySchema.hpp>
+#include <sstream>
+#include <iomanip>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Fowler-Noll-Vo hash of everything that has to match between the client and the server.
+	class SchemaHasher
+	{
+
+	public:
+
+		SchemaHasher( ) :
+			m_Hash( 2166136261U )
+		{
+		}
+
+		template<typename T, typename V>
+		void operator( )( const char * p_pName, Bit::Net::Variable<V> T::* )
+		{
+			Add( p_pName );
+			Add( static_cast<Bit::Uint32>( sizeof( V ) ) );
+		}
+
+		template<typename T>
+		void AddEntity( )
+		{
+			Add( EntitySchema<T>::GetName( ) );
+			EntitySchema<T>::Visit( *this );
+		}
+
+		template<typename Field>
+		void AddField( )
+		{
+			Add( static_cast<Bit::Uint32>( Field::Begin ) );
+			Add( static_cast<Bit::Uint32>( Field::End ) );
+		}
+
+		void Add( const char * p_pString )
+		{
+			for( const char * pChar = p_pString; *pChar; pChar++ )
+			{
+				AddByte( static_cast<Bit::Uint8>( *pChar ) );
+			}
+			AddByte( 0 );
+		}
+
+		void Add( const Bit::Uint32 p_Value )
+		{
+			for( Bit::SizeType i = 0; i < 4; i++ )
+			{
+				AddByte( static_cast<Bit::Uint8>( p_Value >> ( i * 8 ) ) );
+			}
+		}
+
+		Bit::Uint32 GetHash( ) const
+		{
+			return m_Hash;
+		}
+
+	private:
+
+		void AddByte( const Bit::Uint8 p_Byte )
+		{
+			m_Hash = ( m_Hash ^ p_Byte ) * 16777619U;
+		}
+
+		Bit::Uint32 m_Hash;
+
+	};
+
+	// Registers the variables of a single entity class.
+	template<typename T>
+	class SchemaRegistrar
+	{
+
+	public:
+
+		SchemaRegistrar( Bit::Net::EntityManager & p_EntityManager ) :
+			m_EntityManager( p_EntityManager )
+		{
+		}
+
+		template<typename V>
+		void operator( )( const char * p_pName, Bit::Net::Variable<V> T::* p_pVariable )
+		{
+			m_EntityManager.RegisterVariable( EntitySchema<T>::GetName( ), p_pName, p_pVariable );
+		}
+
+		void Register( )
+		{
+			m_EntityManager.LinkEntity<T>( EntitySchema<T>::GetName( ) );
+			EntitySchema<T>::Visit( *this );
+		}
+
+	private:
+
+		Bit::Net::EntityManager & m_EntityManager;
+
+	};
+
+	static Bit::Uint32 CalculateHash( )
+	{
+		SchemaHasher hasher;
+
+		hasher.AddEntity<Ball>( );
+		hasher.AddEntity<Player>( );
+
+		hasher.Add( "Snapshot" );
+		hasher.AddField<SnapshotSchema::Header::Sequence>( );
+		hasher.AddField<SnapshotSchema::Header::Tick>( );
+		hasher.AddField<SnapshotSchema::Header::Level>( );
+		hasher.AddField<SnapshotSchema::Header::FirstBall>( );
+		hasher.AddField<SnapshotSchema::Header::BallCount>( );
+		hasher.AddField<SnapshotSchema::Header::TotalBallCount>( );
+		hasher.AddField<SnapshotSchema::Player::PositionX>( );
+		hasher.AddField<SnapshotSchema::Player::PositionY>( );
+		hasher.AddField<SnapshotSchema::Ball::PositionX>( );
+		hasher.AddField<SnapshotSchema::Ball::PositionY>( );
+		hasher.AddField<SnapshotSchema::Ball::Rotation>( );
+		hasher.AddField<SnapshotSchema::QuantizedBall::PositionX>( );
+		hasher.AddField<SnapshotSchema::QuantizedBall::PositionY>( );
+
+		return hasher.GetHash( );
+	}
+
+	static std::string CreateIdentifier( const Bit::Uint32 p_Hash )
+	{
+		std::ostringstream identifier;
+		identifier << "NetPong-" << std::hex << std::uppercase << std::setw( 8 ) << std::setfill( '0' ) << p_Hash;
+		return identifier.str( );
+	}
+
+	// Calculated before main, GetHash and GetIdentifier are safe to call from any thread.
+	static const Bit::Uint32 g_SchemaHash = CalculateHash( );
+	static const std::string g_SchemaIdentifier = CreateIdentifier( g_SchemaHash );
+
+	namespace Schema
+	{
+
+		void Register( Bit::Net::EntityManager & p_EntityManager )
+		{
+			SchemaRegistrar<Ball>( p_EntityManager ).Register( );
+			SchemaRegistrar<Player>( p_EntityManager ).Register( );
+		}
+
+		Bit::Uint32 GetHash( )
+		{
+			return g_SchemaHash;
+		}
+
+		const std::string & GetIdentifier( )
+		{
+			return g_SchemaIdentifier;
+		}
+
+	}
+
+}
\ No newline at end of file
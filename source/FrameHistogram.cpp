@@ -0,0 +1,152 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <FrameHistogram.hpp>
+#include <iomanip>
+#include <string>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Width of the printed rows, in buckets.
+	static const Bit::SizeType g_RowBuckets = 10;
+
+	// Width of the printed bars, in characters.
+	static const Bit::Uint64 g_BarWidth = 50;
+
+	FrameHistogram::FrameHistogram( )
+	{
+		Reset( );
+	}
+
+	void FrameHistogram::Add( const Bit::Time & p_Time )
+	{
+		const Bit::Uint64 time = static_cast<Bit::Uint64>( p_Time.AsMicroseconds( ) );
+		const Bit::Uint64 bucket = time / BucketWidth;
+		m_Buckets[ bucket < BucketCount ? bucket : BucketCount - 1 ]++;
+		m_Count++;
+		m_Total += time;
+		m_Max = time > m_Max ? time : m_Max;
+	}
+
+	void FrameHistogram::Reset( )
+	{
+		for( Bit::SizeType i = 0; i < BucketCount; i++ )
+		{
+			m_Buckets[ i ] = 0;
+		}
+		m_Count = 0;
+		m_Total = 0;
+		m_Max = 0;
+	}
+
+	Bit::Uint64 FrameHistogram::GetCount( ) const
+	{
+		return m_Count;
+	}
+
+	Bit::Time FrameHistogram::GetMean( ) const
+	{
+		return Bit::Microseconds( m_Count ? m_Total / m_Count : 0 );
+	}
+
+	Bit::Time FrameHistogram::GetMax( ) const
+	{
+		return Bit::Microseconds( m_Max );
+	}
+
+	Bit::Time FrameHistogram::GetPercentile( const Bit::Float64 p_Percentile ) const
+	{
+		if( m_Count == 0 )
+		{
+			return Bit::Time::Zero;
+		}
+
+		// Rank of the frame at the percentile, counted from 1.
+		Bit::Uint64 rank = static_cast<Bit::Uint64>( p_Percentile / 100.0 * static_cast<Bit::Float64>( m_Count ) + 0.5 );
+		rank = rank < 1 ? 1 : ( rank > m_Count ? m_Count : rank );
+
+		Bit::Uint64 count = 0;
+		for( Bit::SizeType i = 0; i < BucketCount; i++ )
+		{
+			count += m_Buckets[ i ];
+			if( count >= rank )
+			{
+				// The last bucket is open ended, the longest frame is its edge.
+				const Bit::Uint64 edge = i + 1 < BucketCount ? ( i + 1 ) * BucketWidth : m_Max;
+				return Bit::Microseconds( edge < m_Max ? edge : m_Max );
+			}
+		}
+
+		return Bit::Microseconds( m_Max );
+	}
+
+	void FrameHistogram::Print( std::ostream & p_Stream, const char * p_pName ) const
+	{
+		p_Stream << std::fixed << std::setprecision( 2 );
+		p_Stream	<< p_pName << ": " << m_Count << " frames"
+					<< ", mean " << GetMean( ).AsMilliseconds( ) << " ms"
+					<< ", p50 " << GetPercentile( 50.0 ).AsMilliseconds( ) << " ms"
+					<< ", p90 " << GetPercentile( 90.0 ).AsMilliseconds( ) << " ms"
+					<< ", p99 " << GetPercentile( 99.0 ).AsMilliseconds( ) << " ms"
+					<< ", p99.9 " << GetPercentile( 99.9 ).AsMilliseconds( ) << " ms"
+					<< ", max " << GetMax( ).AsMilliseconds( ) << " ms" << std::endl;
+
+		if( m_Count == 0 )
+		{
+			return;
+		}
+
+		// Sum the buckets into 1 ms rows, the bars are relative to the fullest row.
+		Bit::Uint64 fullest = 0;
+		for( Bit::SizeType row = 0; row < BucketCount; row += g_RowBuckets )
+		{
+			Bit::Uint64 count = 0;
+			for( Bit::SizeType i = row; i < row + g_RowBuckets; i++ )
+			{
+				count += m_Buckets[ i ];
+			}
+			fullest = count > fullest ? count : fullest;
+		}
+
+		for( Bit::SizeType row = 0; row < BucketCount; row += g_RowBuckets )
+		{
+			Bit::Uint64 count = 0;
+			for( Bit::SizeType i = row; i < row + g_RowBuckets; i++ )
+			{
+				count += m_Buckets[ i ];
+			}
+			if( count == 0 )
+			{
+				continue;
+			}
+
+			const Bit::Uint64 millisecond = row * BucketWidth / 1000;
+			const Bit::Uint64 bar = ( count * g_BarWidth + fullest - 1 ) / fullest;
+			p_Stream	<< std::setw( 5 ) << millisecond << ( row + g_RowBuckets < BucketCount ? "  ms " : "+ ms " )
+						<< std::setw( 8 ) << count << " " << std::string( static_cast<std::string::size_type>( bar ), '#' ) << std::endl;
+		}
+	}
+
+}
\ No newline at end of file
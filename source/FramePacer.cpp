@@ -0,0 +1,106 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <FramePacer.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <thread>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	FramePacer::FramePacer( const Bit::Uint32 p_FrameRate ) :
+		m_FrameRate( 0 ),
+		m_Period( 0 ),
+		m_Deadline( 0 ),
+		m_LastFrame( 0 ),
+		m_FrameTime( 0 ),
+		m_Oversleep( 1000 )
+	{
+		m_Clock.Start( );
+		SetFrameRate( p_FrameRate );
+	}
+
+	void FramePacer::SetFrameRate( const Bit::Uint32 p_FrameRate )
+	{
+		m_FrameRate = p_FrameRate;
+		m_Period = p_FrameRate > 0 ? 1000000 / p_FrameRate : 0;
+		m_Deadline = 0;
+	}
+
+	Bit::Uint32 FramePacer::GetFrameRate( ) const
+	{
+		return m_FrameRate;
+	}
+
+	void FramePacer::Wait( )
+	{
+		Bit::Uint64 now = GetTime( );
+
+		if( m_Period > 0 )
+		{
+			// Start a new grid on the first frame, or if a frame was missed.
+			if( m_Deadline == 0 || now > m_Deadline + m_Period )
+			{
+				m_Deadline = now + m_Period;
+			}
+
+			// Sleep the bulk of the wait, keep a margin for the oversleep.
+			Bit::Uint64 spinTime = m_Oversleep * 2;
+			spinTime = spinTime < MinSpinTime ? MinSpinTime : ( spinTime > MaxSpinTime ? MaxSpinTime : spinTime );
+			if( now + spinTime < m_Deadline )
+			{
+				const Bit::Uint64 sleepTime = m_Deadline - now - spinTime;
+				Bit::Sleep( Bit::Microseconds( sleepTime ) );
+
+				const Bit::Uint64 slept = GetTime( ) - now;
+				const Bit::Uint64 oversleep = slept > sleepTime ? slept - sleepTime : 0;
+				m_Oversleep = ( m_Oversleep * 7 + oversleep ) / 8;
+			}
+
+			// Spin the rest.
+			now = GetTime( );
+			while( now < m_Deadline )
+			{
+				std::this_thread::yield( );
+				now = GetTime( );
+			}
+
+			m_Deadline += m_Period;
+		}
+
+		m_FrameTime = m_LastFrame > 0 ? now - m_LastFrame : 0;
+		m_LastFrame = now;
+	}
+
+	Bit::Time FramePacer::GetFrameTime( ) const
+	{
+		return Bit::Microseconds( m_FrameTime );
+	}
+
+	Bit::Uint64 FramePacer::GetTime( )
+	{
+		return static_cast<Bit::Uint64>( m_Clock.GetLapsedTime( ).AsMicroseconds( ) );
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,271 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <JobScheduler.hpp>
+#include <Trace.hpp>
+#include <thread>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	JobScheduler::JobScheduler( ) :
+		m_Running( false ),
+		m_Pending( 0 ),
+		m_StealCount( 0 ),
+		m_WorkerAllocations( 0 ),
+		m_WorkerFrees( 0 ),
+		m_WorkerBytes( 0 ),
+		m_Function( NULL ),
+		m_pContext( NULL )
+	{
+	}
+
+	JobScheduler::~JobScheduler( )
+	{
+		Stop( );
+	}
+
+	void JobScheduler::Start( const Bit::SizeType p_ThreadCount )
+	{
+		Stop( );
+
+		Bit::SizeType threadCount = p_ThreadCount;
+		if( threadCount == 0 )
+		{
+			threadCount = static_cast<Bit::SizeType>( std::thread::hardware_concurrency( ) );
+		}
+		if( threadCount == 0 )
+		{
+			threadCount = 1;
+		}
+
+		for( Bit::SizeType i = 0; i < threadCount; i++ )
+		{
+			Queue * pQueue = new Queue;
+			pQueue->Front = 0;
+			pQueue->Back = 0;
+			m_Queues.push_back( pQueue );
+		}
+
+		m_Running = true;
+
+		// The calling thread owns queue 0, worker i owns queue i + 1.
+		for( Bit::SizeType i = 1; i < threadCount; i++ )
+		{
+			Worker * pWorker = new Worker;
+			m_Workers.push_back( pWorker );
+			pWorker->Thread.Execute( [ this, pWorker, i ] ( )
+			{
+				WorkerLoop( pWorker, i );
+			} );
+		}
+	}
+
+	void JobScheduler::Stop( )
+	{
+		m_Running = false;
+
+		for( std::vector<Worker *>::iterator it = m_Workers.begin( ); it != m_Workers.end( ); it++ )
+		{
+			( *it )->Wake.Release( );
+		}
+		for( std::vector<Worker *>::iterator it = m_Workers.begin( ); it != m_Workers.end( ); it++ )
+		{
+			( *it )->Thread.Finish( );
+			delete *it;
+		}
+		m_Workers.clear( );
+
+		for( std::vector<Queue *>::iterator it = m_Queues.begin( ); it != m_Queues.end( ); it++ )
+		{
+			delete *it;
+		}
+		m_Queues.clear( );
+	}
+
+	Bit::SizeType JobScheduler::GetThreadCount( ) const
+	{
+		return m_Queues.size( ) ? m_Queues.size( ) : 1;
+	}
+
+	void JobScheduler::ParallelFor( const Bit::SizeType p_JobCount, JobFunction p_Function, void * p_pContext )
+	{
+		if( p_JobCount == 0 )
+		{
+			return;
+		}
+
+		// Run on the calling thread if there are no workers.
+		if( m_Workers.size( ) == 0 || p_JobCount == 1 )
+		{
+			for( Bit::SizeType i = 0; i < p_JobCount; i++ )
+			{
+				p_Function( p_pContext, i );
+			}
+			return;
+		}
+
+		m_Function = p_Function;
+		m_pContext = p_pContext;
+		m_Pending = p_JobCount;
+
+		// Deal the jobs out round robin, so every queue gets a mixed share.
+		const Bit::SizeType queueCount = m_Queues.size( );
+		for( Bit::SizeType q = 0; q < queueCount; q++ )
+		{
+			Queue * pQueue = m_Queues[ q ];
+			pQueue->Mutex.Lock( );
+			pQueue->Jobs.clear( );
+			for( Bit::SizeType i = q; i < p_JobCount; i += queueCount )
+			{
+				pQueue->Jobs.push_back( i );
+			}
+			pQueue->Front = 0;
+			pQueue->Back = pQueue->Jobs.size( );
+			pQueue->Mutex.Unlock( );
+		}
+
+		for( std::vector<Worker *>::iterator it = m_Workers.begin( ); it != m_Workers.end( ); it++ )
+		{
+			( *it )->Wake.Release( );
+		}
+
+		RunJobs( 0 );
+
+		// Barrier, wait for the jobs still running on other threads.
+		while( m_Pending.load( ) != 0 )
+		{
+			std::this_thread::yield( );
+		}
+	}
+
+	Bit::Uint64 JobScheduler::GetStealCount( ) const
+	{
+		return m_StealCount.load( );
+	}
+
+	AllocationCounters JobScheduler::GetWorkerAllocations( ) const
+	{
+		AllocationCounters counters;
+		counters.Allocations = m_WorkerAllocations.load( );
+		counters.Frees = m_WorkerFrees.load( );
+		counters.Bytes = m_WorkerBytes.load( );
+		return counters;
+	}
+
+	void JobScheduler::WorkerLoop( Worker * p_pWorker, const Bit::SizeType p_Queue )
+	{
+		// Name the thread up front, so its trace buffer is not allocated by a job.
+		Trace::SetThreadName( "Worker" );
+
+		while( true )
+		{
+			p_pWorker->Wake.Wait( );
+			if( m_Running == false )
+			{
+				return;
+			}
+
+			RunJobs( p_Queue );
+		}
+	}
+
+	Bit::Bool JobScheduler::RunJobs( const Bit::SizeType p_Queue )
+	{
+		Bit::Bool ranJob = false;
+		Bit::SizeType job = 0;
+
+		while( PopJob( p_Queue, job ) || StealJob( p_Queue, job ) )
+		{
+			const AllocationCounters start = AllocationTracker::GetThreadCounters( );
+			{
+				TraceScope trace( "Job" );
+				m_Function( m_pContext, job );
+			}
+
+			// Count the allocations of the workers before the job is done, so they belong to this run.
+			if( p_Queue != 0 )
+			{
+				const AllocationCounters counters = AllocationTracker::GetThreadCounters( ) - start;
+				if( counters.Allocations || counters.Frees )
+				{
+					m_WorkerAllocations += counters.Allocations;
+					m_WorkerFrees += counters.Frees;
+					m_WorkerBytes += counters.Bytes;
+				}
+			}
+
+			m_Pending--;
+			ranJob = true;
+		}
+
+		return ranJob;
+	}
+
+	Bit::Bool JobScheduler::PopJob( const Bit::SizeType p_Queue, Bit::SizeType & p_Job )
+	{
+		Queue * pQueue = m_Queues[ p_Queue ];
+		Bit::Bool found = false;
+
+		pQueue->Mutex.Lock( );
+		if( pQueue->Back > pQueue->Front )
+		{
+			pQueue->Back--;
+			p_Job = pQueue->Jobs[ pQueue->Back ];
+			found = true;
+		}
+		pQueue->Mutex.Unlock( );
+
+		return found;
+	}
+
+	Bit::Bool JobScheduler::StealJob( const Bit::SizeType p_Queue, Bit::SizeType & p_Job )
+	{
+		const Bit::SizeType queueCount = m_Queues.size( );
+
+		for( Bit::SizeType i = 1; i < queueCount; i++ )
+		{
+			Queue * pQueue = m_Queues[ ( p_Queue + i ) % queueCount ];
+			Bit::Bool found = false;
+
+			pQueue->Mutex.Lock( );
+			if( pQueue->Back > pQueue->Front )
+			{
+				p_Job = pQueue->Jobs[ pQueue->Front ];
+				pQueue->Front++;
+				found = true;
+			}
+			pQueue->Mutex.Unlock( );
+
+			if( found )
+			{
+				m_StealCount++;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+}
\ No newline at end of file
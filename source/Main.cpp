@@ -22,13 +22,19 @@
 // ///////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
+#include <string>
+#include <cstdio>
 #include <Client.hpp>
 #include <Server.hpp>
+#include <RollbackClient.hpp>
+#include <MatchBatch.hpp>
+#include <Trace.hpp>
 #include <Bit/Network/Net/Client.hpp>
 #include <Bit/System/MemoryLeak.hpp>
 
 // Global variables
 static Pong::Server *		g_pServer	= NULL;
+static Bit::Bool			g_Headless	= false;
 
 // Global functions
 static int CloseApplication( );
@@ -43,15 +49,168 @@ int main( int argc, char ** argv )
 	const Bit::Address	address	= Bit::Address::Localhost;
 	const Bit::Uint16	port		= 1338;
 	const Bit::Time		timeout	= Bit::Seconds( 2.0f );
+	Pong::ServerSettings settings;
+	Pong::ClientSettings clientSettings;
+	std::string tracePath;
+	Bit::Bool fixedPhysics = false;
+	Bit::Bool rollback = false;
+	Bit::SizeType rollbackPlayer = 0;
+	Bit::Uint16 rollbackPort = 0;
+	Bit::Uint32 peerAddress = 0;
+	Bit::Uint16 peerPort = 0;
+	Bit::SizeType checkMatches = 0;
+	Bit::Uint32 checkTicks = 0;
 
-	// Try to connect to the server
-	Pong::Client client;
-	if( client.Join( g_pServer, address, port, timeout ) == false )
+	// Read the arguments
+	for( int i = 1; i < argc; i++ )
 	{
-		std::cout << "Failed to connect to server." << std::endl;
+		const std::string argument = argv[ i ];
+
+		if( argument == "-multiball" )
+		{
+			settings.Mode = Pong::GameMode::MultiBall;
+		}
+		else if( argument == "-balls" && i + 1 < argc )
+		{
+			settings.BallCount = static_cast<Bit::Uint16>( std::stoul( argv[ ++i ] ) );
+		}
+		else if( argument == "-obstacles" && i + 1 < argc )
+		{
+			settings.ObstacleCount = static_cast<Bit::Uint16>( std::stoul( argv[ ++i ] ) );
+		}
+		else if( argument == "-matches" && i + 1 < argc )
+		{
+			settings.MatchCount = static_cast<Bit::SizeType>( std::stoul( argv[ ++i ] ) );
+		}
+		else if( argument == "-workers" && i + 1 < argc )
+		{
+			settings.WorkerCount = static_cast<Bit::SizeType>( std::stoul( argv[ ++i ] ) );
+		}
+		else if( argument == "-allocations" && i + 1 < argc )
+		{
+			// Off, report or assert on allocating steady state ticks.
+			const std::string check = argv[ ++i ];
+			settings.AllocationCheck =	check == "assert" ? Pong::AllocationReport::Assert :
+										check == "report" ? Pong::AllocationReport::Report : Pong::AllocationReport::Off;
+		}
+		else if( argument == "-fps" && i + 1 < argc )
+		{
+			// Frames per second, 0 for unlimited.
+			clientSettings.FrameRate = static_cast<Bit::Uint32>( std::stoul( argv[ ++i ] ) );
+		}
+		else if( argument == "-headless" )
+		{
+			clientSettings.Headless = true;
+			g_Headless = true;
+		}
+		else if( argument == "-frames" && i + 1 < argc )
+		{
+			clientSettings.FrameCount = static_cast<Bit::Uint64>( std::stoull( argv[ ++i ] ) );
+		}
+		else if( argument == "-trace" && i + 1 < argc )
+		{
+			// Record a timeline of the ticks and frames, written at exit.
+			tracePath = argv[ ++i ];
+			Pong::Trace::Enable( true );
+		}
+		else if( argument == "-checkpoint" && i + 1 < argc )
+		{
+			settings.CheckpointPath = argv[ ++i ];
+		}
+		else if( argument == "-checkpointinterval" && i + 1 < argc )
+		{
+			settings.CheckpointInterval = static_cast<Bit::Uint32>( std::stoul( argv[ ++i ] ) );
+		}
+		else if( argument == "-bots" )
+		{
+			// Fill the matches with server side players.
+			settings.Bots = true;
+		}
+		else if( argument == "-substeps" && i + 1 < argc )
+		{
+			// Physics substeps per tick while the ticks fit the budget.
+			settings.MaxPhysicsQuality.Substeps = static_cast<Bit::Uint32>( std::stoul( argv[ ++i ] ) );
+		}
+		else if( argument == "-fixedphysics" )
+		{
+			// Never lower the physics quality under load.
+			fixedPhysics = true;
+		}
+		else if( argument == "-control" && i + 1 < argc )
+		{
+			// Unix domain socket for stop, drain, stats and matches commands.
+			settings.ControlPath = argv[ ++i ];
+		}
+		else if( argument == "-takeover" )
+		{
+			// Host in place of the server writing the checkpoints.
+			settings.Takeover = true;
+		}
+		else if( argument == "-checkbatch" && i + 2 < argc )
+		{
+			// Compare the match batch kernels with the scalar steps and exit: <matches> <ticks>.
+			checkMatches = static_cast<Bit::SizeType>( std::stoul( argv[ ++i ] ) );
+			checkTicks = static_cast<Bit::Uint32>( std::stoul( argv[ ++i ] ) );
+			g_Headless = true;
+		}
+		else if( argument == "-rollback" && i + 4 < argc )
+		{
+			// Play a peer directly, exchanging only inputs: left|right <port> <peer address> <peer port>.
+			unsigned int bytes[ 4 ] = { 0, 0, 0, 0 };
+			rollback = true;
+			const std::string side = argv[ ++i ];
+			if( side != "left" && side != "right" )
+			{
+				std::cout << "The side of a rollback peer is left or right." << std::endl;
+				return CloseApplication( );
+			}
+			rollbackPlayer = side == "right" ? 1 : 0;
+			rollbackPort = static_cast<Bit::Uint16>( std::stoul( argv[ ++i ] ) );
+			std::sscanf( argv[ ++i ], "%u.%u.%u.%u", &bytes[ 0 ], &bytes[ 1 ], &bytes[ 2 ], &bytes[ 3 ] );
+			peerAddress = Bit::Address(	static_cast<Bit::Uint8>( bytes[ 0 ] ), static_cast<Bit::Uint8>( bytes[ 1 ] ),
+										static_cast<Bit::Uint8>( bytes[ 2 ] ), static_cast<Bit::Uint8>( bytes[ 3 ] ) ).GetAddress( );
+			peerPort = static_cast<Bit::Uint16>( std::stoul( argv[ ++i ] ) );
+		}
+	}
+
+	if( fixedPhysics )
+	{
+		settings.MinPhysicsQuality = settings.MaxPhysicsQuality;
+	}
+
+	if( checkMatches > 0 )
+	{
+		const Bit::Bool equal = Pong::MatchBatch::Check( checkMatches, checkTicks, 1 );
+		CloseApplication( );
+		return equal ? 0 : 1;
+	}
+
+	// Rollback matches have no server.
+	if( rollback )
+	{
+		Pong::RollbackClient rollbackClient( clientSettings );
+		if( rollbackClient.Connect( rollbackPort, peerAddress, peerPort, settings, rollbackPlayer, Bit::Seconds( 30.0f ) ) == false )
+		{
+			std::cout << "Failed to reach the peer." << std::endl;
+			return CloseApplication( );
+		}
+
+		std::cout << "Running rollback match." << std::endl;
+		rollbackClient.Run( );
+		return CloseApplication( );
+	}
+
+	// Try to connect to the server, unless taking it over.
+	Pong::Client client( clientSettings );
+	if( settings.Takeover || client.Join( g_pServer, address, port, timeout ) == false )
+	{
+		if( settings.Takeover == false )
+		{
+			std::cout << "Failed to connect to server." << std::endl;
+		}
 
 		// Host your own game if you can't connect
-		g_pServer = new Pong::Server;
+		g_pServer = new Pong::Server( settings );
 		if( g_pServer->Host( port ) == false )
 		{
 			std::cout << "Failed to host server." << std::endl;
@@ -75,6 +234,23 @@ int main( int argc, char ** argv )
 	std::cout << "Running client." << std::endl;
 	client.Run( );
 
+	// Write the timeline in the server clock, lined up with the traces of other processes.
+	if( tracePath.empty( ) == false )
+	{
+		Pong::Trace::Enable( false );
+		const Bit::Int64 serverTime =	g_pServer ?	static_cast<Bit::Int64>( g_pServer->GetTime( ) ) :
+													static_cast<Bit::Int64>( client.ServerTimeNow( ).AsMicroseconds( ) );
+		const Bit::Int64 clockOffset = serverTime - static_cast<Bit::Int64>( Pong::Trace::GetTime( ) );
+		if( Pong::Trace::Write( tracePath, g_pServer ? "NetPong host" : "NetPong client", clockOffset ) )
+		{
+			std::cout << "Wrote trace to " << tracePath << "." << std::endl;
+		}
+		else
+		{
+			std::cout << "Failed to write trace to " << tracePath << "." << std::endl;
+		}
+	}
+
 	return CloseApplication( );
 }
 
@@ -88,6 +264,11 @@ int CloseApplication( )
 	}
 
 	std::cout << "Cleaned up the application." << std::endl;
-	std::cin.get();
+
+	// Headless runs are benchmarks, don't wait for a key.
+	if( g_Headless == false )
+	{
+		std::cin.get();
+	}
 	return 0;
 }
\ No newline at end of file
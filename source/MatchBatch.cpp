@@ -0,0 +1,716 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <MatchBatch.hpp>
+#include <Field.hpp>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <iostream>
+#if !defined( PONG_SIMD_SCALAR ) && ( defined( __AVX__ ) || defined( __AVX2__ ) )
+	#define PONG_SIMD_AVX
+	#include <immintrin.h>
+#elif !defined( PONG_SIMD_SCALAR ) && ( defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) )
+	#define PONG_SIMD_SSE2
+	#include <emmintrin.h>
+#endif
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Global variables
+	static const Bit::Float32 g_Bottom			= Field::BorderThickness * 0.5f;				///< Top of the lower border.
+	static const Bit::Float32 g_Top				= Field::Height - Field::BorderThickness * 0.5f;	///< Bottom of the upper border.
+	static const Bit::Float32 g_HalfWidth		= Field::PlayerWidth * 0.5f;
+	static const Bit::Float32 g_HalfHeight		= Field::PlayerHeight * 0.5f;
+	static const Bit::SizeType g_MatchSize		= 16 + 16;	///< Saved ball position and velocity, players 2 * 2.
+
+	// Global functions, the scalar steps of a single ball or player.
+	// The kernels below do the same operations in the same order, lane by lane.
+
+	// Move a player a distance in the direction of its velocity.
+	// The sum is computed in double precision, just like Vector2f32::y += Float64.
+	static inline Bit::Float32 MovePlayer( const Bit::Float32 p_PositionY, const Bit::Float32 p_Velocity, const Bit::Float64 p_Distance )
+	{
+		return static_cast<Bit::Float32>( static_cast<Bit::Float64>( p_PositionY ) + static_cast<Bit::Float64>( p_Velocity ) * p_Distance );
+	}
+
+	// Move a ball and bounce it off the borders.
+	static inline void MoveBall(	Bit::Float32 & p_X, Bit::Float32 & p_Y, const Bit::Float32 p_VelocityX, Bit::Float32 & p_VelocityY,
+									const Bit::Float32 p_Radius, const Bit::Float32 p_DeltaTime )
+	{
+		p_X = p_X + p_VelocityX * p_DeltaTime;
+		p_Y = p_Y + p_VelocityY * p_DeltaTime;
+
+		if( p_Y - p_Radius < g_Bottom )
+		{
+			p_Y = g_Bottom + p_Radius;
+			p_VelocityY = std::fabs( p_VelocityY );
+		}
+		else if( p_Y + p_Radius > g_Top )
+		{
+			p_Y = g_Top - p_Radius;
+			p_VelocityY = -std::fabs( p_VelocityY );
+		}
+	}
+
+	// Push a ball out of a player and reflect its velocity, if they overlap.
+	static inline void CollidePlayer(	Bit::Float32 & p_X, Bit::Float32 & p_Y, Bit::Float32 & p_VelocityX, Bit::Float32 & p_VelocityY,
+										const Bit::Float32 p_Radius, const Bit::Float32 p_PlayerX, const Bit::Float32 p_PlayerY )
+	{
+		const Bit::Float32 minX = p_PlayerX - g_HalfWidth;
+		const Bit::Float32 maxX = p_PlayerX + g_HalfWidth;
+		const Bit::Float32 minY = p_PlayerY - g_HalfHeight;
+		const Bit::Float32 maxY = p_PlayerY + g_HalfHeight;
+
+		// Closest point of the player.
+		const Bit::Float32 closestX = p_X < minX ? minX : ( p_X > maxX ? maxX : p_X );
+		const Bit::Float32 closestY = p_Y < minY ? minY : ( p_Y > maxY ? maxY : p_Y );
+		const Bit::Float32 distanceX = p_X - closestX;
+		const Bit::Float32 distanceY = p_Y - closestY;
+		const Bit::Float32 distanceSquared = distanceX * distanceX + distanceY * distanceY;
+
+		if( distanceSquared >= p_Radius * p_Radius )
+		{
+			return;
+		}
+
+		Bit::Float32 normalX = 0.0f;
+		Bit::Float32 normalY = 0.0f;
+		Bit::Float32 push = 0.0f;
+
+		if( distanceSquared > 0.0f )
+		{
+			const Bit::Float32 distance = std::sqrt( distanceSquared );
+			normalX = distanceX / distance;
+			normalY = distanceY / distance;
+			push = p_Radius - distance;
+		}
+		else
+		{
+			// The center is inside of the player, push out through the closest side.
+			const Bit::Float32 left = p_X - minX;
+			const Bit::Float32 right = maxX - p_X;
+			const Bit::Float32 bottom = p_Y - minY;
+			const Bit::Float32 top = maxY - p_Y;
+			const Bit::Float32 minHorizontal = left < right ? left : right;
+			const Bit::Float32 minVertical = bottom < top ? bottom : top;
+
+			if( minHorizontal < minVertical )
+			{
+				normalX = left < right ? -1.0f : 1.0f;
+				push = minHorizontal + p_Radius;
+			}
+			else
+			{
+				normalY = bottom < top ? -1.0f : 1.0f;
+				push = minVertical + p_Radius;
+			}
+		}
+
+		p_X = p_X + normalX * push;
+		p_Y = p_Y + normalY * push;
+
+		// Reflect the velocity if the ball moves into the player.
+		const Bit::Float32 normalVelocity = p_VelocityX * normalX + p_VelocityY * normalY;
+		if( normalVelocity < 0.0f )
+		{
+			p_VelocityX = p_VelocityX - 2.0f * normalVelocity * normalX;
+			p_VelocityY = p_VelocityY - 2.0f * normalVelocity * normalY;
+		}
+	}
+
+	// Check if a ball is completely outside of the field, to the left or right.
+	static inline Bit::Bool IsOutside( const Bit::Float32 p_X, const Bit::Float32 p_Radius )
+	{
+		return p_X + p_Radius <= 0.0f || p_X - p_Radius >= Field::Width;
+	}
+
+	// Serve a ball from the middle of the field.
+	static inline void ResetBall( Bit::Float32 & p_X, Bit::Float32 & p_Y )
+	{
+		p_X = Field::Width * 0.5f;
+		p_Y = Field::Height * 0.5f;
+	}
+
+	// Lanes of the kernels, one float per match.
+#if defined( PONG_SIMD_AVX )
+	#define PONG_SIMD_LANES
+	namespace Simd
+	{
+		typedef __m256 Lanes;
+		static const Bit::SizeType LaneCount = 8;
+		static inline Lanes Load( const Bit::Float32 * p_pData )			{ return _mm256_loadu_ps( p_pData ); }
+		static inline void Store( Bit::Float32 * p_pData, const Lanes p_Value )	{ _mm256_storeu_ps( p_pData, p_Value ); }
+		static inline Lanes Set( const Bit::Float32 p_Value )				{ return _mm256_set1_ps( p_Value ); }
+		static inline Lanes Add( const Lanes p_A, const Lanes p_B )			{ return _mm256_add_ps( p_A, p_B ); }
+		static inline Lanes Sub( const Lanes p_A, const Lanes p_B )			{ return _mm256_sub_ps( p_A, p_B ); }
+		static inline Lanes Mul( const Lanes p_A, const Lanes p_B )			{ return _mm256_mul_ps( p_A, p_B ); }
+		static inline Lanes Div( const Lanes p_A, const Lanes p_B )			{ return _mm256_div_ps( p_A, p_B ); }
+		static inline Lanes Sqrt( const Lanes p_A )							{ return _mm256_sqrt_ps( p_A ); }
+		static inline Lanes And( const Lanes p_A, const Lanes p_B )			{ return _mm256_and_ps( p_A, p_B ); }
+		static inline Lanes AndNot( const Lanes p_A, const Lanes p_B )		{ return _mm256_andnot_ps( p_A, p_B ); }
+		static inline Lanes Or( const Lanes p_A, const Lanes p_B )			{ return _mm256_or_ps( p_A, p_B ); }
+		static inline Lanes Less( const Lanes p_A, const Lanes p_B )		{ return _mm256_cmp_ps( p_A, p_B, _CMP_LT_OQ ); }
+		static inline Lanes Greater( const Lanes p_A, const Lanes p_B )		{ return _mm256_cmp_ps( p_A, p_B, _CMP_GT_OQ ); }
+		static inline Lanes NotGreaterEqual( const Lanes p_A, const Lanes p_B )	{ return _mm256_cmp_ps( p_A, p_B, _CMP_NGE_UQ ); }
+		static inline Lanes Select( const Lanes p_Mask, const Lanes p_A, const Lanes p_B )	{ return _mm256_blendv_ps( p_B, p_A, p_Mask ); }
+	}
+#elif defined( PONG_SIMD_SSE2 )
+	#define PONG_SIMD_LANES
+	namespace Simd
+	{
+		typedef __m128 Lanes;
+		static const Bit::SizeType LaneCount = 4;
+		static inline Lanes Load( const Bit::Float32 * p_pData )			{ return _mm_loadu_ps( p_pData ); }
+		static inline void Store( Bit::Float32 * p_pData, const Lanes p_Value )	{ _mm_storeu_ps( p_pData, p_Value ); }
+		static inline Lanes Set( const Bit::Float32 p_Value )				{ return _mm_set1_ps( p_Value ); }
+		static inline Lanes Add( const Lanes p_A, const Lanes p_B )			{ return _mm_add_ps( p_A, p_B ); }
+		static inline Lanes Sub( const Lanes p_A, const Lanes p_B )			{ return _mm_sub_ps( p_A, p_B ); }
+		static inline Lanes Mul( const Lanes p_A, const Lanes p_B )			{ return _mm_mul_ps( p_A, p_B ); }
+		static inline Lanes Div( const Lanes p_A, const Lanes p_B )			{ return _mm_div_ps( p_A, p_B ); }
+		static inline Lanes Sqrt( const Lanes p_A )							{ return _mm_sqrt_ps( p_A ); }
+		static inline Lanes And( const Lanes p_A, const Lanes p_B )			{ return _mm_and_ps( p_A, p_B ); }
+		static inline Lanes AndNot( const Lanes p_A, const Lanes p_B )		{ return _mm_andnot_ps( p_A, p_B ); }
+		static inline Lanes Or( const Lanes p_A, const Lanes p_B )			{ return _mm_or_ps( p_A, p_B ); }
+		static inline Lanes Less( const Lanes p_A, const Lanes p_B )		{ return _mm_cmplt_ps( p_A, p_B ); }
+		static inline Lanes Greater( const Lanes p_A, const Lanes p_B )		{ return _mm_cmpgt_ps( p_A, p_B ); }
+		static inline Lanes NotGreaterEqual( const Lanes p_A, const Lanes p_B )	{ return _mm_cmpnge_ps( p_A, p_B ); }
+		static inline Lanes Select( const Lanes p_Mask, const Lanes p_A, const Lanes p_B )	{ return _mm_or_ps( _mm_and_ps( p_Mask, p_A ), _mm_andnot_ps( p_Mask, p_B ) ); }
+	}
+#endif
+
+	// Move the players a distance in the direction of their velocity.
+	static void MovePlayers(	Bit::Float32 * p_pPositionY, const Bit::Float32 * p_pVelocity,
+								const Bit::SizeType p_Count, const Bit::Float64 p_Distance )
+	{
+		Bit::SizeType i = 0;
+
+	#if defined( PONG_SIMD_AVX )
+		const __m256d distance = _mm256_set1_pd( p_Distance );
+		for( ; i + 4 <= p_Count; i += 4 )
+		{
+			__m256d position = _mm256_cvtps_pd( _mm_loadu_ps( p_pPositionY + i ) );
+			const __m256d velocity = _mm256_cvtps_pd( _mm_loadu_ps( p_pVelocity + i ) );
+			position = _mm256_add_pd( position, _mm256_mul_pd( velocity, distance ) );
+			_mm_storeu_ps( p_pPositionY + i, _mm256_cvtpd_ps( position ) );
+		}
+	#elif defined( PONG_SIMD_SSE2 )
+		const __m128d distance = _mm_set1_pd( p_Distance );
+		for( ; i + 4 <= p_Count; i += 4 )
+		{
+			const __m128 position = _mm_loadu_ps( p_pPositionY + i );
+			const __m128 velocity = _mm_loadu_ps( p_pVelocity + i );
+			__m128d positionLow = _mm_cvtps_pd( position );
+			__m128d positionHigh = _mm_cvtps_pd( _mm_movehl_ps( position, position ) );
+			const __m128d velocityLow = _mm_cvtps_pd( velocity );
+			const __m128d velocityHigh = _mm_cvtps_pd( _mm_movehl_ps( velocity, velocity ) );
+			positionLow = _mm_add_pd( positionLow, _mm_mul_pd( velocityLow, distance ) );
+			positionHigh = _mm_add_pd( positionHigh, _mm_mul_pd( velocityHigh, distance ) );
+			_mm_storeu_ps( p_pPositionY + i, _mm_movelh_ps( _mm_cvtpd_ps( positionLow ), _mm_cvtpd_ps( positionHigh ) ) );
+		}
+	#endif
+
+		for( ; i < p_Count; i++ )
+		{
+			p_pPositionY[ i ] = MovePlayer( p_pPositionY[ i ], p_pVelocity[ i ], p_Distance );
+		}
+	}
+
+	// Move the balls and bounce them off the borders.
+	static void MoveBalls(	Bit::Float32 * p_pX, Bit::Float32 * p_pY, const Bit::Float32 * p_pVelocityX, Bit::Float32 * p_pVelocityY,
+							const Bit::Float32 * p_pRadius, const Bit::SizeType p_Count, const Bit::Float32 p_DeltaTime )
+	{
+		Bit::SizeType i = 0;
+
+	#if defined( PONG_SIMD_LANES )
+		const Simd::Lanes deltaTime = Simd::Set( p_DeltaTime );
+		const Simd::Lanes bottom = Simd::Set( g_Bottom );
+		const Simd::Lanes top = Simd::Set( g_Top );
+		const Simd::Lanes sign = Simd::Set( -0.0f );
+		for( ; i + Simd::LaneCount <= p_Count; i += Simd::LaneCount )
+		{
+			const Simd::Lanes radius = Simd::Load( p_pRadius + i );
+			const Simd::Lanes velocityX = Simd::Load( p_pVelocityX + i );
+			Simd::Lanes velocityY = Simd::Load( p_pVelocityY + i );
+			const Simd::Lanes x = Simd::Add( Simd::Load( p_pX + i ), Simd::Mul( velocityX, deltaTime ) );
+			Simd::Lanes y = Simd::Add( Simd::Load( p_pY + i ), Simd::Mul( velocityY, deltaTime ) );
+
+			// The lower border is tested first, like the scalar else if.
+			const Simd::Lanes below = Simd::Less( Simd::Sub( y, radius ), bottom );
+			const Simd::Lanes above = Simd::AndNot( below, Simd::Greater( Simd::Add( y, radius ), top ) );
+			const Simd::Lanes speed = Simd::AndNot( sign, velocityY );
+			y = Simd::Select( below, Simd::Add( bottom, radius ), Simd::Select( above, Simd::Sub( top, radius ), y ) );
+			velocityY = Simd::Select( below, speed, Simd::Select( above, Simd::Or( speed, sign ), velocityY ) );
+
+			Simd::Store( p_pX + i, x );
+			Simd::Store( p_pY + i, y );
+			Simd::Store( p_pVelocityY + i, velocityY );
+		}
+	#endif
+
+		for( ; i < p_Count; i++ )
+		{
+			MoveBall( p_pX[ i ], p_pY[ i ], p_pVelocityX[ i ], p_pVelocityY[ i ], p_pRadius[ i ], p_DeltaTime );
+		}
+	}
+
+	// Collide the balls with the players of one side.
+	static void CollidePlayers(	Bit::Float32 * p_pX, Bit::Float32 * p_pY, Bit::Float32 * p_pVelocityX, Bit::Float32 * p_pVelocityY,
+								const Bit::Float32 * p_pRadius, const Bit::Float32 * p_pPlayerX, const Bit::Float32 * p_pPlayerY,
+								const Bit::SizeType p_Count )
+	{
+		Bit::SizeType i = 0;
+
+	#if defined( PONG_SIMD_LANES )
+		const Simd::Lanes halfWidth = Simd::Set( g_HalfWidth );
+		const Simd::Lanes halfHeight = Simd::Set( g_HalfHeight );
+		const Simd::Lanes zero = Simd::Set( 0.0f );
+		const Simd::Lanes one = Simd::Set( 1.0f );
+		const Simd::Lanes minusOne = Simd::Set( -1.0f );
+		const Simd::Lanes two = Simd::Set( 2.0f );
+		for( ; i + Simd::LaneCount <= p_Count; i += Simd::LaneCount )
+		{
+			const Simd::Lanes x = Simd::Load( p_pX + i );
+			const Simd::Lanes y = Simd::Load( p_pY + i );
+			const Simd::Lanes velocityX = Simd::Load( p_pVelocityX + i );
+			const Simd::Lanes velocityY = Simd::Load( p_pVelocityY + i );
+			const Simd::Lanes radius = Simd::Load( p_pRadius + i );
+			const Simd::Lanes playerX = Simd::Load( p_pPlayerX + i );
+			const Simd::Lanes playerY = Simd::Load( p_pPlayerY + i );
+			const Simd::Lanes minX = Simd::Sub( playerX, halfWidth );
+			const Simd::Lanes maxX = Simd::Add( playerX, halfWidth );
+			const Simd::Lanes minY = Simd::Sub( playerY, halfHeight );
+			const Simd::Lanes maxY = Simd::Add( playerY, halfHeight );
+
+			// Closest point of the player.
+			const Simd::Lanes closestX = Simd::Select( Simd::Less( x, minX ), minX, Simd::Select( Simd::Greater( x, maxX ), maxX, x ) );
+			const Simd::Lanes closestY = Simd::Select( Simd::Less( y, minY ), minY, Simd::Select( Simd::Greater( y, maxY ), maxY, y ) );
+			const Simd::Lanes distanceX = Simd::Sub( x, closestX );
+			const Simd::Lanes distanceY = Simd::Sub( y, closestY );
+			const Simd::Lanes distanceSquared = Simd::Add( Simd::Mul( distanceX, distanceX ), Simd::Mul( distanceY, distanceY ) );
+			const Simd::Lanes hit = Simd::NotGreaterEqual( distanceSquared, Simd::Mul( radius, radius ) );
+
+			// Both ways out, the center outside and inside of the player, are computed and selected.
+			const Simd::Lanes outside = Simd::Greater( distanceSquared, zero );
+			const Simd::Lanes distance = Simd::Sqrt( distanceSquared );
+
+			const Simd::Lanes left = Simd::Sub( x, minX );
+			const Simd::Lanes right = Simd::Sub( maxX, x );
+			const Simd::Lanes bottom = Simd::Sub( y, minY );
+			const Simd::Lanes top = Simd::Sub( maxY, y );
+			const Simd::Lanes leftCloser = Simd::Less( left, right );
+			const Simd::Lanes bottomCloser = Simd::Less( bottom, top );
+			const Simd::Lanes minHorizontal = Simd::Select( leftCloser, left, right );
+			const Simd::Lanes minVertical = Simd::Select( bottomCloser, bottom, top );
+			const Simd::Lanes horizontal = Simd::Less( minHorizontal, minVertical );
+
+			const Simd::Lanes normalX = Simd::Select(	outside, Simd::Div( distanceX, distance ),
+														Simd::And( horizontal, Simd::Select( leftCloser, minusOne, one ) ) );
+			const Simd::Lanes normalY = Simd::Select(	outside, Simd::Div( distanceY, distance ),
+														Simd::AndNot( horizontal, Simd::Select( bottomCloser, minusOne, one ) ) );
+			const Simd::Lanes push = Simd::Select(	outside, Simd::Sub( radius, distance ),
+													Simd::Select( horizontal, Simd::Add( minHorizontal, radius ), Simd::Add( minVertical, radius ) ) );
+
+			// Reflect the velocity if the ball moves into the player.
+			const Simd::Lanes normalVelocity = Simd::Add( Simd::Mul( velocityX, normalX ), Simd::Mul( velocityY, normalY ) );
+			const Simd::Lanes reflect = Simd::And( hit, Simd::Less( normalVelocity, zero ) );
+			const Simd::Lanes doubleVelocity = Simd::Mul( two, normalVelocity );
+
+			Simd::Store( p_pX + i, Simd::Select( hit, Simd::Add( x, Simd::Mul( normalX, push ) ), x ) );
+			Simd::Store( p_pY + i, Simd::Select( hit, Simd::Add( y, Simd::Mul( normalY, push ) ), y ) );
+			Simd::Store( p_pVelocityX + i, Simd::Select( reflect, Simd::Sub( velocityX, Simd::Mul( doubleVelocity, normalX ) ), velocityX ) );
+			Simd::Store( p_pVelocityY + i, Simd::Select( reflect, Simd::Sub( velocityY, Simd::Mul( doubleVelocity, normalY ) ), velocityY ) );
+		}
+	#endif
+
+		for( ; i < p_Count; i++ )
+		{
+			CollidePlayer( p_pX[ i ], p_pY[ i ], p_pVelocityX[ i ], p_pVelocityY[ i ], p_pRadius[ i ], p_pPlayerX[ i ], p_pPlayerY[ i ] );
+		}
+	}
+
+	// Flag the balls that are completely outside of the field, to the left or right.
+	static void FindBallResets(	const Bit::Float32 * p_pPositionX, const Bit::Float32 * p_pRadius,
+								Bit::Uint8 * p_pResets, const Bit::SizeType p_Count )
+	{
+		Bit::SizeType i = 0;
+
+	#if defined( PONG_SIMD_AVX )
+		const __m256 zero = _mm256_setzero_ps( );
+		const __m256 width = _mm256_set1_ps( Field::Width );
+		for( ; i + 8 <= p_Count; i += 8 )
+		{
+			const __m256 position = _mm256_loadu_ps( p_pPositionX + i );
+			const __m256 radius = _mm256_loadu_ps( p_pRadius + i );
+			const __m256 left = _mm256_cmp_ps( _mm256_add_ps( position, radius ), zero, _CMP_LE_OQ );
+			const __m256 right = _mm256_cmp_ps( _mm256_sub_ps( position, radius ), width, _CMP_GE_OQ );
+			const int mask = _mm256_movemask_ps( _mm256_or_ps( left, right ) );
+			for( Bit::SizeType j = 0; j < 8; j++ )
+			{
+				p_pResets[ i + j ] = static_cast<Bit::Uint8>( ( mask >> j ) & 1 );
+			}
+		}
+	#elif defined( PONG_SIMD_SSE2 )
+		const __m128 zero = _mm_setzero_ps( );
+		const __m128 width = _mm_set1_ps( Field::Width );
+		for( ; i + 4 <= p_Count; i += 4 )
+		{
+			const __m128 position = _mm_loadu_ps( p_pPositionX + i );
+			const __m128 radius = _mm_loadu_ps( p_pRadius + i );
+			const __m128 left = _mm_cmple_ps( _mm_add_ps( position, radius ), zero );
+			const __m128 right = _mm_cmpge_ps( _mm_sub_ps( position, radius ), width );
+			const int mask = _mm_movemask_ps( _mm_or_ps( left, right ) );
+			for( Bit::SizeType j = 0; j < 4; j++ )
+			{
+				p_pResets[ i + j ] = static_cast<Bit::Uint8>( ( mask >> j ) & 1 );
+			}
+		}
+	#endif
+
+		for( ; i < p_Count; i++ )
+		{
+			p_pResets[ i ] = IsOutside( p_pPositionX[ i ], p_pRadius[ i ] ) ? 1 : 0;
+		}
+	}
+
+	// Match batch class
+	MatchBatch::MatchBatch( ) :
+		m_MatchCount( 0 )
+	{
+	}
+
+	void MatchBatch::Create( const Bit::SizeType p_MatchCount )
+	{
+		// Set up the states.
+		m_MatchCount = p_MatchCount;
+		m_BallStates.Resize( 0 );
+		m_BallStates.Resize( p_MatchCount );
+		m_BallVelocityX.assign( p_MatchCount, -Field::BallSpeed );
+		m_BallVelocityY.assign( p_MatchCount, Field::BallSpeed * 0.5f );
+		m_PlayerStates.Resize( p_MatchCount * 2 );
+		m_PlayerVelocities.assign( p_MatchCount * 2, 0.0f );
+		m_BallResets.assign( p_MatchCount, 0 );
+		for( Bit::SizeType j = 0; j < 2; j++ )
+		{
+			m_PaddleX[ j ].assign( p_MatchCount, 0.0f );
+			m_PaddleY[ j ].assign( p_MatchCount, 0.0f );
+		}
+
+		// Serve the balls from the middle, towards the left player.
+		for( Bit::SizeType i = 0; i < p_MatchCount; i++ )
+		{
+			ResetBall( m_BallStates.PositionX[ i ], m_BallStates.PositionY[ i ] );
+			m_BallStates.Radius[ i ] = Field::BallRadius;
+
+			m_PlayerStates.PositionX[ i * 2 ] = Field::PlayerOffset;
+			m_PlayerStates.PositionX[ i * 2 + 1 ] = Field::Width - Field::PlayerOffset;
+			m_PlayerStates.PositionY[ i * 2 ] = Field::Height * 0.5f;
+			m_PlayerStates.PositionY[ i * 2 + 1 ] = Field::Height * 0.5f;
+		}
+	}
+
+	void MatchBatch::Step( const Bit::Time & p_Time )
+	{
+		Step( 0, m_MatchCount, p_Time );
+	}
+
+	void MatchBatch::Step( const Bit::SizeType p_First, const Bit::SizeType p_Count, const Bit::Time & p_Time )
+	{
+		if( p_First >= m_MatchCount )
+		{
+			return;
+		}
+
+		const Bit::SizeType matchCount = p_First + p_Count > m_MatchCount ? m_MatchCount - p_First : p_Count;
+		const Bit::SizeType matchEnd = p_First + matchCount;
+		if( matchCount == 0 )
+		{
+			return;
+		}
+
+		// Move the players over the whole step.
+		const Bit::Float64 distance = Field::PlayerSpeed * p_Time.AsSeconds( );
+		MovePlayers(	&m_PlayerStates.PositionY[ p_First * 2 ], &m_PlayerVelocities[ p_First * 2 ],
+						matchCount * 2, distance );
+		CopyPaddles( p_First, matchCount );
+
+		// Move the balls and bounce them off the borders and the players, substep by substep.
+		const Bit::Uint32 substeps = m_PhysicsQuality.Substeps > 0 ? m_PhysicsQuality.Substeps : 1;
+		const Bit::Float32 deltaTime = static_cast<Bit::Float32>( p_Time.AsSeconds( ) / substeps );
+		Bit::Float32 * pX = &m_BallStates.PositionX[ p_First ];
+		Bit::Float32 * pY = &m_BallStates.PositionY[ p_First ];
+		Bit::Float32 * pVelocityX = &m_BallVelocityX[ p_First ];
+		Bit::Float32 * pVelocityY = &m_BallVelocityY[ p_First ];
+		const Bit::Float32 * pRadius = &m_BallStates.Radius[ p_First ];
+
+		for( Bit::Uint32 i = 0; i < substeps; i++ )
+		{
+			MoveBalls( pX, pY, pVelocityX, pVelocityY, pRadius, matchCount, deltaTime );
+			for( Bit::SizeType j = 0; j < 2; j++ )
+			{
+				CollidePlayers(	pX, pY, pVelocityX, pVelocityY, pRadius,
+								&m_PaddleX[ j ][ p_First ], &m_PaddleY[ j ][ p_First ], matchCount );
+			}
+		}
+
+		// Serve the balls that left the field again.
+		FindBallResets( pX, pRadius, &m_BallResets[ p_First ], matchCount );
+		for( Bit::SizeType i = p_First; i < matchEnd; i++ )
+		{
+			if( m_BallResets[ i ] )
+			{
+				ResetBall( m_BallStates.PositionX[ i ], m_BallStates.PositionY[ i ] );
+			}
+		}
+	}
+
+	void MatchBatch::StepScalar( const Bit::SizeType p_First, const Bit::SizeType p_Count, const Bit::Time & p_Time )
+	{
+		const Bit::SizeType matchEnd = p_First + p_Count > m_MatchCount ? m_MatchCount : p_First + p_Count;
+		const Bit::Float64 distance = Field::PlayerSpeed * p_Time.AsSeconds( );
+		const Bit::Uint32 substeps = m_PhysicsQuality.Substeps > 0 ? m_PhysicsQuality.Substeps : 1;
+		const Bit::Float32 deltaTime = static_cast<Bit::Float32>( p_Time.AsSeconds( ) / substeps );
+
+		for( Bit::SizeType i = p_First; i < matchEnd; i++ )
+		{
+			Bit::Float32 & x = m_BallStates.PositionX[ i ];
+			Bit::Float32 & y = m_BallStates.PositionY[ i ];
+			const Bit::Float32 radius = m_BallStates.Radius[ i ];
+
+			for( Bit::SizeType j = i * 2; j < i * 2 + 2; j++ )
+			{
+				m_PlayerStates.PositionY[ j ] = MovePlayer( m_PlayerStates.PositionY[ j ], m_PlayerVelocities[ j ], distance );
+			}
+
+			for( Bit::Uint32 k = 0; k < substeps; k++ )
+			{
+				MoveBall( x, y, m_BallVelocityX[ i ], m_BallVelocityY[ i ], radius, deltaTime );
+				for( Bit::SizeType j = i * 2; j < i * 2 + 2; j++ )
+				{
+					CollidePlayer(	x, y, m_BallVelocityX[ i ], m_BallVelocityY[ i ], radius,
+									m_PlayerStates.PositionX[ j ], m_PlayerStates.PositionY[ j ] );
+				}
+			}
+
+			if( IsOutside( x, radius ) )
+			{
+				ResetBall( x, y );
+			}
+		}
+	}
+
+	void MatchBatch::SetPlayerInput(	const Bit::SizeType p_Match, const Bit::SizeType p_Player,
+										const Bit::Bool p_IsMoving, const eDirection p_Direction )
+	{
+		Bit::Float32 velocity = 0.0f;
+		if( p_IsMoving )
+		{
+			velocity = p_Direction == eDirection::Up ? 1.0f : -1.0f;
+		}
+
+		m_PlayerVelocities[ p_Match * 2 + p_Player ] = velocity;
+	}
+
+	void MatchBatch::SetPlayerVelocity( const Bit::SizeType p_Match, const Bit::SizeType p_Player, const Bit::Float32 p_Velocity )
+	{
+		m_PlayerVelocities[ p_Match * 2 + p_Player ] = p_Velocity;
+	}
+
+	void MatchBatch::SetPhysicsQuality( const PhysicsQuality & p_Quality )
+	{
+		m_PhysicsQuality = p_Quality;
+	}
+
+	Bit::SizeType MatchBatch::GetMatchCount( ) const
+	{
+		return m_MatchCount;
+	}
+
+	const BallStates & MatchBatch::GetBallStates( ) const
+	{
+		return m_BallStates;
+	}
+
+	const PlayerStates & MatchBatch::GetPlayerStates( ) const
+	{
+		return m_PlayerStates;
+	}
+
+	void MatchBatch::SaveState( Packet & p_Packet ) const
+	{
+		p_Packet.WriteUint32( static_cast<Bit::Uint32>( m_MatchCount ) );
+
+		for( Bit::SizeType i = 0; i < m_MatchCount; i++ )
+		{
+			p_Packet.WriteFloat( m_BallStates.PositionX[ i ] );
+			p_Packet.WriteFloat( m_BallStates.PositionY[ i ] );
+			p_Packet.WriteFloat( m_BallVelocityX[ i ] );
+			p_Packet.WriteFloat( m_BallVelocityY[ i ] );
+
+			for( Bit::SizeType j = i * 2; j < i * 2 + 2; j++ )
+			{
+				p_Packet.WriteFloat( m_PlayerStates.PositionY[ j ] );
+				p_Packet.WriteFloat( m_PlayerVelocities[ j ] );
+			}
+		}
+	}
+
+	Bit::Bool MatchBatch::LoadState( Packet & p_Packet )
+	{
+		if( p_Packet.ReadUint32( ) != m_MatchCount )
+		{
+			return false;
+		}
+
+		if( p_Packet.GetRemainingSize( ) < m_MatchCount * g_MatchSize )
+		{
+			return false;
+		}
+
+		for( Bit::SizeType i = 0; i < m_MatchCount; i++ )
+		{
+			m_BallStates.PositionX[ i ] = p_Packet.ReadFloat( );
+			m_BallStates.PositionY[ i ] = p_Packet.ReadFloat( );
+			m_BallVelocityX[ i ] = p_Packet.ReadFloat( );
+			m_BallVelocityY[ i ] = p_Packet.ReadFloat( );
+
+			for( Bit::SizeType j = i * 2; j < i * 2 + 2; j++ )
+			{
+				m_PlayerStates.PositionY[ j ] = p_Packet.ReadFloat( );
+				m_PlayerVelocities[ j ] = p_Packet.ReadFloat( );
+			}
+		}
+
+		return true;
+	}
+
+	const char * MatchBatch::GetInstructionSet( )
+	{
+	#if defined( PONG_SIMD_AVX )
+		return "AVX";
+	#elif defined( PONG_SIMD_SSE2 )
+		return "SSE2";
+	#else
+		return "Scalar";
+	#endif
+	}
+
+	Bit::Bool MatchBatch::Check( const Bit::SizeType p_MatchCount, const Bit::Uint32 p_TickCount, const Bit::Uint32 p_Seed )
+	{
+		MatchBatch batch;
+		MatchBatch reference;
+		batch.Create( p_MatchCount );
+		reference.Create( p_MatchCount );
+
+		// Start from random states, the balls hit the borders and the players from all directions.
+		std::mt19937 random( p_Seed );
+		std::uniform_real_distribution<Bit::Float32> positionX( 0.0f, Field::Width );
+		std::uniform_real_distribution<Bit::Float32> positionY( g_Bottom, g_Top );
+		std::uniform_real_distribution<Bit::Float32> velocity( -Field::BallSpeed * 2.0f, Field::BallSpeed * 2.0f );
+		std::uniform_real_distribution<Bit::Float32> input( -1.0f, 1.0f );
+
+		Packet state;
+		state.WriteUint32( static_cast<Bit::Uint32>( p_MatchCount ) );
+		for( Bit::SizeType i = 0; i < p_MatchCount; i++ )
+		{
+			state.WriteFloat( positionX( random ) );
+			state.WriteFloat( positionY( random ) );
+			state.WriteFloat( velocity( random ) );
+			state.WriteFloat( velocity( random ) );
+			for( Bit::SizeType j = 0; j < 2; j++ )
+			{
+				state.WriteFloat( positionY( random ) );
+				state.WriteFloat( 0.0f );
+			}
+		}
+		batch.LoadState( state );
+		state.Rewind( );
+		reference.LoadState( state );
+
+		// Step in two uneven ranges, like the jobs of the server, with the lanes left over at the ends.
+		const Bit::SizeType split = p_MatchCount / 3;
+		const Bit::Time time = Bit::Microseconds( 16667 );
+		Packet batchState;
+		Packet referenceState;
+		for( Bit::Uint32 tick = 0; tick < p_TickCount; tick++ )
+		{
+			// Change the inputs now and then, to full and to partial velocities.
+			for( Bit::SizeType i = 0; i < p_MatchCount * 2; i++ )
+			{
+				if( random( ) % 16 == 0 )
+				{
+					const Bit::Uint32 kind = random( ) % 4;
+					const Bit::Float32 playerVelocity = kind == 0 ? 0.0f : ( kind == 1 ? 1.0f : ( kind == 2 ? -1.0f : input( random ) ) );
+					batch.SetPlayerVelocity( i / 2, i % 2, playerVelocity );
+					reference.SetPlayerVelocity( i / 2, i % 2, playerVelocity );
+				}
+			}
+
+			// Vary the substeps, like the quality governor.
+			const PhysicsQuality quality( 1 + ( tick / 60 ) % 4 );
+			batch.SetPhysicsQuality( quality );
+			reference.SetPhysicsQuality( quality );
+
+			batch.Step( 0, split, time );
+			batch.Step( split, p_MatchCount - split, time );
+			reference.StepScalar( 0, p_MatchCount, time );
+
+			batchState.Clear( );
+			referenceState.Clear( );
+			batch.SaveState( batchState );
+			reference.SaveState( referenceState );
+			if( std::memcmp( batchState.GetData( ), referenceState.GetData( ), batchState.GetSize( ) ) != 0 )
+			{
+				Bit::SizeType match = 0;
+				while( std::memcmp( batchState.GetData( ) + 4 + match * g_MatchSize, referenceState.GetData( ) + 4 + match * g_MatchSize, g_MatchSize ) == 0 )
+				{
+					match++;
+				}
+
+				std::cout	<< "The " << GetInstructionSet( ) << " match batch differs from the scalar steps at tick " << tick
+							<< ", match " << match << "." << std::endl;
+				return false;
+			}
+		}
+
+		std::cout	<< "The " << GetInstructionSet( ) << " match batch equals the scalar steps, "
+					<< p_MatchCount << " matches over " << p_TickCount << " ticks." << std::endl;
+		return true;
+	}
+
+	void MatchBatch::CopyPaddles( const Bit::SizeType p_First, const Bit::SizeType p_Count )
+	{
+		// The kernels read the players of one side as contiguous arrays.
+		for( Bit::SizeType i = p_First; i < p_First + p_Count; i++ )
+		{
+			for( Bit::SizeType j = 0; j < 2; j++ )
+			{
+				m_PaddleX[ j ][ i ] = m_PlayerStates.PositionX[ i * 2 + j ];
+				m_PaddleY[ j ][ i ] = m_PlayerStates.PositionY[ i * 2 + j ];
+			}
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <MessageBatcher.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	MessageBatcher::Recipient::Recipient( ) :
+		Active( false ),
+		FrameCount( 0 )
+	{
+	}
+
+	MessageBatcher::MessageBatcher( const Bit::SizeType p_Mtu ) :
+		m_Mtu( p_Mtu ),
+		m_MessageCount( 0 ),
+		m_FrameCount( 0 )
+	{
+	}
+
+	void MessageBatcher::SetMtu( const Bit::SizeType p_Mtu )
+	{
+		m_Mutex.Lock( );
+		m_Mtu = p_Mtu;
+		m_Mutex.Unlock( );
+	}
+
+	Bit::SizeType MessageBatcher::GetFrameCapacity( ) const
+	{
+		// Always leave room for at least one small record.
+		if( m_Mtu < HeaderReserve + RecordHeaderSize + 16 )
+		{
+			return RecordHeaderSize + 16;
+		}
+
+		return m_Mtu - HeaderReserve;
+	}
+
+	void MessageBatcher::AddUser( const Bit::Uint16 p_UserId )
+	{
+		m_Mutex.Lock( );
+
+		if( p_UserId >= m_Recipients.size( ) )
+		{
+			m_Recipients.resize( p_UserId + 1 );
+		}
+
+		Recipient & recipient = m_Recipients[ p_UserId ];
+		recipient.Active = true;
+		recipient.FrameCount = 0;
+
+		// Preallocate the first frame, to keep the ticks allocation free.
+		if( recipient.Frames.empty( ) )
+		{
+			recipient.Frames.resize( 1 );
+			recipient.Frames[ 0 ].Reserve( GetFrameCapacity( ) );
+		}
+
+		m_Mutex.Unlock( );
+	}
+
+	void MessageBatcher::RemoveUser( const Bit::Uint16 p_UserId )
+	{
+		m_Mutex.Lock( );
+
+		if( p_UserId < m_Recipients.size( ) )
+		{
+			Recipient & recipient = m_Recipients[ p_UserId ];
+			recipient.Active = false;
+
+			for( Bit::SizeType i = 0; i < recipient.FrameCount; i++ )
+			{
+				recipient.Frames[ i ].Clear( );
+			}
+			recipient.FrameCount = 0;
+		}
+
+		m_Mutex.Unlock( );
+	}
+
+	Bit::Bool MessageBatcher::Queue( const Bit::Uint16 p_UserId, const Bit::Uint8 p_Type, const Packet & p_Payload )
+	{
+		// The record size field is 16 bits.
+		if( p_Payload.GetSize( ) > 0xFFFF )
+		{
+			return false;
+		}
+
+		m_Mutex.Lock( );
+
+		if( p_UserId >= m_Recipients.size( ) || m_Recipients[ p_UserId ].Active == false )
+		{
+			m_Mutex.Unlock( );
+			return false;
+		}
+
+		QueueRecord( m_Recipients[ p_UserId ], p_Type, p_Payload );
+
+		m_Mutex.Unlock( );
+		return true;
+	}
+
+	void MessageBatcher::Broadcast( const Bit::Uint8 p_Type, const Packet & p_Payload )
+	{
+		if( p_Payload.GetSize( ) > 0xFFFF )
+		{
+			return;
+		}
+
+		m_Mutex.Lock( );
+
+		for( Bit::SizeType i = 0; i < m_Recipients.size( ); i++ )
+		{
+			if( m_Recipients[ i ].Active )
+			{
+				QueueRecord( m_Recipients[ i ], p_Type, p_Payload );
+			}
+		}
+
+		m_Mutex.Unlock( );
+	}
+
+	Bit::Uint64 MessageBatcher::GetMessageCount( ) const
+	{
+		return m_MessageCount;
+	}
+
+	Bit::Uint64 MessageBatcher::GetFrameCount( ) const
+	{
+		return m_FrameCount;
+	}
+
+	void MessageBatcher::QueueRecord( Recipient & p_Recipient, const Bit::Uint8 p_Type, const Packet & p_Payload )
+	{
+		const Bit::SizeType recordSize = RecordHeaderSize + p_Payload.GetSize( );
+		const Bit::SizeType capacity = GetFrameCapacity( );
+
+		// Start a new frame if the record does not fit in the current one.
+		// Records larger than a frame are sent alone, in an oversized frame.
+		if( p_Recipient.FrameCount == 0 ||
+			( p_Recipient.Frames[ p_Recipient.FrameCount - 1 ].GetSize( ) + recordSize > capacity &&
+			  p_Recipient.Frames[ p_Recipient.FrameCount - 1 ].GetSize( ) != 0 ) )
+		{
+			if( p_Recipient.FrameCount == p_Recipient.Frames.size( ) )
+			{
+				p_Recipient.Frames.resize( p_Recipient.FrameCount + 1 );
+				p_Recipient.Frames.back( ).Reserve( capacity );
+			}
+			p_Recipient.FrameCount++;
+		}
+
+		// Append the record.
+		Packet & frame = p_Recipient.Frames[ p_Recipient.FrameCount - 1 ];
+		frame.WriteByte( p_Type );
+		frame.WriteUint16( static_cast<Bit::Uint16>( p_Payload.GetSize( ) ) );
+		frame.WriteArray( p_Payload.GetData( ), p_Payload.GetSize( ) );
+
+		m_MessageCount++;
+	}
+
+}
\ No newline at end of file
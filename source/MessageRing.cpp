@@ -0,0 +1,153 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <MessageRing.hpp>
+#include <cstring>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Global variables
+	static const Bit::Uint8 WrapType = 0;	///< Record type of the unused end of the buffer.
+
+	// Global functions
+
+	// Size of a record, aligned to the header size.
+	static Bit::SizeType GetRecordSize( const Bit::SizeType p_Size )
+	{
+		return ( MessageRing::HeaderSize + p_Size + MessageRing::HeaderSize - 1 ) & ~( MessageRing::HeaderSize - 1 );
+	}
+
+	// Message ring class
+	MessageRing::MessageRing( const Bit::SizeType p_Capacity ) :
+		m_Mask( 0 ),
+		m_WritePosition( 0 ),
+		m_FullCount( 0 ),
+		m_ReadPosition( 0 ),
+		m_RecordSize( 0 )
+	{
+		Bit::SizeType capacity = HeaderSize * 2;
+		while( capacity < p_Capacity )
+		{
+			capacity *= 2;
+		}
+
+		m_Buffer.resize( capacity, 0 );
+		m_Mask = capacity - 1;
+	}
+
+	Bit::Bool MessageRing::Write( const Bit::Uint8 p_Type, const void * p_pData, const Bit::SizeType p_Size )
+	{
+		const Bit::SizeType capacity = m_Buffer.size( );
+		const Bit::SizeType recordSize = GetRecordSize( p_Size );
+		Bit::SizeType write = m_WritePosition.load( std::memory_order_relaxed );
+		const Bit::SizeType read = m_ReadPosition.load( std::memory_order_acquire );
+
+		// A record not fitting before the end starts over at the beginning, the end is skipped.
+		const Bit::SizeType end = capacity - ( write & m_Mask );
+		const Bit::SizeType skip = end < recordSize ? end : 0;
+		if( recordSize > capacity / 2 || capacity - ( write - read ) < skip + recordSize )
+		{
+			m_FullCount.fetch_add( 1, std::memory_order_relaxed );
+			return false;
+		}
+
+		if( skip > 0 )
+		{
+			m_Buffer[ write & m_Mask ] = WrapType;
+			write += skip;
+		}
+
+		// Header: type, 3 unused bytes and the size.
+		Bit::Uint8 * pRecord = &m_Buffer[ write & m_Mask ];
+		const Bit::Uint32 size = static_cast<Bit::Uint32>( p_Size );
+		pRecord[ 0 ] = p_Type;
+		std::memcpy( pRecord + 4, &size, sizeof( size ) );
+		if( p_Size > 0 )
+		{
+			std::memcpy( pRecord + HeaderSize, p_pData, p_Size );
+		}
+
+		m_WritePosition.store( write + recordSize, std::memory_order_release );
+		return true;
+	}
+
+	const Bit::Uint8 * MessageRing::Read( Bit::Uint8 & p_Type, Bit::SizeType & p_Size )
+	{
+		Bit::SizeType read = m_ReadPosition.load( std::memory_order_relaxed );
+		const Bit::SizeType write = m_WritePosition.load( std::memory_order_acquire );
+		if( read == write )
+		{
+			return NULL;
+		}
+
+		// Skip the unused end of the buffer.
+		if( m_Buffer[ read & m_Mask ] == WrapType )
+		{
+			read += m_Buffer.size( ) - ( read & m_Mask );
+			m_ReadPosition.store( read, std::memory_order_release );
+			if( read == write )
+			{
+				return NULL;
+			}
+		}
+
+		const Bit::Uint8 * pRecord = &m_Buffer[ read & m_Mask ];
+		Bit::Uint32 size = 0;
+		std::memcpy( &size, pRecord + 4, sizeof( size ) );
+
+		p_Type = pRecord[ 0 ];
+		p_Size = size;
+		m_RecordSize = GetRecordSize( size );
+		return pRecord + HeaderSize;
+	}
+
+	void MessageRing::Pop( )
+	{
+		m_ReadPosition.store( m_ReadPosition.load( std::memory_order_relaxed ) + m_RecordSize, std::memory_order_release );
+		m_RecordSize = 0;
+	}
+
+	void MessageRing::Clear( )
+	{
+		m_ReadPosition.store( m_WritePosition.load( std::memory_order_acquire ), std::memory_order_release );
+		m_RecordSize = 0;
+	}
+
+	Bit::SizeType MessageRing::GetCapacity( ) const
+	{
+		return m_Buffer.size( );
+	}
+
+	Bit::SizeType MessageRing::GetUsedSize( ) const
+	{
+		return m_WritePosition.load( std::memory_order_relaxed ) - m_ReadPosition.load( std::memory_order_acquire );
+	}
+
+	Bit::Uint64 MessageRing::GetFullCount( ) const
+	{
+		return m_FullCount.load( std::memory_order_relaxed );
+	}
+
+}
\ No newline at end of file
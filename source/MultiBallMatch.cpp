@@ -0,0 +1,405 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <MultiBallMatch.hpp>
+#include <Field.hpp>
+#include <cmath>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Global functions
+
+	// Xorshift random number generator, identical on all platforms.
+	static Bit::Uint32 NextRandom( Bit::Uint32 & p_State )
+	{
+		p_State ^= p_State << 13;
+		p_State ^= p_State >> 17;
+		p_State ^= p_State << 5;
+		return p_State;
+	}
+
+	// Random number between p_Min and p_Max.
+	static Bit::Float32 RandomRange( Bit::Uint32 & p_State, const Bit::Float32 p_Min, const Bit::Float32 p_Max )
+	{
+		const Bit::Float32 unit = static_cast<Bit::Float32>( NextRandom( p_State ) & 0xFFFFFF ) / static_cast<Bit::Float32>( 0xFFFFFF );
+		return p_Min + ( p_Max - p_Min ) * unit;
+	}
+
+	static Bit::Uint32 SeedState( const Bit::Uint32 p_Seed )
+	{
+		return p_Seed ? p_Seed : 0x9E3779B9;
+	}
+
+	// Multi-ball match class
+	MultiBallMatch::MultiBallMatch( )
+	{
+		m_PlayerVelocities[ 0 ] = 0.0f;
+		m_PlayerVelocities[ 1 ] = 0.0f;
+	}
+
+	void MultiBallMatch::Create(	const Bit::SizeType p_BallCount, const Bit::SizeType p_ObstacleCount,
+									const Bit::Uint32 p_Seed )
+	{
+		// Create the players
+		m_PlayerStates.Resize( 2 );
+		m_PlayerStates.PositionX[ 0 ] = Field::PlayerOffset;
+		m_PlayerStates.PositionX[ 1 ] = Field::Width - Field::PlayerOffset;
+		m_PlayerStates.PositionY[ 0 ] = Field::Height * 0.5f;
+		m_PlayerStates.PositionY[ 1 ] = Field::Height * 0.5f;
+		m_PlayerVelocities[ 0 ] = 0.0f;
+		m_PlayerVelocities[ 1 ] = 0.0f;
+
+		// Create the obstacles, and the static grid of the obstacles.
+		CreateObstacles( p_Seed, p_ObstacleCount, m_Obstacles );
+
+		const Bit::Float32 cellSize = Field::SmallBallRadius * 2.0f;
+		m_ObstacleGrid.Create( 0.0f, 0.0f, Field::Width, Field::Height, cellSize );
+		if( p_ObstacleCount )
+		{
+			m_ObstacleGrid.BuildBoxes(	&m_Obstacles.MinX[ 0 ], &m_Obstacles.MinY[ 0 ],
+										&m_Obstacles.MaxX[ 0 ], &m_Obstacles.MaxY[ 0 ],
+										p_ObstacleCount, Field::SmallBallRadius );
+		}
+		m_BallGrid.Create( 0.0f, 0.0f, Field::Width, Field::Height, cellSize );
+
+		// Create the balls, spread out on a lattice in the middle of the field.
+		m_BallStates.Resize( p_BallCount );
+		m_VelocityX.assign( p_BallCount, 0.0f );
+		m_VelocityY.assign( p_BallCount, 0.0f );
+
+		const Bit::Float32 spacing = Field::SmallBallRadius * 3.0f;
+		const Bit::Float32 minX = Field::PlayerOffset + Field::PlayerWidth + spacing;
+		const Bit::Float32 maxX = Field::Width - minX;
+		const Bit::Float32 minY = Field::BorderThickness + spacing;
+		const Bit::Float32 maxY = Field::Height - minY;
+		const Bit::SizeType rows = static_cast<Bit::SizeType>( ( maxY - minY ) / spacing ) + 1;
+
+		Bit::Uint32 random = SeedState( p_Seed );
+		for( Bit::SizeType i = 0; i < p_BallCount; i++ )
+		{
+			const Bit::SizeType column = i / rows;
+			m_BallStates.PositionX[ i ] = Field::Width * 0.5f + ( column % 2 ? 1.0f : -1.0f ) * spacing * static_cast<Bit::Float32>( ( column + 1 ) / 2 );
+			m_BallStates.PositionY[ i ] = minY + spacing * static_cast<Bit::Float32>( i % rows );
+			if( m_BallStates.PositionX[ i ] < minX || m_BallStates.PositionX[ i ] > maxX )
+			{
+				m_BallStates.PositionX[ i ] = RandomRange( random, minX, maxX );
+			}
+			m_BallStates.Rotation[ i ] = 0.0;
+			m_BallStates.Radius[ i ] = Field::SmallBallRadius;
+
+			// Aim within 45 degrees of one of the players.
+			const Bit::Float32 angle = RandomRange( random, -0.785f, 0.785f );
+			const Bit::Float32 side = ( NextRandom( random ) & 1 ) ? 1.0f : -1.0f;
+			m_VelocityX[ i ] = std::cos( angle ) * Field::SmallBallSpeed * side;
+			m_VelocityY[ i ] = std::sin( angle ) * Field::SmallBallSpeed;
+		}
+	}
+
+	void MultiBallMatch::Step( const Bit::Time & p_Time )
+	{
+		const Bit::Float64 seconds = p_Time.AsSeconds( );
+		const Bit::Float32 deltaTime = static_cast<Bit::Float32>( seconds );
+		const Bit::SizeType ballCount = m_BallStates.GetCount( );
+
+		// Move the players
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			m_PlayerStates.PositionY[ i ] = static_cast<Bit::Float32>(	m_PlayerStates.PositionY[ i ] +
+																		m_PlayerVelocities[ i ] * Field::PlayerSpeed * seconds );
+		}
+
+		if( ballCount == 0 )
+		{
+			return;
+		}
+
+		// Move the balls and bounce them off the borders.
+		const Bit::Float32 bottom = Field::BorderThickness * 0.5f;
+		const Bit::Float32 top = Field::Height - Field::BorderThickness * 0.5f;
+		for( Bit::SizeType i = 0; i < ballCount; i++ )
+		{
+			Bit::Float32 & y = m_BallStates.PositionY[ i ];
+			const Bit::Float32 radius = m_BallStates.Radius[ i ];
+
+			m_BallStates.PositionX[ i ] += m_VelocityX[ i ] * deltaTime;
+			y += m_VelocityY[ i ] * deltaTime;
+
+			if( y - radius < bottom )
+			{
+				y = bottom + radius;
+				m_VelocityY[ i ] = std::fabs( m_VelocityY[ i ] );
+			}
+			else if( y + radius > top )
+			{
+				y = top - radius;
+				m_VelocityY[ i ] = -std::fabs( m_VelocityY[ i ] );
+			}
+		}
+
+		// Collide the ball pairs found by the broadphase.
+		m_BallGrid.BuildPoints( &m_BallStates.PositionX[ 0 ], &m_BallStates.PositionY[ 0 ], ballCount );
+		m_BallGrid.ForEachPair( [ this ] ( const Bit::SizeType p_A, const Bit::SizeType p_B )
+		{
+			CollideBalls( p_A, p_B );
+		} );
+
+		// Collide the balls with the obstacles and the players.
+		const Bit::Float32 halfWidth = Field::PlayerWidth * 0.5f;
+		const Bit::Float32 halfHeight = Field::PlayerHeight * 0.5f;
+		for( Bit::SizeType i = 0; i < ballCount; i++ )
+		{
+			m_ObstacleGrid.ForEachInCell( m_BallStates.PositionX[ i ], m_BallStates.PositionY[ i ], [ this, i ] ( const Bit::SizeType p_Obstacle )
+			{
+				CollideBox(	i, m_Obstacles.MinX[ p_Obstacle ], m_Obstacles.MinY[ p_Obstacle ],
+							m_Obstacles.MaxX[ p_Obstacle ], m_Obstacles.MaxY[ p_Obstacle ] );
+			} );
+
+			for( Bit::SizeType j = 0; j < 2; j++ )
+			{
+				CollideBox(	i,	m_PlayerStates.PositionX[ j ] - halfWidth, m_PlayerStates.PositionY[ j ] - halfHeight,
+								m_PlayerStates.PositionX[ j ] + halfWidth, m_PlayerStates.PositionY[ j ] + halfHeight );
+			}
+
+			// Reset the balls that left the field.
+			if( m_BallStates.PositionX[ i ] + m_BallStates.Radius[ i ] <= 0.0f ||
+				m_BallStates.PositionX[ i ] - m_BallStates.Radius[ i ] >= Field::Width )
+			{
+				ResetBall( i );
+			}
+		}
+	}
+
+	void MultiBallMatch::SetPlayerInput( const Bit::SizeType p_Player, const Bit::Bool p_IsMoving, const eDirection p_Direction )
+	{
+		Bit::Float32 velocity = 0.0f;
+		if( p_IsMoving )
+		{
+			velocity = p_Direction == eDirection::Up ? 1.0f : -1.0f;
+		}
+
+		m_PlayerVelocities[ p_Player ] = velocity;
+	}
+
+	void MultiBallMatch::SetPlayerVelocity( const Bit::SizeType p_Player, const Bit::Float32 p_Velocity )
+	{
+		m_PlayerVelocities[ p_Player ] = p_Velocity;
+	}
+
+	const BallStates & MultiBallMatch::GetBallStates( ) const
+	{
+		return m_BallStates;
+	}
+
+	const PlayerStates & MultiBallMatch::GetPlayerStates( ) const
+	{
+		return m_PlayerStates;
+	}
+
+	const Obstacles & MultiBallMatch::GetObstacles( ) const
+	{
+		return m_Obstacles;
+	}
+
+	void MultiBallMatch::SaveState( Packet & p_Packet ) const
+	{
+		const Bit::SizeType ballCount = m_BallStates.GetCount( );
+		p_Packet.WriteUint32( static_cast<Bit::Uint32>( ballCount ) );
+
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			p_Packet.WriteFloat( m_PlayerStates.PositionY[ i ] );
+			p_Packet.WriteFloat( m_PlayerVelocities[ i ] );
+		}
+
+		for( Bit::SizeType i = 0; i < ballCount; i++ )
+		{
+			p_Packet.WriteFloat( m_BallStates.PositionX[ i ] );
+			p_Packet.WriteFloat( m_BallStates.PositionY[ i ] );
+			p_Packet.WriteFloat( m_VelocityX[ i ] );
+			p_Packet.WriteFloat( m_VelocityY[ i ] );
+		}
+	}
+
+	Bit::Bool MultiBallMatch::LoadState( Packet & p_Packet )
+	{
+		const Bit::SizeType ballCount = m_BallStates.GetCount( );
+		if( p_Packet.ReadUint32( ) != ballCount ||
+			p_Packet.GetRemainingSize( ) < 16 + ballCount * 16 )
+		{
+			return false;
+		}
+
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			m_PlayerStates.PositionY[ i ] = p_Packet.ReadFloat( );
+			m_PlayerVelocities[ i ] = p_Packet.ReadFloat( );
+		}
+
+		for( Bit::SizeType i = 0; i < ballCount; i++ )
+		{
+			m_BallStates.PositionX[ i ] = p_Packet.ReadFloat( );
+			m_BallStates.PositionY[ i ] = p_Packet.ReadFloat( );
+			m_VelocityX[ i ] = p_Packet.ReadFloat( );
+			m_VelocityY[ i ] = p_Packet.ReadFloat( );
+		}
+
+		return true;
+	}
+
+	void MultiBallMatch::CreateObstacles( const Bit::Uint32 p_Seed, const Bit::SizeType p_Count, Obstacles & p_Obstacles )
+	{
+		p_Obstacles.MinX.resize( p_Count );
+		p_Obstacles.MinY.resize( p_Count );
+		p_Obstacles.MaxX.resize( p_Count );
+		p_Obstacles.MaxY.resize( p_Count );
+
+		// Place the obstacles between the players, leaving the ball lanes in front of the players free.
+		const Bit::Float32 minX = Field::PlayerOffset + 1.0f;
+		const Bit::Float32 maxX = Field::Width - minX;
+		const Bit::Float32 minY = Field::BorderThickness + 0.2f;
+		const Bit::Float32 maxY = Field::Height - minY;
+
+		Bit::Uint32 random = SeedState( p_Seed ) ^ 0x5BD1E995;
+		for( Bit::SizeType i = 0; i < p_Count; i++ )
+		{
+			const Bit::Float32 halfSize = RandomRange( random, 0.05f, 0.15f );
+			const Bit::Float32 x = RandomRange( random, minX + halfSize, maxX - halfSize );
+			const Bit::Float32 y = RandomRange( random, minY + halfSize, maxY - halfSize );
+
+			p_Obstacles.MinX[ i ] = x - halfSize;
+			p_Obstacles.MinY[ i ] = y - halfSize;
+			p_Obstacles.MaxX[ i ] = x + halfSize;
+			p_Obstacles.MaxY[ i ] = y + halfSize;
+		}
+	}
+
+	void MultiBallMatch::CollideBalls( const Bit::SizeType p_A, const Bit::SizeType p_B )
+	{
+		const Bit::Float32 distanceX = m_BallStates.PositionX[ p_B ] - m_BallStates.PositionX[ p_A ];
+		const Bit::Float32 distanceY = m_BallStates.PositionY[ p_B ] - m_BallStates.PositionY[ p_A ];
+		const Bit::Float32 radius = m_BallStates.Radius[ p_A ] + m_BallStates.Radius[ p_B ];
+		const Bit::Float32 distanceSquared = distanceX * distanceX + distanceY * distanceY;
+
+		if( distanceSquared >= radius * radius || distanceSquared <= 0.0f )
+		{
+			return;
+		}
+
+		// Separate the balls along the normal.
+		const Bit::Float32 distance = std::sqrt( distanceSquared );
+		const Bit::Float32 normalX = distanceX / distance;
+		const Bit::Float32 normalY = distanceY / distance;
+		const Bit::Float32 halfOverlap = ( radius - distance ) * 0.5f;
+
+		m_BallStates.PositionX[ p_A ] -= normalX * halfOverlap;
+		m_BallStates.PositionY[ p_A ] -= normalY * halfOverlap;
+		m_BallStates.PositionX[ p_B ] += normalX * halfOverlap;
+		m_BallStates.PositionY[ p_B ] += normalY * halfOverlap;
+
+		// Exchange the normal velocities of approaching balls, elastic collision of equal masses.
+		const Bit::Float32 normalVelocity =	( m_VelocityX[ p_B ] - m_VelocityX[ p_A ] ) * normalX +
+											( m_VelocityY[ p_B ] - m_VelocityY[ p_A ] ) * normalY;
+		if( normalVelocity < 0.0f )
+		{
+			m_VelocityX[ p_A ] += normalVelocity * normalX;
+			m_VelocityY[ p_A ] += normalVelocity * normalY;
+			m_VelocityX[ p_B ] -= normalVelocity * normalX;
+			m_VelocityY[ p_B ] -= normalVelocity * normalY;
+		}
+	}
+
+	void MultiBallMatch::CollideBox(	const Bit::SizeType p_Ball,
+										const Bit::Float32 p_MinX, const Bit::Float32 p_MinY,
+										const Bit::Float32 p_MaxX, const Bit::Float32 p_MaxY )
+	{
+		Bit::Float32 & x = m_BallStates.PositionX[ p_Ball ];
+		Bit::Float32 & y = m_BallStates.PositionY[ p_Ball ];
+		const Bit::Float32 radius = m_BallStates.Radius[ p_Ball ];
+
+		// Closest point of the box.
+		const Bit::Float32 closestX = x < p_MinX ? p_MinX : ( x > p_MaxX ? p_MaxX : x );
+		const Bit::Float32 closestY = y < p_MinY ? p_MinY : ( y > p_MaxY ? p_MaxY : y );
+		const Bit::Float32 distanceX = x - closestX;
+		const Bit::Float32 distanceY = y - closestY;
+		const Bit::Float32 distanceSquared = distanceX * distanceX + distanceY * distanceY;
+
+		if( distanceSquared >= radius * radius )
+		{
+			return;
+		}
+
+		Bit::Float32 normalX = 0.0f;
+		Bit::Float32 normalY = 0.0f;
+		Bit::Float32 push = 0.0f;
+
+		if( distanceSquared > 0.0f )
+		{
+			const Bit::Float32 distance = std::sqrt( distanceSquared );
+			normalX = distanceX / distance;
+			normalY = distanceY / distance;
+			push = radius - distance;
+		}
+		else
+		{
+			// The center is inside of the box, push out through the closest side.
+			const Bit::Float32 left = x - p_MinX;
+			const Bit::Float32 right = p_MaxX - x;
+			const Bit::Float32 bottom = y - p_MinY;
+			const Bit::Float32 top = p_MaxY - y;
+			const Bit::Float32 minHorizontal = left < right ? left : right;
+			const Bit::Float32 minVertical = bottom < top ? bottom : top;
+
+			if( minHorizontal < minVertical )
+			{
+				normalX = left < right ? -1.0f : 1.0f;
+				push = minHorizontal + radius;
+			}
+			else
+			{
+				normalY = bottom < top ? -1.0f : 1.0f;
+				push = minVertical + radius;
+			}
+		}
+
+		x += normalX * push;
+		y += normalY * push;
+
+		// Reflect the velocity if the ball moves into the box.
+		const Bit::Float32 normalVelocity = m_VelocityX[ p_Ball ] * normalX + m_VelocityY[ p_Ball ] * normalY;
+		if( normalVelocity < 0.0f )
+		{
+			m_VelocityX[ p_Ball ] -= 2.0f * normalVelocity * normalX;
+			m_VelocityY[ p_Ball ] -= 2.0f * normalVelocity * normalY;
+		}
+	}
+
+	void MultiBallMatch::ResetBall( const Bit::SizeType p_Ball )
+	{
+		// Serve the ball from the middle, towards the player that scored.
+		m_BallStates.PositionX[ p_Ball ] = Field::Width * 0.5f;
+		m_VelocityX[ p_Ball ] = -m_VelocityX[ p_Ball ];
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,373 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <NetEmulator.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Global functions
+
+	// Xorshift random number generator.
+	static Bit::Uint32 NextRandom( Bit::Uint32 & p_State )
+	{
+		p_State ^= p_State << 13;
+		p_State ^= p_State >> 17;
+		p_State ^= p_State << 5;
+		return p_State;
+	}
+
+	// Net conditions structure
+	NetConditions::NetConditions( ) :
+		Latency( Bit::Time::Zero ),
+		Jitter( Bit::Time::Zero ),
+		LossRate( 0.0f ),
+		DuplicateRate( 0.0f ),
+		ReorderRate( 0.0f ),
+		ReorderDelay( Bit::Milliseconds( 10 ) ),
+		Bandwidth( 0 ),
+		MaxQueueDelay( Bit::Milliseconds( 250 ) )
+	{
+	}
+
+	// Statistics structure
+	NetEmulator::Statistics::Statistics( ) :
+		Datagrams( 0 ),
+		Bytes( 0 ),
+		Delivered( 0 ),
+		Lost( 0 ),
+		Duplicated( 0 ),
+		Reordered( 0 ),
+		Dropped( 0 )
+	{
+	}
+
+	// Delayed structure
+	Bit::Bool NetEmulator::Delayed::operator <( const Delayed & p_Delayed ) const
+	{
+		// Reversed, the priority queue puts the earliest release on top.
+		if( Release != p_Delayed.Release )
+		{
+			return Release > p_Delayed.Release;
+		}
+		return Sequence > p_Delayed.Sequence;
+	}
+
+	// Net emulator class
+	NetEmulator::NetEmulator( ) :
+		m_Running( false ),
+		m_ServerAddress( 0 ),
+		m_ServerPort( 0 ),
+		m_Random( 1 ),
+		m_Sequence( 0 )
+	{
+		for( Bit::SizeType i = 0; i < LinkCount; i++ )
+		{
+			m_LastRelease[ i ] = 0;
+			m_LinkFree[ i ] = 0;
+		}
+	}
+
+	NetEmulator::~NetEmulator( )
+	{
+		Stop( );
+	}
+
+	Bit::Bool NetEmulator::Start(	const Bit::Uint16 p_Port, const Bit::Uint32 p_ServerAddress,
+									const Bit::Uint16 p_ServerPort, const Bit::Uint32 p_Seed )
+	{
+		Stop( );
+
+		if( m_Socket.Open( p_Port, p_ServerAddress ) == false )
+		{
+			return false;
+		}
+
+		m_ServerAddress = p_ServerAddress;
+		m_ServerPort = p_ServerPort;
+		m_Random = p_Seed ? p_Seed : 0x9E3779B9;
+		m_Sequence = 0;
+		for( Bit::SizeType i = 0; i < LinkCount; i++ )
+		{
+			m_Statistics[ i ] = Statistics( );
+			m_LastRelease[ i ] = 0;
+			m_LinkFree[ i ] = 0;
+		}
+
+		m_Timer.Start( );
+		m_Running = true;
+		m_Thread.Execute( [ this ] ( )
+		{
+			Run( );
+		} );
+
+		return true;
+	}
+
+	void NetEmulator::Stop( )
+	{
+		m_Mutex.Lock( );
+		m_Running = false;
+		m_Mutex.Unlock( );
+		m_Thread.Finish( );
+
+		for( SessionMap::iterator it = m_Sessions.begin( ); it != m_Sessions.end( ); it++ )
+		{
+			delete it->second;
+		}
+		m_Sessions.clear( );
+		m_Delayed = std::priority_queue<Delayed>( );
+		m_Socket.Close( );
+	}
+
+	void NetEmulator::SetConditions( const eLink p_Link, const NetConditions & p_Conditions )
+	{
+		m_Mutex.Lock( );
+		m_Conditions[ p_Link ] = p_Conditions;
+		m_Mutex.Unlock( );
+	}
+
+	NetConditions NetEmulator::GetConditions( const eLink p_Link )
+	{
+		m_Mutex.Lock( );
+		const NetConditions conditions = m_Conditions[ p_Link ];
+		m_Mutex.Unlock( );
+		return conditions;
+	}
+
+	NetEmulator::Statistics NetEmulator::GetStatistics( const eLink p_Link )
+	{
+		m_Mutex.Lock( );
+		const Statistics statistics = m_Statistics[ p_Link ];
+		m_Mutex.Unlock( );
+		return statistics;
+	}
+
+	void NetEmulator::Run( )
+	{
+		while( true )
+		{
+			// Copy the conditions of this round.
+			NetConditions conditions[ LinkCount ];
+			m_Mutex.Lock( );
+			if( m_Running == false )
+			{
+				m_Mutex.Unlock( );
+				return;
+			}
+			for( Bit::SizeType i = 0; i < LinkCount; i++ )
+			{
+				conditions[ i ] = m_Conditions[ i ];
+			}
+			m_Mutex.Unlock( );
+
+			// Only the client socket is waited on, the server sockets are polled every round.
+			m_Socket.Wait( Bit::Milliseconds( 1 ) );
+			const Bit::Uint64 now = GetTime( );
+
+			// Datagrams from the clients.
+			Bit::SizeType count = 0;
+			while( ( count = m_Socket.Receive( ) ) > 0 )
+			{
+				for( Bit::SizeType i = 0; i < count; i++ )
+				{
+					const DatagramSocket::Datagram & datagram = m_Socket.GetReceived( i );
+					const Bit::Uint64 key = ( static_cast<Bit::Uint64>( datagram.Address ) << 16 ) | datagram.Port;
+
+					SessionMap::iterator it = m_Sessions.find( key );
+					if( it == m_Sessions.end( ) )
+					{
+						Session * pSession = new Session;
+						pSession->Address = datagram.Address;
+						pSession->Port = datagram.Port;
+						pSession->LastActive = now;
+						pSession->Pending = 0;
+						if( pSession->Socket.Open( 0, m_ServerAddress ) == false )
+						{
+							delete pSession;
+							continue;
+						}
+						it = m_Sessions.insert( SessionMap::value_type( key, pSession ) ).first;
+					}
+
+					Schedule( Upstream, conditions[ Upstream ], it->second, datagram, now );
+				}
+			}
+
+			// Datagrams from the server.
+			for( SessionMap::iterator it = m_Sessions.begin( ); it != m_Sessions.end( ); it++ )
+			{
+				Session * pSession = it->second;
+				while( ( count = pSession->Socket.Receive( ) ) > 0 )
+				{
+					for( Bit::SizeType i = 0; i < count; i++ )
+					{
+						Schedule( Downstream, conditions[ Downstream ], pSession, pSession->Socket.GetReceived( i ), now );
+					}
+				}
+			}
+
+			// Release the datagrams that are due.
+			Bit::Uint64 delivered[ LinkCount ] = { 0, 0 };
+			while( m_Delayed.empty( ) == false && m_Delayed.top( ).Release <= now )
+			{
+				// Empty datagrams are legal UDP.
+				const Delayed & delayed = m_Delayed.top( );
+				const Bit::Uint8 * pData = delayed.Data.empty( ) ? NULL : &delayed.Data[ 0 ];
+				if( delayed.Link == Upstream )
+				{
+					delayed.pSession->Socket.Queue( m_ServerAddress, m_ServerPort, pData, delayed.Data.size( ) );
+				}
+				else
+				{
+					m_Socket.Queue( delayed.pSession->Address, delayed.pSession->Port, pData, delayed.Data.size( ) );
+				}
+				delayed.pSession->Pending--;
+				delivered[ delayed.Link ]++;
+				m_Delayed.pop( );
+			}
+
+			m_Socket.Flush( );
+			for( SessionMap::iterator it = m_Sessions.begin( ); it != m_Sessions.end( ); it++ )
+			{
+				it->second->Socket.Flush( );
+			}
+			ExpireSessions( now );
+
+			m_Mutex.Lock( );
+			for( Bit::SizeType i = 0; i < LinkCount; i++ )
+			{
+				m_Statistics[ i ].Delivered += delivered[ i ];
+			}
+			m_Mutex.Unlock( );
+		}
+	}
+
+	void NetEmulator::Schedule(	const eLink p_Link, const NetConditions & p_Conditions, Session * p_pSession,
+								const DatagramSocket::Datagram & p_Datagram, const Bit::Uint64 p_Now )
+	{
+		Statistics statistics;
+
+		p_pSession->LastActive = p_Now;
+		statistics.Datagrams++;
+		statistics.Bytes += p_Datagram.Size;
+
+		if( NextChance( ) < p_Conditions.LossRate )
+		{
+			statistics.Lost++;
+		}
+		else
+		{
+			const Bit::SizeType copies = NextChance( ) < p_Conditions.DuplicateRate ? 2 : 1;
+			statistics.Duplicated += copies - 1;
+
+			for( Bit::SizeType i = 0; i < copies; i++ )
+			{
+				// Every copy uses the bandwidth of the link.
+				Bit::Uint64 queueDelay = 0;
+				if( p_Conditions.Bandwidth > 0 )
+				{
+					const Bit::Uint64 start = m_LinkFree[ p_Link ] > p_Now ? m_LinkFree[ p_Link ] : p_Now;
+					const Bit::Uint64 linkFree = start + static_cast<Bit::Uint64>( p_Datagram.Size ) * 1000000 / p_Conditions.Bandwidth;
+					if( linkFree - p_Now > p_Conditions.MaxQueueDelay.AsMicroseconds( ) )
+					{
+						statistics.Dropped++;
+						continue;
+					}
+					m_LinkFree[ p_Link ] = linkFree;
+					queueDelay = linkFree - p_Now;
+				}
+
+				// Jitter the latency, without passing the previous datagram.
+				const Bit::Int64 jitter = static_cast<Bit::Int64>( p_Conditions.Jitter.AsMicroseconds( ) );
+				Bit::Int64 delay = static_cast<Bit::Int64>( p_Conditions.Latency.AsMicroseconds( ) + queueDelay );
+				if( jitter > 0 )
+				{
+					delay += static_cast<Bit::Int64>( NextRandom( m_Random ) % static_cast<Bit::Uint32>( jitter * 2 + 1 ) ) - jitter;
+				}
+				Bit::Uint64 release = p_Now + static_cast<Bit::Uint64>( delay > 0 ? delay : 0 );
+				if( release < m_LastRelease[ p_Link ] )
+				{
+					release = m_LastRelease[ p_Link ];
+				}
+				m_LastRelease[ p_Link ] = release;
+
+				// Hold back some datagrams, the following ones overtake them.
+				if( NextChance( ) < p_Conditions.ReorderRate )
+				{
+					release += p_Conditions.ReorderDelay.AsMicroseconds( );
+					statistics.Reordered++;
+				}
+
+				Delayed delayed;
+				delayed.Release = release;
+				delayed.Sequence = m_Sequence++;
+				delayed.Link = p_Link;
+				delayed.pSession = p_pSession;
+				delayed.Data.assign( p_Datagram.Data, p_Datagram.Data + p_Datagram.Size );
+				m_Delayed.push( delayed );
+				p_pSession->Pending++;
+			}
+		}
+
+		m_Mutex.Lock( );
+		Statistics & total = m_Statistics[ p_Link ];
+		total.Datagrams += statistics.Datagrams;
+		total.Bytes += statistics.Bytes;
+		total.Lost += statistics.Lost;
+		total.Duplicated += statistics.Duplicated;
+		total.Reordered += statistics.Reordered;
+		total.Dropped += statistics.Dropped;
+		m_Mutex.Unlock( );
+	}
+
+	void NetEmulator::ExpireSessions( const Bit::Uint64 p_Now )
+	{
+		// Clients reconnecting from a new port leave their old sessions idle.
+		for( SessionMap::iterator it = m_Sessions.begin( ); it != m_Sessions.end( ); )
+		{
+			Session * pSession = it->second;
+			if( pSession->Pending == 0 && p_Now - pSession->LastActive > SessionTimeout )
+			{
+				delete pSession;
+				m_Sessions.erase( it++ );
+			}
+			else
+			{
+				it++;
+			}
+		}
+	}
+
+	Bit::Float32 NetEmulator::NextChance( )
+	{
+		return static_cast<Bit::Float32>( NextRandom( m_Random ) & 0xFFFFFF ) / static_cast<Bit::Float32>( 0x1000000 );
+	}
+
+	Bit::Uint64 NetEmulator::GetTime( )
+	{
+		return static_cast<Bit::Uint64>( m_Timer.GetLapsedTime( ).AsMicroseconds( ) );
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,262 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Packet.hpp>
+#include <cstring>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	Packet::Packet( ) :
+		m_ReadPosition( 0 ),
+		m_Valid( true )
+	{
+	}
+
+	void Packet::Clear( )
+	{
+		m_Data.clear( );
+		m_ReadPosition = 0;
+		m_Valid = true;
+	}
+
+	void Packet::Reserve( const Bit::SizeType p_Size )
+	{
+		m_Data.reserve( p_Size );
+	}
+
+	void Packet::Assign( const void * p_pData, const Bit::SizeType p_Size )
+	{
+		const Bit::Uint8 * pData = reinterpret_cast<const Bit::Uint8 *>( p_pData );
+		m_Data.assign( pData, pData + p_Size );
+		m_ReadPosition = 0;
+		m_Valid = true;
+	}
+
+	void Packet::Resize( const Bit::SizeType p_Size )
+	{
+		m_Data.resize( p_Size, 0 );
+	}
+
+	void Packet::WriteByte( const Bit::Uint8 p_Value )
+	{
+		m_Data.push_back( p_Value );
+	}
+
+	void Packet::WriteUint16( const Bit::Uint16 p_Value )
+	{
+		m_Data.push_back( static_cast<Bit::Uint8>( p_Value ) );
+		m_Data.push_back( static_cast<Bit::Uint8>( p_Value >> 8 ) );
+	}
+
+	void Packet::WriteUint32( const Bit::Uint32 p_Value )
+	{
+		for( Bit::SizeType i = 0; i < 4; i++ )
+		{
+			m_Data.push_back( static_cast<Bit::Uint8>( p_Value >> ( i * 8 ) ) );
+		}
+	}
+
+	void Packet::WriteUint64( const Bit::Uint64 p_Value )
+	{
+		for( Bit::SizeType i = 0; i < 8; i++ )
+		{
+			m_Data.push_back( static_cast<Bit::Uint8>( p_Value >> ( i * 8 ) ) );
+		}
+	}
+
+	void Packet::WriteInt( const Bit::Int32 p_Value )
+	{
+		WriteUint32( static_cast<Bit::Uint32>( p_Value ) );
+	}
+
+	void Packet::WriteFloat( const Bit::Float32 p_Value )
+	{
+		Bit::Uint32 bits = 0;
+		std::memcpy( &bits, &p_Value, sizeof( bits ) );
+		WriteUint32( bits );
+	}
+
+	void Packet::WriteVector2( const Bit::Vector2f32 & p_Value )
+	{
+		WriteFloat( p_Value.x );
+		WriteFloat( p_Value.y );
+	}
+
+	void Packet::WriteArray( const void * p_pData, const Bit::SizeType p_Size )
+	{
+		const Bit::Uint8 * pData = reinterpret_cast<const Bit::Uint8 *>( p_pData );
+		m_Data.insert( m_Data.end( ), pData, pData + p_Size );
+	}
+
+	Bit::Uint8 Packet::ReadByte( )
+	{
+		if( GetRemainingSize( ) < 1 )
+		{
+			m_Valid = false;
+			return 0;
+		}
+
+		return m_Data[ m_ReadPosition++ ];
+	}
+
+	Bit::Uint16 Packet::ReadUint16( )
+	{
+		if( GetRemainingSize( ) < 2 )
+		{
+			m_ReadPosition = m_Data.size( );
+			m_Valid = false;
+			return 0;
+		}
+
+		Bit::Uint16 value =	static_cast<Bit::Uint16>( m_Data[ m_ReadPosition ] ) |
+							static_cast<Bit::Uint16>( m_Data[ m_ReadPosition + 1 ] << 8 );
+		m_ReadPosition += 2;
+		return value;
+	}
+
+	Bit::Uint32 Packet::ReadUint32( )
+	{
+		if( GetRemainingSize( ) < 4 )
+		{
+			m_ReadPosition = m_Data.size( );
+			m_Valid = false;
+			return 0;
+		}
+
+		Bit::Uint32 value = 0;
+		for( Bit::SizeType i = 0; i < 4; i++ )
+		{
+			value |= static_cast<Bit::Uint32>( m_Data[ m_ReadPosition + i ] ) << ( i * 8 );
+		}
+		m_ReadPosition += 4;
+		return value;
+	}
+
+	Bit::Uint64 Packet::ReadUint64( )
+	{
+		if( GetRemainingSize( ) < 8 )
+		{
+			m_ReadPosition = m_Data.size( );
+			m_Valid = false;
+			return 0;
+		}
+
+		Bit::Uint64 value = 0;
+		for( Bit::SizeType i = 0; i < 8; i++ )
+		{
+			value |= static_cast<Bit::Uint64>( m_Data[ m_ReadPosition + i ] ) << ( i * 8 );
+		}
+		m_ReadPosition += 8;
+		return value;
+	}
+
+	Bit::Int32 Packet::ReadInt( )
+	{
+		return static_cast<Bit::Int32>( ReadUint32( ) );
+	}
+
+	Bit::Float32 Packet::ReadFloat( )
+	{
+		Bit::Uint32 bits = ReadUint32( );
+		Bit::Float32 value = 0.0f;
+		std::memcpy( &value, &bits, sizeof( value ) );
+		return value;
+	}
+
+	Bit::Vector2f32 Packet::ReadVector2( )
+	{
+		Bit::Vector2f32 value;
+		value.x = ReadFloat( );
+		value.y = ReadFloat( );
+		return value;
+	}
+
+	Bit::Bool Packet::ReadArray( void * p_pData, const Bit::SizeType p_Size )
+	{
+		if( GetRemainingSize( ) < p_Size )
+		{
+			m_ReadPosition = m_Data.size( );
+			m_Valid = false;
+			return false;
+		}
+
+		if( p_Size )
+		{
+			std::memcpy( p_pData, &m_Data[ m_ReadPosition ], p_Size );
+		}
+		m_ReadPosition += p_Size;
+		return true;
+	}
+
+	Bit::Bool Packet::Skip( const Bit::SizeType p_Size )
+	{
+		if( GetRemainingSize( ) < p_Size )
+		{
+			m_ReadPosition = m_Data.size( );
+			m_Valid = false;
+			return false;
+		}
+
+		m_ReadPosition += p_Size;
+		return true;
+	}
+
+	void Packet::Rewind( )
+	{
+		m_ReadPosition = 0;
+		m_Valid = true;
+	}
+
+	const Bit::Uint8 * Packet::GetData( ) const
+	{
+		return m_Data.empty( ) ? NULL : &m_Data[ 0 ];
+	}
+
+	Bit::Uint8 * Packet::GetData( )
+	{
+		return m_Data.empty( ) ? NULL : &m_Data[ 0 ];
+	}
+
+	Bit::SizeType Packet::GetSize( ) const
+	{
+		return m_Data.size( );
+	}
+
+	Bit::SizeType Packet::GetReadPosition( ) const
+	{
+		return m_ReadPosition;
+	}
+
+	Bit::SizeType Packet::GetRemainingSize( ) const
+	{
+		return m_Data.size( ) - m_ReadPosition;
+	}
+
+	Bit::Bool Packet::IsValid( ) const
+	{
+		return m_Valid;
+	}
+
+}
\ No newline at end of file
@@ -22,14 +22,40 @@
 // ///////////////////////////////////////////////////////////////////////////
 
 #include <Player.hpp>
-
+#include <BlockPool.hpp>
+#include <new>
 
 namespace Pong
 {
 
+	// Block pool of all players, allocated 64 at a time.
+	static BlockPool g_PlayerPool( sizeof( Player ), 64 );
+
 	Player::Player() :
 		IsMoving(false)
 	{
 	}
 
+	void * Player::operator new( std::size_t p_Size )
+	{
+		// Derived classes are larger than the blocks.
+		if( p_Size != sizeof( Player ) )
+		{
+			return ::operator new( p_Size );
+		}
+
+		return g_PlayerPool.Allocate( );
+	}
+
+	void Player::operator delete( void * p_pPointer, std::size_t p_Size )
+	{
+		if( p_Size != sizeof( Player ) )
+		{
+			::operator delete( p_pPointer );
+			return;
+		}
+
+		g_PlayerPool.Free( p_pPointer );
+	}
+
 }
\ No newline at end of file
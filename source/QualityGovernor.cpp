@@ -0,0 +1,167 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <QualityGovernor.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Global functions
+
+	// Value of a level, from p_Maximum at level 0 to p_Minimum at the last level.
+	static Bit::Uint32 Interpolate(	const Bit::Uint32 p_Maximum, const Bit::Uint32 p_Minimum,
+									const Bit::Uint32 p_Level, const Bit::Uint32 p_LevelCount )
+	{
+		if( p_LevelCount < 2 )
+		{
+			return p_Maximum;
+		}
+
+		const Bit::Uint32 steps = p_LevelCount - 1;
+		return p_Maximum - ( ( p_Maximum - p_Minimum ) * p_Level + steps / 2 ) / steps;
+	}
+
+	// Statistics structure
+	QualityGovernor::Statistics::Statistics( ) :
+		Downgrades( 0 ),
+		Upgrades( 0 ),
+		ReducedTicks( 0 )
+	{
+	}
+
+	// Quality governor class
+	QualityGovernor::QualityGovernor( ) :
+		m_Level( 0 ),
+		m_LevelCount( 1 ),
+		m_Load( 0.0 ),
+		m_HighTicks( 0 ),
+		m_LowTicks( 0 ),
+		m_UpgradeTicks( UpgradeTicks ),
+		m_Upgraded( false )
+	{
+	}
+
+	void QualityGovernor::Create( const PhysicsQuality & p_Maximum, const PhysicsQuality & p_Minimum )
+	{
+		m_Maximum = p_Maximum;
+		m_Maximum.Substeps = m_Maximum.Substeps > 0 ? m_Maximum.Substeps : 1;
+
+		m_Minimum.Substeps = p_Minimum.Substeps < m_Maximum.Substeps ? p_Minimum.Substeps : m_Maximum.Substeps;
+		m_Minimum.Substeps = m_Minimum.Substeps > 0 ? m_Minimum.Substeps : 1;
+
+		// One level per substep, a single level if there is nothing to scale.
+		m_LevelCount = m_Maximum.Substeps - m_Minimum.Substeps + 1;
+
+		m_Load = 0.0;
+		m_HighTicks = 0;
+		m_LowTicks = 0;
+		m_UpgradeTicks = UpgradeTicks;
+		m_Upgraded = false;
+		m_Statistics = Statistics( );
+		SetLevel( 0 );
+	}
+
+	Bit::Bool QualityGovernor::Update( const Bit::Time & p_TickTime, const Bit::Time & p_Budget )
+	{
+		const Bit::Float64 budget = p_Budget.AsSeconds( );
+		const Bit::Float64 load = budget > 0.0 ? p_TickTime.AsSeconds( ) / budget : 0.0;
+		m_Load = m_Load * 0.9 + load * 0.1;
+
+		m_HighTicks = load * 100.0 > HighLoadPercent ? m_HighTicks + 1 : 0;
+		m_LowTicks = m_Load * 100.0 < LowLoadPercent ? m_LowTicks + 1 : 0;
+
+		Bit::Bool changed = false;
+		if( m_HighTicks >= DowngradeTicks && m_Level + 1 < m_LevelCount )
+		{
+			// A step up that did not fit, wait longer before the next one.
+			if( m_Upgraded && m_UpgradeTicks < UpgradeTicks * 16 )
+			{
+				m_UpgradeTicks *= 2;
+			}
+
+			SetLevel( m_Level + 1 );
+			m_Statistics.Downgrades++;
+			m_Upgraded = false;
+			changed = true;
+		}
+		else if( m_LowTicks >= m_UpgradeTicks && m_Level > 0 )
+		{
+			SetLevel( m_Level - 1 );
+			m_Statistics.Upgrades++;
+			m_Upgraded = true;
+			changed = true;
+
+			// Back at full quality, the load was fine for a long time.
+			if( m_Level == 0 )
+			{
+				m_UpgradeTicks = UpgradeTicks;
+			}
+		}
+
+		if( changed )
+		{
+			m_HighTicks = 0;
+			m_LowTicks = 0;
+		}
+
+		if( m_Level > 0 )
+		{
+			m_Statistics.ReducedTicks++;
+		}
+
+		return changed;
+	}
+
+	const PhysicsQuality & QualityGovernor::GetQuality( ) const
+	{
+		return m_Quality;
+	}
+
+	Bit::Uint32 QualityGovernor::GetLevel( ) const
+	{
+		return m_Level;
+	}
+
+	Bit::Uint32 QualityGovernor::GetLevelCount( ) const
+	{
+		return m_LevelCount;
+	}
+
+	Bit::Float64 QualityGovernor::GetLoad( ) const
+	{
+		return m_Load;
+	}
+
+	const QualityGovernor::Statistics & QualityGovernor::GetStatistics( ) const
+	{
+		return m_Statistics;
+	}
+
+	void QualityGovernor::SetLevel( const Bit::Uint32 p_Level )
+	{
+		m_Level = p_Level;
+		m_Quality.Substeps = Interpolate( m_Maximum.Substeps, m_Minimum.Substeps, m_Level, m_LevelCount );
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,596 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <RollbackClient.hpp>
+#include <Bot.hpp>
+#include <Field.hpp>
+#include <Trace.hpp>
+#include <FramePacer.hpp>
+#include <iostream>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Global functions
+
+	// FNV-1a hash of the settings the peers must agree on.
+	static Bit::Uint32 HashMatch( const ServerSettings & p_Match )
+	{
+		const Bit::Uint32 values[ 4 ] =
+		{
+			static_cast<Bit::Uint32>( p_Match.Mode ),
+			p_Match.Mode == GameMode::MultiBall ? static_cast<Bit::Uint32>( p_Match.BallCount ) : 0,
+			p_Match.Mode == GameMode::MultiBall ? static_cast<Bit::Uint32>( p_Match.ObstacleCount ) : 0,
+			p_Match.Mode == GameMode::MultiBall ? p_Match.Seed : 0
+		};
+
+		Bit::Uint32 hash = 2166136261U;
+		for( Bit::SizeType i = 0; i < 4; i++ )
+		{
+			for( Bit::SizeType j = 0; j < 4; j++ )
+			{
+				hash ^= ( values[ i ] >> ( j * 8 ) ) & 0xFF;
+				hash *= 16777619U;
+			}
+		}
+
+		return hash;
+	}
+
+	// Rollback client class
+	RollbackClient::RollbackClient( const ClientSettings & p_Settings ) :
+		m_Settings( p_Settings ),
+		m_PeerAddress( 0 ),
+		m_PeerPort( 0 ),
+		m_MatchHash( 0 ),
+		m_PeerAck( 0 ),
+		m_PeerTick( 0 ),
+		m_PeerAdvantage( 0 ),
+		m_WaitFrames( 0 ),
+		m_SameSide( false ),
+		m_ChecksumTick( 0 ),
+		m_PeerChecksumTick( 0 ),
+		m_PeerChecksum( 0 ),
+		m_CheckedTick( 0 ),
+		m_Desyncs( 0 ),
+		m_KeyUp( false ),
+		m_KeyDown( false ),
+		m_pWindow( NULL )
+	{
+		m_pPlayerShapes[ 0 ] = NULL;
+		m_pPlayerShapes[ 1 ] = NULL;
+	}
+
+	RollbackClient::~RollbackClient( )
+	{
+		DestroyGraphics( );
+	}
+
+	Bit::Bool RollbackClient::Connect(	const Bit::Uint16 p_Port, const Bit::Uint32 p_PeerAddress,
+										const Bit::Uint16 p_PeerPort, const ServerSettings & p_Match,
+										const Bit::SizeType p_LocalPlayer, const Bit::Time & p_Timeout )
+	{
+		if( m_Socket.Open( p_Port ) == false )
+		{
+			return false;
+		}
+
+		m_PeerAddress = p_PeerAddress;
+		m_PeerPort = p_PeerPort;
+		m_MatchHash = HashMatch( p_Match );
+		m_PeerAck = 0;
+		m_PeerTick = 0;
+		m_PeerAdvantage = 0;
+		m_WaitFrames = 0;
+		m_SameSide = false;
+		m_ChecksumTick = RollbackSession::ChecksumInterval;
+		m_PeerChecksumTick = 0;
+		m_PeerChecksum = 0;
+		m_CheckedTick = 0;
+		m_Desyncs = 0;
+		for( Bit::SizeType i = 0; i < ChecksumHistory; i++ )
+		{
+			m_Checksums[ i ].Tick = 0;
+			m_Checksums[ i ].Value = 0;
+		}
+		m_Session.Create(	p_Match.Mode, p_Match.BallCount, p_Match.ObstacleCount, p_Match.Seed,
+							p_LocalPlayer );
+
+		// Announce this peer until the peer answers, the announcements carry no inputs yet.
+		Bit::Timer timer;
+		timer.Start( );
+		while( timer.GetLapsedTime( ) < p_Timeout )
+		{
+			SendInputs( );
+
+			if( m_Socket.Wait( Bit::Milliseconds( 100 ) ) && ReceiveInputs( ) > 0 )
+			{
+				// Answer at once, the peer may still be waiting.
+				SendInputs( );
+				return true;
+			}
+
+			// Both peers would drive the same paddle and predict the other one.
+			// Announce once more, so the peer refuses too.
+			if( m_SameSide )
+			{
+				SendInputs( );
+				std::cout << "The peer plays the same side." << std::endl;
+				break;
+			}
+		}
+
+		m_Socket.Close( );
+		return false;
+	}
+
+	Bit::Bool RollbackClient::Run( )
+	{
+		// Create graphics, headless clients run the frames without a window.
+		if( m_Settings.Headless == false )
+		{
+			CreateGraphics( );
+		}
+		else
+		{
+			m_HeadlessShapes.resize( 2 + m_Session.GetBallStates( ).GetCount( ) );
+		}
+		Trace::SetThreadName( "Rollback client" );
+
+		// One tick per frame, at the tick rate of the server.
+		FramePacer pacer( 1000000 / RollbackSession::TickInterval );
+		Bit::Timer frameTimer;
+		Bit::Uint64 frame = 0;
+		m_FrameTimes.Reset( );
+		m_FrameCosts.Reset( );
+
+		// Capture the lapsed time.
+		Bit::Timer lapsedTime;
+		lapsedTime.Start( );
+		m_PeerTimer.Start( );
+
+		// Main loop
+		while( m_pWindow == NULL || m_pWindow->IsOpen( ) )
+		{
+			frameTimer.Start( );
+			TraceScope frameTrace( "Frame" );
+
+			if( m_pWindow )
+			{
+				// Update the window
+				{
+					TraceScope trace( "Update" );
+					m_pWindow->Update( );
+				}
+
+				// Handle window events.
+				{
+					TraceScope trace( "PollEvent" );
+					HandleEvents( );
+				}
+
+				// Check again if the window is open
+				if( m_pWindow->IsOpen( ) == false )
+				{
+					break;
+				}
+			}
+
+			// Receive the inputs of the peer.
+			{
+				TraceScope trace( "Receive" );
+				if( ReceiveInputs( ) == 0 && m_PeerTimer.GetLapsedTime( ) > Bit::Milliseconds( PeerTimeout ) )
+				{
+					std::cout << "Lost the peer." << std::endl;
+					break;
+				}
+			}
+
+			// Simulate the next tick, rolling back mispredicted ticks first.
+			// Wait instead when out of predictions, or when further ahead of the peer than the peer is of this peer.
+			{
+				TraceScope trace( "Simulate" );
+				const Bit::Int32 advantage = static_cast<Bit::Int32>( m_Session.GetTick( ) - m_PeerTick );
+				if( m_Session.CanAdvance( ) && advantage - m_PeerAdvantage < 2 )
+				{
+					m_Session.SetLocalInput( GetLocalInput( ) );
+					m_Session.Advance( );
+				}
+				else
+				{
+					m_WaitFrames++;
+				}
+				UpdateChecksums( );
+			}
+
+			// Send the inputs, every frame, so the acknowledgements keep flowing while waiting.
+			{
+				TraceScope trace( "Send" );
+				SendInputs( );
+			}
+
+			// Render the shapes
+			{
+				TraceScope trace( "Draw" );
+				Draw( );
+			}
+
+			// Present the window, graphics.
+			if( m_pWindow )
+			{
+				TraceScope trace( "Present" );
+				m_pWindow->Present( );
+			}
+			m_FrameCosts.Add( frameTimer.GetLapsedTime( ) );
+
+			// Wait for the next frame, the frame time includes the wait.
+			{
+				TraceScope trace( "Pace" );
+				pacer.Wait( );
+			}
+			if( frame > 0 )
+			{
+				m_FrameTimes.Add( pacer.GetFrameTime( ) );
+			}
+
+			// Stop after the given number of frames, if any.
+			frame++;
+			if( m_Settings.FrameCount > 0 && frame >= m_Settings.FrameCount )
+			{
+				break;
+			}
+		}
+
+		lapsedTime.Stop( );
+		const RollbackSession::Statistics & statistics = m_Session.GetStatistics( );
+		std::cout << "Ran rollback match for " << lapsedTime.GetTime( ).AsSeconds( ) << " seconds.\n";
+		std::cout	<< "Rollback: " << statistics.Ticks << " ticks, " << statistics.Rollbacks << " rollbacks, "
+					<< statistics.ResimulatedTicks << " resimulated ticks, at most " << statistics.MaxRollbackTicks
+					<< " ticks, " << m_WaitFrames << " waited frames, " << m_Desyncs << " desyncs.\n";
+		m_FrameTimes.Print( std::cout, "Frame time" );
+		m_FrameCosts.Print( std::cout, "Frame cost" );
+
+		return m_Desyncs == 0;
+	}
+
+	void RollbackClient::SendInputs( )
+	{
+		// Repeat the inputs not yet confirmed by the peer, as many as are in the history.
+		const Bit::Uint32 tick = m_Session.GetTick( );
+		const Bit::Uint32 history = RollbackSession::HistorySize - 1;
+		Bit::Uint32 first = tick > history ? tick - history : 0;
+		first = m_PeerAck > first ? m_PeerAck : first;
+		first = first < tick ? first : tick;
+
+		m_Packet.Clear( );
+		m_Packet.WriteUint32( Magic );
+		m_Packet.WriteUint32( m_MatchHash );
+		m_Packet.WriteByte( static_cast<Bit::Uint8>( m_Session.GetLocalPlayer( ) ) );
+		m_Packet.WriteUint32( tick );
+		m_Packet.WriteInt( static_cast<Bit::Int32>( tick - m_PeerTick ) );
+		m_Packet.WriteUint32( m_Session.GetRemoteTick( ) );
+
+		// The latest local checksum, tick 0 if none yet.
+		const Bit::Uint32 checksumTick = m_ChecksumTick - RollbackSession::ChecksumInterval;
+		m_Packet.WriteUint32( checksumTick );
+		m_Packet.WriteUint32( checksumTick > 0 ? m_Checksums[ ( checksumTick / RollbackSession::ChecksumInterval ) % ChecksumHistory ].Value : 0 );
+
+		m_Packet.WriteUint32( first );
+		m_Packet.WriteByte( static_cast<Bit::Uint8>( tick - first ) );
+		for( Bit::Uint32 i = first; i < tick; i++ )
+		{
+			m_Packet.WriteByte( m_Session.GetLocalInput( i ) );
+		}
+
+		m_Socket.Queue( m_PeerAddress, m_PeerPort, m_Packet.GetData( ), m_Packet.GetSize( ) );
+		m_Socket.Flush( );
+	}
+
+	Bit::SizeType RollbackClient::ReceiveInputs( )
+	{
+		Bit::SizeType received = 0;
+		Bit::SizeType count = 0;
+
+		while( ( count = m_Socket.Receive( ) ) > 0 )
+		{
+			for( Bit::SizeType i = 0; i < count; i++ )
+			{
+				const DatagramSocket::Datagram & datagram = m_Socket.GetReceived( i );
+				if( datagram.Address != m_PeerAddress || datagram.Port != m_PeerPort )
+				{
+					continue;
+				}
+
+				m_Packet.Assign( datagram.Data, datagram.Size );
+				if( m_Packet.ReadUint32( ) != Magic || m_Packet.ReadUint32( ) != m_MatchHash )
+				{
+					continue;
+				}
+
+				const Bit::Uint8 player = m_Packet.ReadByte( );
+				const Bit::Uint32 tick = m_Packet.ReadUint32( );
+				const Bit::Int32 advantage = m_Packet.ReadInt( );
+				const Bit::Uint32 ack = m_Packet.ReadUint32( );
+				const Bit::Uint32 checksumTick = m_Packet.ReadUint32( );
+				const Bit::Uint32 checksum = m_Packet.ReadUint32( );
+				const Bit::Uint32 first = m_Packet.ReadUint32( );
+				const Bit::Uint8 inputCount = m_Packet.ReadByte( );
+				if( m_Packet.IsValid( ) == false || m_Packet.GetRemainingSize( ) < inputCount )
+				{
+					continue;
+				}
+				if( player == m_Session.GetLocalPlayer( ) )
+				{
+					m_SameSide = true;
+					continue;
+				}
+				if( checksumTick > m_PeerChecksumTick )
+				{
+					m_PeerChecksumTick = checksumTick;
+					m_PeerChecksum = checksum;
+				}
+
+				// Datagrams may come out of order, keep the latest.
+				if( tick >= m_PeerTick )
+				{
+					m_PeerTick = tick;
+					m_PeerAdvantage = advantage;
+				}
+				if( ack > m_PeerAck && ack <= m_Session.GetTick( ) )
+				{
+					m_PeerAck = ack;
+				}
+
+				// Inputs already confirmed or past a lost datagram are ignored by the session.
+				for( Bit::Uint32 j = 0; j < inputCount; j++ )
+				{
+					m_Session.AddRemoteInput( first + j, m_Packet.ReadByte( ) );
+				}
+
+				m_PeerTimer.Start( );
+				received++;
+			}
+		}
+
+		return received;
+	}
+
+	void RollbackClient::UpdateChecksums( )
+	{
+		Bit::Uint32 value = 0;
+		while( m_Session.GetChecksum( m_ChecksumTick, value ) )
+		{
+			Checksum & checksum = m_Checksums[ ( m_ChecksumTick / RollbackSession::ChecksumInterval ) % ChecksumHistory ];
+			checksum.Tick = m_ChecksumTick;
+			checksum.Value = value;
+			m_ChecksumTick += RollbackSession::ChecksumInterval;
+		}
+
+		// Compare once both peers have the checksum of the tick, a tick out of the history is skipped.
+		if( m_PeerChecksumTick <= m_CheckedTick )
+		{
+			return;
+		}
+		const Checksum & checksum = m_Checksums[ ( m_PeerChecksumTick / RollbackSession::ChecksumInterval ) % ChecksumHistory ];
+		if( checksum.Tick != m_PeerChecksumTick )
+		{
+			return;
+		}
+
+		if( checksum.Value != m_PeerChecksum )
+		{
+			m_Desyncs++;
+			std::cout << "Desync at tick " << m_PeerChecksumTick << ", the peers simulated different states." << std::endl;
+		}
+		m_CheckedTick = m_PeerChecksumTick;
+	}
+
+	RollbackSession::eInput RollbackClient::GetLocalInput( )
+	{
+		// Headless peers are played by a bot.
+		if( m_pWindow == NULL )
+		{
+			const PlayerStates & players = m_Session.GetPlayerStates( );
+			const BallStates & balls = m_Session.GetBallStates( );
+			const Bit::SizeType player = m_Session.GetLocalPlayer( );
+
+			bool isMoving = false;
+			eDirection direction = eDirection::Up;
+			const Bit::Float32 target = Bot::FindTarget( balls, 0, balls.GetCount( ), players.PositionX[ player ] );
+			Bot::Think( players.PositionY[ player ], target, isMoving, direction );
+
+			if( isMoving == false )
+			{
+				return RollbackSession::Stop;
+			}
+			return direction == eDirection::Up ? RollbackSession::MoveUp : RollbackSession::MoveDown;
+		}
+
+		if( m_KeyUp == m_KeyDown )
+		{
+			return RollbackSession::Stop;
+		}
+		return m_KeyUp ? RollbackSession::MoveUp : RollbackSession::MoveDown;
+	}
+
+	void RollbackClient::HandleEvents( )
+	{
+		Bit::Event wEvent;
+		while( m_pWindow->PollEvent( wEvent ) )
+		{
+			// Check the window envent.
+			switch( wEvent.Type )
+			{
+				// Key press events
+				case Bit::Event::KeyJustPressed:
+				{
+					if( wEvent.Key == Bit::Keyboard::W )
+					{
+						m_KeyUp = true;
+					}
+					else if( wEvent.Key == Bit::Keyboard::S )
+					{
+						m_KeyDown = true;
+					}
+				}
+				break;
+				case Bit::Event::KeyJustReleased:
+				{
+					if( wEvent.Key == Bit::Keyboard::W )
+					{
+						m_KeyUp = false;
+					}
+					else if( wEvent.Key == Bit::Keyboard::S )
+					{
+						m_KeyDown = false;
+					}
+					else if( wEvent.Key == Bit::Keyboard::Num2 )
+					{
+						m_pWindow->Close( );
+					}
+				}
+				break;
+				case Bit::Event::Closed:
+				{
+					m_pWindow->Close( );
+				}
+				break;
+
+			default:
+				break;
+			}
+
+		}
+	}
+
+	void RollbackClient::Draw( )
+	{
+		const PlayerStates & players = m_Session.GetPlayerStates( );
+		const BallStates & balls = m_Session.GetBallStates( );
+
+		// Headless clients transform the shapes without drawing them.
+		if( m_pWindow == NULL )
+		{
+			for( Bit::SizeType i = 0; i < 2; i++ )
+			{
+				m_HeadlessShapes[ i ].Position = Bit::Vector2f32( players.PositionX[ i ], players.PositionY[ i ] ) * 100.0f;
+				m_HeadlessShapes[ i ].Rotation = 0.0f;
+			}
+			for( Bit::SizeType i = 0; i + 2 < m_HeadlessShapes.size( ); i++ )
+			{
+				m_HeadlessShapes[ i + 2 ].Position = Bit::Vector2f32( balls.PositionX[ i ], balls.PositionY[ i ] ) * 100.0f;
+				m_HeadlessShapes[ i + 2 ].Rotation = static_cast<Bit::Float32>( balls.Rotation[ i ] );
+			}
+			return;
+		}
+
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			m_pPlayerShapes[ i ]->SetPosition( Bit::Vector2f32( players.PositionX[ i ], players.PositionY[ i ] ) * 100.0f );
+			m_pWindow->Draw( m_pPlayerShapes[ i ], Bit::PrimitiveMode::LineStrip );
+		}
+		for( Bit::SizeType i = 0; i < m_BallShapes.size( ); i++ )
+		{
+			m_BallShapes[ i ]->SetPosition( Bit::Vector2f32( balls.PositionX[ i ], balls.PositionY[ i ] ) * 100.0f );
+			m_BallShapes[ i ]->SetRotation( Bit::Radians( balls.Rotation[ i ] ) );
+			m_pWindow->Draw( m_BallShapes[ i ], Bit::PrimitiveMode::LineStrip );
+		}
+		for( Bit::SizeType i = 0; i < m_ObstacleShapes.size( ); i++ )
+		{
+			m_pWindow->Draw( m_ObstacleShapes[ i ], Bit::PrimitiveMode::LineStrip );
+		}
+	}
+
+	Bit::Bool RollbackClient::CreateGraphics( )
+	{
+		const PlayerStates & players = m_Session.GetPlayerStates( );
+		const BallStates & balls = m_Session.GetBallStates( );
+
+		// Create the window
+		m_pWindow = new Bit::SimpleRenderWindow( Bit::VideoMode( Bit::Vector2u32( 600, 300 ) ) );
+
+		// Create the shapes
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			m_pPlayerShapes[ i ] = m_pWindow->CreateRectangleShape( );
+			m_pPlayerShapes[ i ]->SetPosition( Bit::Vector2f32( players.PositionX[ i ], players.PositionY[ i ] ) * 100.0f );
+			m_pPlayerShapes[ i ]->SetSize( Bit::Vector2f32( Field::PlayerWidth, Field::PlayerHeight ) * 100.0f );
+		}
+
+		// Fewer segments for the small balls of the multi-ball mode.
+		const Bit::Uint32 segments = m_Session.GetMode( ) == GameMode::MultiBall ? 8 : 30;
+		m_BallShapes.resize( balls.GetCount( ), NULL );
+		for( Bit::SizeType i = 0; i < m_BallShapes.size( ); i++ )
+		{
+			m_BallShapes[ i ] = m_pWindow->CreateCircleShape( segments );
+			m_BallShapes[ i ]->SetPosition( Bit::Vector2f32( balls.PositionX[ i ], balls.PositionY[ i ] ) * 100.0f );
+			m_BallShapes[ i ]->SetSize( Bit::Vector2f32( balls.Radius[ i ], balls.Radius[ i ] ) * 100.0f );
+		}
+
+		// Create the obstacle shapes, positioned by their centers like the players.
+		if( m_Session.GetMode( ) == GameMode::MultiBall )
+		{
+			const Obstacles & obstacles = m_Session.GetObstacles( );
+			m_ObstacleShapes.resize( obstacles.MinX.size( ), NULL );
+			for( Bit::SizeType i = 0; i < m_ObstacleShapes.size( ); i++ )
+			{
+				const Bit::Vector2f32 min( obstacles.MinX[ i ], obstacles.MinY[ i ] );
+				const Bit::Vector2f32 max( obstacles.MaxX[ i ], obstacles.MaxY[ i ] );
+				m_ObstacleShapes[ i ] = m_pWindow->CreateRectangleShape( );
+				m_ObstacleShapes[ i ]->SetPosition( ( min + max ) * 50.0f );
+				m_ObstacleShapes[ i ]->SetSize( ( max - min ) * 100.0f );
+			}
+		}
+
+		return true;
+	}
+
+	void RollbackClient::DestroyGraphics( )
+	{
+		if( m_pWindow )
+		{
+			for( Bit::SizeType i = 0; i < 2; i++ )
+			{
+				if( m_pPlayerShapes[ i ] )
+				{
+					m_pWindow->DestroyShape( m_pPlayerShapes[ i ] );
+				}
+			}
+			for( Bit::SizeType i = 0; i < m_BallShapes.size( ); i++ )
+			{
+				m_pWindow->DestroyShape( m_BallShapes[ i ] );
+			}
+			m_BallShapes.clear( );
+			for( Bit::SizeType i = 0; i < m_ObstacleShapes.size( ); i++ )
+			{
+				m_pWindow->DestroyShape( m_ObstacleShapes[ i ] );
+			}
+			m_ObstacleShapes.clear( );
+
+			delete m_pWindow;
+			m_pWindow = NULL;
+		}
+	}
+
+}
\ No newline at end of file
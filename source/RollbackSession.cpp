@@ -0,0 +1,277 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <RollbackSession.hpp>
+#include <cstring>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Global variables
+	static const Bit::Uint32 NoRollback = 0xFFFFFFFF;
+
+	// Statistics structure
+	RollbackSession::Statistics::Statistics( ) :
+		Ticks( 0 ),
+		Rollbacks( 0 ),
+		ResimulatedTicks( 0 ),
+		MaxRollbackTicks( 0 )
+	{
+	}
+
+	// Rollback session class
+	RollbackSession::RollbackSession( ) :
+		m_Mode( GameMode::Classic ),
+		m_LocalPlayer( 0 ),
+		m_Tick( 0 ),
+		m_RemoteTick( 0 ),
+		m_RollbackTick( NoRollback ),
+		m_LocalInput( Stop )
+	{
+		std::memset( m_Inputs, 0, sizeof( m_Inputs ) );
+	}
+
+	void RollbackSession::Create(	const GameMode::eMode p_Mode, const Bit::SizeType p_BallCount,
+									const Bit::SizeType p_ObstacleCount, const Bit::Uint32 p_Seed,
+									const Bit::SizeType p_LocalPlayer )
+	{
+		m_Mode = p_Mode;
+		if( m_Mode == GameMode::MultiBall )
+		{
+			m_MultiBallMatch.Create( p_BallCount, p_ObstacleCount, p_Seed );
+		}
+		else
+		{
+			m_Matches.Create( 1 );
+		}
+
+		m_LocalPlayer = p_LocalPlayer ? 1 : 0;
+		m_Tick = 0;
+		m_RemoteTick = 0;
+		m_RollbackTick = NoRollback;
+		m_LocalInput = Stop;
+		std::memset( m_Inputs, 0, sizeof( m_Inputs ) );
+		m_Statistics = Statistics( );
+
+		// The states are of the same size, reserve them up front so saving never allocates.
+		SaveState( 0 );
+		for( Bit::SizeType i = 1; i < HistorySize; i++ )
+		{
+			m_States[ i ].Reserve( m_States[ 0 ].GetSize( ) );
+		}
+	}
+
+	Bit::Bool RollbackSession::CanAdvance( ) const
+	{
+		return m_Tick < m_RemoteTick + MaxPrediction;
+	}
+
+	void RollbackSession::SetLocalInput( const eInput p_Input )
+	{
+		m_LocalInput = static_cast<Bit::Uint8>( p_Input );
+	}
+
+	Bit::Bool RollbackSession::AddRemoteInput( const Bit::Uint32 p_Tick, const Bit::Uint8 p_Input )
+	{
+		// The peer never runs further ahead than it may predict this peer.
+		if( p_Tick != m_RemoteTick || p_Tick > m_Tick + MaxPrediction || p_Input > MoveDown )
+		{
+			return false;
+		}
+
+		// Simulated ticks hold the predicted input, roll back to the earliest wrong one.
+		Bit::Uint8 & input = m_Inputs[ 1 - m_LocalPlayer ][ p_Tick % HistorySize ];
+		if( p_Tick < m_Tick && input != p_Input && p_Tick < m_RollbackTick )
+		{
+			m_RollbackTick = p_Tick;
+		}
+
+		input = p_Input;
+		m_RemoteTick++;
+		return true;
+	}
+
+	void RollbackSession::Advance( )
+	{
+		// Restore the state before the earliest misprediction and simulate the ticks since.
+		if( m_RollbackTick < m_Tick )
+		{
+			const Bit::Uint32 ticks = m_Tick - m_RollbackTick;
+
+			LoadState( m_RollbackTick );
+			for( Bit::Uint32 tick = m_RollbackTick; tick < m_Tick; tick++ )
+			{
+				Simulate( tick );
+			}
+
+			m_Statistics.Rollbacks++;
+			m_Statistics.ResimulatedTicks += ticks;
+			if( ticks > m_Statistics.MaxRollbackTicks )
+			{
+				m_Statistics.MaxRollbackTicks = ticks;
+			}
+		}
+		m_RollbackTick = NoRollback;
+
+		m_Inputs[ m_LocalPlayer ][ m_Tick % HistorySize ] = m_LocalInput;
+		Simulate( m_Tick );
+		m_Tick++;
+		m_Statistics.Ticks++;
+	}
+
+	Bit::Uint32 RollbackSession::GetTick( ) const
+	{
+		return m_Tick;
+	}
+
+	Bit::Uint32 RollbackSession::GetRemoteTick( ) const
+	{
+		return m_RemoteTick;
+	}
+
+	Bit::Bool RollbackSession::GetChecksum( const Bit::Uint32 p_Tick, Bit::Uint32 & p_Checksum ) const
+	{
+		if( p_Tick > m_RemoteTick || p_Tick > m_Tick || p_Tick + HistorySize <= m_Tick || m_RollbackTick != NoRollback )
+		{
+			return false;
+		}
+
+		// Fowler-Noll-Vo hash of the saved state.
+		const Packet & state = m_States[ p_Tick % HistorySize ];
+		const Bit::Uint8 * pData = state.GetData( );
+		Bit::Uint32 hash = 2166136261U;
+		for( Bit::SizeType i = 0; i < state.GetSize( ); i++ )
+		{
+			hash ^= pData[ i ];
+			hash *= 16777619U;
+		}
+
+		p_Checksum = hash;
+		return true;
+	}
+
+	Bit::Uint8 RollbackSession::GetLocalInput( const Bit::Uint32 p_Tick ) const
+	{
+		return m_Inputs[ m_LocalPlayer ][ p_Tick % HistorySize ];
+	}
+
+	Bit::SizeType RollbackSession::GetLocalPlayer( ) const
+	{
+		return m_LocalPlayer;
+	}
+
+	GameMode::eMode RollbackSession::GetMode( ) const
+	{
+		return m_Mode;
+	}
+
+	const BallStates & RollbackSession::GetBallStates( ) const
+	{
+		return m_Mode == GameMode::MultiBall ? m_MultiBallMatch.GetBallStates( ) : m_Matches.GetBallStates( );
+	}
+
+	const PlayerStates & RollbackSession::GetPlayerStates( ) const
+	{
+		return m_Mode == GameMode::MultiBall ? m_MultiBallMatch.GetPlayerStates( ) : m_Matches.GetPlayerStates( );
+	}
+
+	const Obstacles & RollbackSession::GetObstacles( ) const
+	{
+		return m_MultiBallMatch.GetObstacles( );
+	}
+
+	const RollbackSession::Statistics & RollbackSession::GetStatistics( ) const
+	{
+		return m_Statistics;
+	}
+
+	void RollbackSession::Simulate( const Bit::Uint32 p_Tick )
+	{
+		// Predict the remote player to keep the last confirmed input.
+		const Bit::SizeType remotePlayer = 1 - m_LocalPlayer;
+		if( p_Tick >= m_RemoteTick )
+		{
+			m_Inputs[ remotePlayer ][ p_Tick % HistorySize ] =
+				m_RemoteTick > 0 ? m_Inputs[ remotePlayer ][ ( m_RemoteTick - 1 ) % HistorySize ] : static_cast<Bit::Uint8>( Stop );
+		}
+
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			const Bit::Uint8 input = m_Inputs[ i ][ p_Tick % HistorySize ];
+			const Bit::Bool isMoving = input != Stop;
+			const eDirection direction = input == MoveUp ? eDirection::Up : eDirection::Down;
+
+			if( m_Mode == GameMode::MultiBall )
+			{
+				m_MultiBallMatch.SetPlayerInput( i, isMoving, direction );
+			}
+			else
+			{
+				m_Matches.SetPlayerInput( 0, i, isMoving, direction );
+			}
+		}
+
+		if( m_Mode == GameMode::MultiBall )
+		{
+			m_MultiBallMatch.Step( Bit::Microseconds( TickInterval ) );
+		}
+		else
+		{
+			m_Matches.Step( Bit::Microseconds( TickInterval ) );
+		}
+
+		SaveState( p_Tick + 1 );
+	}
+
+	void RollbackSession::SaveState( const Bit::Uint32 p_Tick )
+	{
+		Packet & state = m_States[ p_Tick % HistorySize ];
+		state.Clear( );
+
+		if( m_Mode == GameMode::MultiBall )
+		{
+			m_MultiBallMatch.SaveState( state );
+		}
+		else
+		{
+			m_Matches.SaveState( state );
+		}
+	}
+
+	void RollbackSession::LoadState( const Bit::Uint32 p_Tick )
+	{
+		Packet & state = m_States[ p_Tick % HistorySize ];
+		state.Rewind( );
+
+		if( m_Mode == GameMode::MultiBall )
+		{
+			m_MultiBallMatch.LoadState( state );
+		}
+		else
+		{
+			m_Matches.LoadState( state );
+		}
+	}
+
+}
\ No newline at end of file
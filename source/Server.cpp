@@ -22,9 +22,17 @@
 // ///////////////////////////////////////////////////////////////////////////
 
 #include <Server.hpp>
+#include <MessageType.hpp>
+#include <Snapshot.hpp>
+#include <EntitySchema.hpp>
+#include <Trace.hpp>
+#include <Bot.hpp>
+#include <Field.hpp>
 #include <iostream>
+#include <sstream>
 #include <Bit/System/Sleep.hpp>
 #include <Bit/System/Timestep.hpp>
+#include <Bit/System/Timer.hpp>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Pong
@@ -43,66 +51,255 @@ namespace Pong
 
 		virtual void HandleMessage( Bit::Net::UserMessageDecoder & p_Message )
 		{
-			// Error check the user id.
-			if( p_Message.GetUser( ) > 1 )
+			TraceScope trace( "PlayerMessageListener::HandleMessage" );
+
+			// Error check the message size, the direction of moves, the tick and the offset.
+			const Bit::Bool move = p_Message.GetName( ) == "Move";
+			const Bit::SizeType size = move ? 9 : 8;
+			if( p_Message.GetMessageSize( ) < size )
+			{
+				return;
+			}
+
+			Bit::Uint8 data[ 9 ];
+			p_Message.ReadArray( data, size );
+			Packet message;
+			message.Assign( data, size );
+
+			m_pServer->QueueInput( p_Message.GetUser( ), move, message );
+		}
+
+		Server * m_pServer;
+
+	};
+
+
+	// Join user message, the first message of a client, answered with the baseline.
+	class JoinMessageListener : public Bit::Net::UserMessageListener
+	{
+
+	public:
+
+		JoinMessageListener( Server * p_pServer ) :
+			m_pServer( p_pServer )
+		{
+		}
+
+		virtual void HandleMessage( Bit::Net::UserMessageDecoder & p_Message )
+		{
+			TraceScope trace( "JoinMessageListener::HandleMessage" );
+
+			// Error check the message size, the resume token.
+			if( p_Message.GetMessageSize( ) < 8 )
 			{
 				return;
 			}
 
-			// Move message
-			if( p_Message.GetName( ) == "Move" )
+			// Clients hosted by this process add a flag, to pass the messages of the match in-process.
+			Bit::Uint8 data[ 9 ] = { 0 };
+			const Bit::SizeType size = p_Message.GetMessageSize( ) < sizeof( data ) ? 8 : sizeof( data );
+			p_Message.ReadArray( data, size );
+			Packet join;
+			join.Assign( data, size );
+
+			Server::Join pendingJoin;
+			pendingJoin.UserId = p_Message.GetUser( );
+			pendingJoin.Token = join.ReadUint64( );
+			pendingJoin.Local = join.ReadByte( ) == 1 && join.IsValid( );
+
+			// The joins are accepted by the tick, the baseline needs the states of a finished tick.
+			m_pServer->m_JoinMutex.Lock( );
+			if( m_pServer->m_Joins.size( ) < m_pServer->m_Joins.capacity( ) )
 			{
-				// Get the player
-				Player * pPlayer = m_pServer->m_pPlayers[ p_Message.GetUser( ) ];
+				m_pServer->m_Joins.push_back( pendingJoin );
+			}
+			m_pServer->m_JoinMutex.Unlock( );
+		}
+
+		Server * m_pServer;
+
+	};
 
-				// Read the direction
-				eDirection direction = static_cast<eDirection>(p_Message.ReadByte());
+	// Time sync user message, answered with the next batch.
+	class PingMessageListener : public Bit::Net::UserMessageListener
+	{
+
+	public:
+
+		PingMessageListener( Server * p_pServer ) :
+			m_pServer( p_pServer )
+		{
+		}
+
+		virtual void HandleMessage( Bit::Net::UserMessageDecoder & p_Message )
+		{
+			TraceScope trace( "PingMessageListener::HandleMessage" );
 
-				// Set direction and if the player is moving
-				pPlayer->Direction = direction;
-				pPlayer->IsMoving = true;
+			// Error check the message size, sequence and client send time.
+			if( p_Message.GetMessageSize( ) < 12 )
+			{
+				return;
 			}
-			else if (p_Message.GetName() == "StopMove")
+
+			Bit::Uint8 data[ 12 ];
+			p_Message.ReadArray( data, sizeof( data ) );
+			Packet ping;
+			ping.Assign( data, sizeof( data ) );
+
+			m_pServer->QueuePing( p_Message.GetUser( ), ping );
+		}
+
+		Server * m_pServer;
+
+	};
+
+	// Snapshot acknowledgement user message, drives the snapshot rate of the user.
+	class SnapshotAckMessageListener : public Bit::Net::UserMessageListener
+	{
+
+	public:
+
+		SnapshotAckMessageListener( Server * p_pServer ) :
+			m_pServer( p_pServer )
+		{
+		}
+
+		virtual void HandleMessage( Bit::Net::UserMessageDecoder & p_Message )
+		{
+			TraceScope trace( "SnapshotAckMessageListener::HandleMessage" );
+
+			// Error check the message size, newest sequence and the bits of the previous ones.
+			if( p_Message.GetMessageSize( ) < 8 )
 			{
-				Player * pPlayer = m_pServer->m_pPlayers[p_Message.GetUser()];
-				pPlayer->IsMoving = false;
+				return;
 			}
 
+			Bit::Uint8 data[ 8 ];
+			p_Message.ReadArray( data, sizeof( data ) );
+			Packet ack;
+			ack.Assign( data, sizeof( data ) );
+
+			m_pServer->AckSnapshot( p_Message.GetUser( ), ack );
 		}
 
 		Server * m_pServer;
 
 	};
 
+	Server::TickStatistics::TickStatistics( ) :
+		Ticks( 0 ),
+		Overruns( 0 ),
+		MaxTickTime( Bit::Time::Zero ),
+		TotalTickTime( Bit::Time::Zero ),
+		QualityLevel( 0 ),
+		QualityDowngrades( 0 ),
+		QualityUpgrades( 0 ),
+		ReducedQualityTicks( 0 ),
+		SkippedStates( 0 ),
+		CoalescedFrames( 0 ),
+		DroppedFrames( 0 )
+	{
+	}
 
-	Server::Server( ) :
-		m_pBall( NULL )
+	Server::Server( const ServerSettings & p_Settings ) :
+		m_Settings( p_Settings ),
+		m_MessageBatcher( p_Settings.Mtu ),
+		m_Balls( m_EntityManager, "Ball" ),
+		m_Players( m_EntityManager, "Player" ),
+		m_pBall( NULL ),
+		m_AllocationReport( "Server tick", p_Settings.AllocationCheck, 120 ),
+		m_ClockOffset( 0 ),
+		m_Tick( 0 ),
+		m_TickTime( 0 ),
+		m_QueuedFrameCount( 0 ),
+		m_QueuedLocalUserId( -1 ),
+		m_QueuedLocalFrameCount( 0 ),
+		m_Port( 0 ),
+		m_PendingLocalUserId( -1 )
 	{
-		// Link and register ball class
-		m_EntityManager.LinkEntity<Ball>( "Ball" );
-		m_EntityManager.RegisterVariable( "Ball",	"Position",		&Ball::Position);
-		m_EntityManager.RegisterVariable( "Ball",	"Rotation",		&Ball::Rotation);
-		m_EntityManager.RegisterVariable( "Ball",	"Size",			&Ball::Size );
-		m_EntityManager.RegisterVariable( "Ball",	"Direction",	&Ball::Direction );
+		// Start the server clock, time sync replies are stamped with it.
+		m_Clock.Start( );
+		m_Pings.reserve( 64 );
+		m_Inputs.reserve( MaxQueuedInputs * 2 );
+		m_StopRequested = false;
+		m_Draining = false;
+		m_SummaryRequested = false;
+		m_LocalUserId = -1;
+		m_OverflowUserId = -1;
+
+		// Start at the maximum physics quality, lowered under load.
+		m_QualityGovernor.Create( m_Settings.MaxPhysicsQuality, m_Settings.MinPhysicsQuality );
+		m_Matches.SetPhysicsQuality( m_QualityGovernor.GetQuality( ) );
+		m_InputVelocities[ 0 ] = m_InputVelocities[ 1 ] = 0.0f;
+		m_Joins.reserve( 16 );
+
+		// The frame queues never grow, a frame of a full queue is coalesced.
+		m_QueuedFrames.resize( MaxQueuedFrames );
+		m_SendingFrames.resize( MaxQueuedFrames );
+		for( Bit::SizeType i = 0; i < MaxQueuedFrames; i++ )
+		{
+			m_QueuedFrames[ i ].Frame.Reserve( m_Settings.Mtu );
+			m_SendingFrames[ i ].Frame.Reserve( m_Settings.Mtu );
+		}
+
+		// All slots start free, the resume tokens are unpredictable.
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			m_Slots[ i ].Connected = false;
+			m_Slots[ i ].Reserved = false;
+			m_Slots[ i ].UserId = 0;
+			m_Slots[ i ].Token = 0;
+			m_Slots[ i ].DisconnectTime = 0;
+		}
+		std::random_device randomDevice;
+		m_TokenGenerator.seed( ( static_cast<Bit::Uint64>( randomDevice( ) ) << 32 ) ^ randomDevice( ) ^ GetTime( ) );
 
-		// Link and register player class
-		m_EntityManager.LinkEntity<Player>( "Player" );
-		m_EntityManager.RegisterVariable( "Player", "Position", &Player::Position );
-		m_EntityManager.RegisterVariable( "Player", "Size",		&Player::Size );
+		// Snapshot limits of every client, in ticks between snapshots.
+		const Bit::Uint32 tickRate = 1000000 / TickInterval;
+		const Bit::Uint32 maxRate = m_Settings.SnapshotMaxRate > 0 ? m_Settings.SnapshotMaxRate : 1;
+		const Bit::Uint32 minRate = m_Settings.SnapshotMinRate > 0 ? m_Settings.SnapshotMinRate : 1;
+		m_SnapshotLimits.TickRate = tickRate;
+		m_SnapshotLimits.MinInterval = maxRate < tickRate ? tickRate / maxRate : 1;
+		m_SnapshotLimits.MaxInterval = minRate < tickRate ? tickRate / minRate : 1;
+		m_SnapshotLimits.MaxInterval = m_SnapshotLimits.MaxInterval > m_SnapshotLimits.MinInterval ? m_SnapshotLimits.MaxInterval : m_SnapshotLimits.MinInterval;
+		m_SnapshotLimits.MinBandwidth = m_Settings.ClientMinBandwidth;
+		m_SnapshotLimits.MaxBandwidth = m_Settings.ClientMaxBandwidth > m_Settings.ClientMinBandwidth ? m_Settings.ClientMaxBandwidth : m_Settings.ClientMinBandwidth;
+
+		// Link and register the entity classes of the shared schema.
+		Schema::Register( m_EntityManager );
 
 		// Create a ball
-		m_pBall = reinterpret_cast<Ball *>( m_EntityManager.CreateEntityByName( "Ball" ) );
-		m_pBall->Position.Set( Bit::Vector2f32( 3.0f, 1.50f ) );
-		m_pBall->Size.Set( Bit::Vector2f32( 0.20f, 0.20f ) );
+		m_pBall = m_Balls.Create( );
+		m_pBall->Position.Set( Bit::Vector2f32( Field::Width * 0.5f, Field::Height * 0.5f ) );
+		m_pBall->Size.Set( Bit::Vector2f32( Field::BallRadius, Field::BallRadius ) );
 		m_pBall->Direction.Set( Bit::Vector2f32( 1.0f, 0.0f ) );
 
+		// Create the rest of the balls of the multi-ball mode.
+		if( m_Settings.Mode == GameMode::MultiBall )
+		{
+			m_pBall->Size.Set( Bit::Vector2f32( Field::SmallBallRadius, Field::SmallBallRadius ) );
+
+			for( Bit::SizeType i = 1; i < m_Settings.BallCount; i++ )
+			{
+				Ball * pBall = m_Balls.Create( );
+				pBall->Size.Set( Bit::Vector2f32( Field::SmallBallRadius, Field::SmallBallRadius ) );
+			}
+		}
+
 		// Create the players
-		m_pPlayers[ 0 ] = reinterpret_cast<Player *>( m_EntityManager.CreateEntityByName( "Player" ) );
-		m_pPlayers[ 0 ]->Position.Set( Bit::Vector2f32( 0.50f, 1.50f ) );
-		m_pPlayers[ 0 ]->Size.Set( Bit::Vector2f32( 0.20f, 0.64f ) );
-		m_pPlayers[ 1 ] = reinterpret_cast<Player *>( m_EntityManager.CreateEntityByName( "Player" ) );
-		m_pPlayers[ 1 ]->Position.Set( Bit::Vector2f32( 5.50f, 1.50f ) );
-		m_pPlayers[1]->Size.Set(Bit::Vector2f32(0.20f, 0.64f));
+		m_pPlayers[ 0 ] = m_Players.Create( );
+		m_pPlayers[ 0 ]->Position.Set( Bit::Vector2f32( Field::PlayerOffset, Field::Height * 0.5f ) );
+		m_pPlayers[ 0 ]->Size.Set( Bit::Vector2f32( Field::PlayerWidth, Field::PlayerHeight ) );
+		m_pPlayers[ 1 ] = m_Players.Create( );
+		m_pPlayers[ 1 ]->Position.Set( Bit::Vector2f32( Field::Width - Field::PlayerOffset, Field::Height * 0.5f ) );
+		m_pPlayers[ 1 ]->Size.Set( Bit::Vector2f32( Field::PlayerWidth, Field::PlayerHeight ) );
+
+		// Size the published states up front, the tick only copies into them.
+		PublishedState state;
+		state.Tick = 0;
+		state.Balls.Resize( m_Balls.GetCount( ) );
+		state.Players.Resize( 2 );
+		m_PublishedStates.Reset( state );
 	}
 
 	Server::~Server( )
@@ -110,53 +307,64 @@ namespace Pong
 		// Stop the server
 		Stop( );
 		m_MainThread.Finish( );
+		m_SendThread.Finish( );
+		m_ControlThread.Finish( );
 
-		// Delete the ball
-		if( m_pBall )
-		{
-			delete m_pBall;
-		}
+		// Destroy the matches, the entity stores delete the balls and the players.
+		DestroyMatches( );
 	}
 
 	Bit::Bool Server::Host( const Bit::Uint16 p_Port )
 	{
-		// Start the server
-		if (Start(p_Port, 2, 24, "NetPong") == false)
+		// Take over the matches of the running server, which stops and frees the port.
+		if( m_Settings.Takeover && TakeOver( ) == false )
+		{
+			std::cout << "No checkpoint to take over, starting new matches." << std::endl;
+		}
+
+		// Start the server, retry while the previous server closes its socket.
+		const Bit::SizeType startAttempts = m_Settings.Takeover ? 40 : 1;
+		Bit::Bool started = false;
+		for( Bit::SizeType i = 0; i < startAttempts && started == false; i++ )
+		{
+			if( i > 0 )
+			{
+				Bit::Sleep( Bit::Milliseconds( 50 ) );
+			}
+			started = Start(p_Port, 2, 24, Schema::GetIdentifier( ));
+		}
+		if( started == false )
 		{
 			return false;
 		}
+		m_Port = p_Port;
 
 		// Start the main thread
 		m_MainThread.Execute( [ this ] ( )
 		{
-			Bit::Keyboard keyboard;
+			Trace::SetThreadName( "Server tick" );
 			PlayerMessageListener playerMessageListener( this );
+			JoinMessageListener joinMessageListener( this );
+			PingMessageListener pingMessageListener( this );
+			SnapshotAckMessageListener snapshotAckMessageListener( this );
 
 			// Hook the user message
 			HookUserMessage(&playerMessageListener, "Move");
 			HookUserMessage(&playerMessageListener, "StopMove");
+			HookUserMessage(&joinMessageListener, "Join");
+			HookUserMessage(&pingMessageListener, "TimeSync");
+			HookUserMessage(&snapshotAckMessageListener, "SnapshotAck");
 
-			// Set up the scene
-			// Create a physic shape
-			Bit::Phys2::Circle circle(m_pBall->Size.Get().x);
-			Bit::Phys2::Rectangle rectangle(Bit::Vector2f32( m_pPlayers[ 0 ]->Size.Get() ) );
-
-			// Clear and create the bodies.
-			m_Scene.Clear();
+			// Create the matches, the first match is played by the connected users.
+			CreateMatches( );
+			RestoreCheckpoint( );
 
-			// Add players and ball bodies
-			m_pBodies[0] = m_Scene.Add(&rectangle, m_pPlayers[0]->Position.Get(), Bit::Phys2::Material(0.0f, 1.0, 0.3f, 0.1f));
-			m_pBodies[1] = m_Scene.Add(&rectangle, m_pPlayers[1]->Position.Get(), Bit::Phys2::Material(0.0f, 1.0, 0.3f, 0.1f));
-			m_pBodies[2] = m_Scene.Add(&circle, m_pBall->Position.Get(), Bit::Phys2::Material(1.0f, 1.0, 0.3f, 0.1f));
-			m_pBodies[2]->ApplyForce(Bit::Vector2f32(-0.2f, 0.0f));
-
-			// Add border bodies
-			Bit::Phys2::Rectangle borderHor(Bit::Vector2f32( 20.0f, 0.2f ));
-			m_Scene.Add(&borderHor, Bit::Vector2f32(0.0f, 0.0f), Bit::Phys2::Material(0.0f, 1.0, 0.3f, 0.1f));
-			m_Scene.Add(&borderHor, Bit::Vector2f32(0.0f, 3.0f), Bit::Phys2::Material(0.0f, 1.0, 0.3f, 0.1f));
+			// Start the workers, this thread is one of them.
+			m_JobScheduler.Start( m_Settings.WorkerCount );
+			std::cout << "Stepping matches on " << m_JobScheduler.GetThreadCount( ) << " threads." << std::endl;
 
 			// Turn the main update function into a timestep function.
-			Bit::Time updateTime = Bit::Seconds( 1.0f / 60.0f );
+			Bit::Time updateTime = Bit::Microseconds( TickInterval );
 			Bit::Timestep timestep;
 
 
@@ -166,68 +374,185 @@ namespace Pong
 				// Execute the timestep.
 				timestep.Execute(updateTime, [this, updateTime]()
 				{
-					m_Scene.Step(updateTime, 6, 4);
+					Bit::Timer tickTimer;
+					tickTimer.Start( );
+					TraceScope tickTrace( "Tick" );
+					m_AllocationReport.BeginFrame( );
+					m_TickTime = GetTime( );
+
+					// Apply the control requests and the inputs.
+					{
+						AllocationScope scope( m_AllocationReport, "Input" );
+						TraceScope trace( "Input" );
+
+						// Requested by the control thread, the tick does no control I/O.
+						if( m_StopRequested.load( ) || ( m_Draining.load( ) && IsDrained( ) ) )
+						{
+							Stop( );
+						}
 
-					// Update the keyboard
-					m_Keyboard.Update( );
+						// The messages of the client hosted by this process.
+						ReceiveLocalMessages( );
+
+						// Bots decide first, their input covers the whole step.
+						if( m_Settings.Bots )
+						{
+							PlayFreeSlots( );
+						}
+						ApplyInputs( );
+					}
 
-					// Check keyboard input
-					if( m_Keyboard.KeyIsJustReleased( Bit::Keyboard::Num1 ) )
+					// Step all matches, returns when every match job is done.
 					{
-						Stop( );
+						const AllocationCounters workerStart = m_JobScheduler.GetWorkerAllocations( );
+						AllocationScope scope( m_AllocationReport, "Step" );
+						TraceScope trace( "Step" );
+						StepMatches(updateTime);
+						m_AllocationReport.Add( "Step", m_JobScheduler.GetWorkerAllocations( ) - workerStart );
 					}
 
-					// Update the players
-					for (Bit::SizeType i = 0; i < 2; i++)
+					// Publish a copy of the states, after the barrier, the send thread sends it.
 					{
-						// Get the player
-						Player * pPlayer = m_pPlayers[i];
+						AllocationScope scope( m_AllocationReport, "Publish" );
+						TraceScope trace( "Publish" );
+						PublishStates( );
 
-						// Check if the player is moving.
-						if (pPlayer->IsMoving)
+						// Copy the match summaries the control thread waits for.
+						if( m_SummaryRequested.exchange( false ) )
 						{
-							//Bit::Vector2f32 newPosition = pPlayer->Position.Get();
-							if (pPlayer->Direction == eDirection::Up)
-							{
-								// can not apply force to static objects, change position.
-								Bit::Vector2f32 newPosition = m_pBodies[i]->GetPosition();
-								newPosition.y += 2.0f * updateTime.AsSeconds();
-								m_pBodies[i]->SetPosition(newPosition);
-							}
-							else
-							{
-								// can not apply force to static objects, change position.
-								Bit::Vector2f32 newPosition = m_pBodies[i]->GetPosition();
-								newPosition.y -= 2.0f * updateTime.AsSeconds();
-								m_pBodies[i]->SetPosition(newPosition);
-							}
-
-							
-							
+							SummarizeMatches( );
+							m_SummarySemaphore.Release( );
 						}
+					}
+
+					// Queue the messages of this tick, packed per user, and wake the send thread.
+					{
+						AllocationScope scope( m_AllocationReport, "Flush" );
+						TraceScope trace( "Flush" );
+						FlushMessages( );
+						m_SendSemaphore.Release( );
+					}
 
-						// Set the position
-						pPlayer->Position.Set(m_pBodies[i]->GetPosition());
+					// Write the checkpoint, or the final one when another server takes over.
+					{
+						AllocationScope scope( m_AllocationReport, "Checkpoint" );
+						TraceScope trace( "Checkpoint" );
+						WriteCheckpoint( );
 					}
 
-					
+					m_AllocationReport.EndFrame( );
+					m_Tick++;
 
-					if (m_pBall->Position.Get().x + m_pBall->Size.Get().x <= 0 ||
-						m_pBall->Position.Get().x - m_pBall->Size.Get().x >= 6.0f)
+					// Measure the tick.
+					const Bit::Time tickTime = tickTimer.GetLapsedTime( );
+					m_TickMutex.Lock( );
+					m_TickStatistics.Ticks++;
+					m_TickStatistics.TotalTickTime = m_TickStatistics.TotalTickTime + tickTime;
+					if( tickTime > m_TickStatistics.MaxTickTime )
 					{
-						m_pBodies[2]->SetPosition(Bit::Vector2f32(3.0f, 1.50f));
-						m_pBall->Position.Set(m_pBodies[2]->GetPosition());
+						m_TickStatistics.MaxTickTime = tickTime;
 					}
-					else
+					if( tickTime > updateTime )
 					{
-						m_pBall->Position.Set(m_pBodies[2]->GetPosition());
+						m_TickStatistics.Overruns++;
 					}
 
-					m_pBall->Rotation.Set(m_pBodies[2]->GetOrientation().AsRadians());
-
+					// Scale the physics quality to the load, the next tick steps with it.
+					const Bit::Uint32 previousLevel = m_QualityGovernor.GetLevel( );
+					if( m_QualityGovernor.Update( tickTime, updateTime ) )
+					{
+						const PhysicsQuality & quality = m_QualityGovernor.GetQuality( );
+						m_Matches.SetPhysicsQuality( quality );
+						std::cout	<< "Physics quality " << ( m_QualityGovernor.GetLevel( ) > previousLevel ? "lowered" : "raised" )
+									<< " to level " << m_QualityGovernor.GetLevel( ) << " of " << m_QualityGovernor.GetLevelCount( ) - 1
+									<< " at tick " << m_Tick << ", substeps " << quality.Substeps << ", load " << static_cast<Bit::Uint32>( m_QualityGovernor.GetLoad( ) * 100.0 ) << "%." << std::endl;
+					}
+					const QualityGovernor::Statistics & qualityStatistics = m_QualityGovernor.GetStatistics( );
+					m_TickStatistics.QualityLevel = m_QualityGovernor.GetLevel( );
+					m_TickStatistics.QualityDowngrades = qualityStatistics.Downgrades;
+					m_TickStatistics.QualityUpgrades = qualityStatistics.Upgrades;
+					m_TickStatistics.ReducedQualityTicks = qualityStatistics.ReducedTicks;
+					m_TickMutex.Unlock( );
 
 				} );
 			}
+
+			m_JobScheduler.Stop( );
+
+			// Wake the send thread, it stops too.
+			m_SendSemaphore.Release( );
+		}
+		);
+
+		// Send the queued frames and the snapshots off the tick, from the newest published state.
+		// No other thread sends, the server and the downstream ring have a single writer.
+		m_SendThread.Execute( [ this ] ( )
+		{
+			Trace::SetThreadName( "Server send" );
+
+			while( IsRunning( ) )
+			{
+				m_SendSemaphore.Wait( );
+
+				// The frames first, the baseline of a joining client precedes its snapshots.
+				{
+					TraceScope trace( "Frames" );
+					SendFrames( );
+				}
+
+				if( m_PublishedStates.Acquire( ) == false )
+				{
+					continue;
+				}
+
+				TraceScope trace( "Snapshot" );
+				const PublishedState & state = m_PublishedStates.GetReadBuffer( );
+				UpdateEntities( state );
+				SendSnapshots( state );
+			}
+		}
+		);
+
+		// Serve the control commands and the keyboard off the tick.
+		m_ControlThread.Execute( [ this ] ( )
+		{
+			Trace::SetThreadName( "Server control" );
+
+			if( m_Settings.ControlPath.empty( ) == false )
+			{
+				if( m_ControlSocket.Open( m_Settings.ControlPath ) )
+				{
+					std::cout << "Listening for control commands on " << m_Settings.ControlPath << "." << std::endl;
+				}
+				else
+				{
+					std::cout << "Failed to open the control socket " << m_Settings.ControlPath << "." << std::endl;
+				}
+			}
+
+			std::string command;
+			while( IsRunning( ) )
+			{
+				if( m_ControlSocket.IsOpen( ) )
+				{
+					if( m_ControlSocket.Receive( command, Bit::Milliseconds( 50 ) ) )
+					{
+						m_ControlSocket.Reply( HandleCommand( command ) );
+					}
+				}
+				else
+				{
+					Bit::Sleep( Bit::Milliseconds( 50 ) );
+				}
+
+				m_Keyboard.Update( );
+				if( m_Keyboard.KeyIsJustReleased( Bit::Keyboard::Num1 ) )
+				{
+					m_StopRequested = true;
+				}
+			}
+
+			m_ControlSocket.Close( );
 		}
 		);
 	
@@ -240,31 +565,1077 @@ namespace Pong
 		
 	}
 
+	Server::TickStatistics Server::GetTickStatistics( )
+	{
+		m_TickMutex.Lock( );
+		const TickStatistics statistics = m_TickStatistics;
+		m_TickMutex.Unlock( );
+		return statistics;
+	}
+
+	Player * Server::GetPlayer( const Bit::SizeType p_Index ) const
+	{
+		return m_pPlayers[ p_Index ];
+	}
+
+	Ball * Server::GetBall( const Bit::SizeType p_Index ) const
+	{
+		return m_Balls.Get( p_Index );
+	}
+
 	void Server::OnConnection( const Bit::Uint16 p_UserId )
 	{
 		std::cout << "Client connected: " << p_UserId << std::endl;
 
-		// Create message and filter
-		/*Bit::Net::HostMessage * pMessage = CreateHostMessage( "Initialize" );
-		Bit::Net::HostRecipientFilter * pFilter = CreateRecipientFilter( );
+		// Connections allocate, start over with the steady state.
+		m_AllocationReport.ResetSteadyState( );
 
-		// Add the receiver.
-		pFilter->AddUser( p_UserId );
+		// Start batching messages for the user.
+		m_MessageBatcher.AddUser( p_UserId );
 
-		// Add the user id to the message
-		pMessage->WriteInt( static_cast<Bit::Int32>( p_UserId ) );
+		// Start sending snapshots to the user.
+		m_SnapshotMutex.Lock( );
+		m_SnapshotControllers.erase( p_UserId );
+		m_SnapshotControllers.insert( std::make_pair( p_UserId, SnapshotController( m_SnapshotLimits, m_Balls.GetCount( ) ) ) );
+		m_SnapshotMutex.Unlock( );
 
-		// Send the message
-		pMessage->Send( pFilter );
-
-		// Clean up the poitners
-		delete pFilter;
-		delete pMessage;*/
+		// The client sends a join message next, answered with the baseline.
 	}
 		
 	void Server::OnDisconnection( const Bit::Uint16 p_UserId )
 	{
 		std::cout << "Client disconnected: " << p_UserId << std::endl;
+
+		m_AllocationReport.ResetSteadyState( );
+
+		// Drop the pending messages of the user.
+		m_MessageBatcher.RemoveUser( p_UserId );
+
+		// Back to the network for the client hosted by this process, until it joins again.
+		Bit::Int32 localUserId = p_UserId;
+		m_LocalUserId.compare_exchange_strong( localUserId, -1 );
+		Bit::Int32 overflowUserId = p_UserId;
+		m_OverflowUserId.compare_exchange_strong( overflowUserId, -1 );
+
+		m_SnapshotMutex.Lock( );
+		m_SnapshotControllers.erase( p_UserId );
+		m_SnapshotMutex.Unlock( );
+
+		// Keep the slot of the player for a resume, with the paddle stopped.
+		m_SlotMutex.Lock( );
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			if( m_Slots[ i ].Connected && m_Slots[ i ].UserId == p_UserId )
+			{
+				m_Slots[ i ].Connected = false;
+				m_Slots[ i ].Reserved = true;
+				m_Slots[ i ].DisconnectTime = GetTime( );
+				m_pPlayers[ i ]->IsMoving = false;
+			}
+		}
+		m_SlotMutex.Unlock( );
+	}
+
+	void Server::CreateMatches( )
+	{
+		DestroyMatches( );
+
+		const Bit::SizeType matchCount = m_Settings.MatchCount > 0 ? m_Settings.MatchCount : 1;
+
+		if( m_Settings.Mode == GameMode::MultiBall )
+		{
+			m_MultiBallMatches.resize( matchCount, NULL );
+			for( Bit::SizeType i = 0; i < matchCount; i++ )
+			{
+				m_MultiBallMatches[ i ] = new MultiBallMatch;
+				m_MultiBallMatches[ i ]->Create( m_Settings.BallCount, m_Settings.ObstacleCount, m_Settings.Seed );
+			}
+		}
+		else
+		{
+			m_Matches.Create( matchCount );
+		}
+
+		m_MatchSummaries.resize( matchCount );
+	}
+
+	void Server::DestroyMatches( )
+	{
+		for( Bit::SizeType i = 0; i < m_MultiBallMatches.size( ); i++ )
+		{
+			delete m_MultiBallMatches[ i ];
+		}
+		m_MultiBallMatches.clear( );
+	}
+
+	void Server::StepMatches( const Bit::Time & p_Time )
+	{
+		const Bit::Bool bots = m_Settings.Bots;
+
+		if( m_Settings.Mode == GameMode::MultiBall )
+		{
+			// Pass the input of the connected players to the first match.
+			for( Bit::SizeType i = 0; i < 2; i++ )
+			{
+				m_MultiBallMatches[ 0 ]->SetPlayerVelocity( i, m_InputVelocities[ i ] );
+			}
+
+			// One job per match, the matches share no state. Bots play all but the first match.
+			std::vector<MultiBallMatch *> & matches = m_MultiBallMatches;
+			const Bit::Uint32 substeps = m_QualityGovernor.GetQuality( ).Substeps;
+			const Bit::Time substepTime = Bit::Microseconds( p_Time.AsMicroseconds( ) / substeps );
+			auto stepMatch = [ &matches, &substepTime, bots, substeps ] ( const Bit::SizeType p_Index )
+			{
+				if( bots && p_Index > 0 )
+				{
+					Bot::Play( *matches[ p_Index ] );
+				}
+				for( Bit::Uint32 i = 0; i < substeps; i++ )
+				{
+					matches[ p_Index ]->Step( substepTime );
+				}
+			};
+			m_JobScheduler.ParallelFor( matches.size( ), stepMatch );
+		}
+		else
+		{
+			// Pass the input of the connected players to the first match.
+			for( Bit::SizeType i = 0; i < 2; i++ )
+			{
+				m_Matches.SetPlayerVelocity( 0, i, m_InputVelocities[ i ] );
+			}
+
+			// One job per range of matches, small enough to balance, large enough for the kernels.
+			MatchBatch & matches = m_Matches;
+			const Bit::SizeType jobCount = ( matches.GetMatchCount( ) + MatchesPerJob - 1 ) / MatchesPerJob;
+			auto stepRange = [ &matches, &p_Time, bots ] ( const Bit::SizeType p_Index )
+			{
+				const Bit::SizeType first = p_Index * MatchesPerJob;
+				if( bots )
+				{
+					const Bit::SizeType botFirst = first > 0 ? first : 1;
+					Bot::Play( matches, botFirst, first + MatchesPerJob - botFirst );
+				}
+				matches.Step( first, MatchesPerJob, p_Time );
+			};
+			m_JobScheduler.ParallelFor( jobCount, stepRange );
+		}
+	}
+
+	void Server::ApplyInputs( )
+	{
+		m_InputMutex.Lock( );
+		m_SlotMutex.Lock( );
+
+		Bit::Uint32 applyTicks[ 2 ];
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			// Apply the inputs of one client tick per step, so inputs of
+			// consecutive client ticks keep their spacing. A backlog is applied at once.
+			Bit::Bool found = false;
+			Bit::Uint32 oldestTick = 0;
+			Bit::Uint32 newestTick = 0;
+			for( std::vector<Input>::iterator it = m_Inputs.begin( ); it != m_Inputs.end( ); it++ )
+			{
+				if( it->Slot == i )
+				{
+					oldestTick = found == false || it->Tick < oldestTick ? it->Tick : oldestTick;
+					newestTick = found == false || it->Tick > newestTick ? it->Tick : newestTick;
+					found = true;
+				}
+			}
+			applyTicks[ i ] = newestTick - oldestTick > MaxInputBacklog ? newestTick : oldestTick;
+
+			// Integrate the velocity piecewise over the step, in microseconds.
+			Player * pPlayer = m_pPlayers[ i ];
+			Bit::Float32 velocity = pPlayer->IsMoving ? ( pPlayer->Direction == eDirection::Up ? 1.0f : -1.0f ) : 0.0f;
+			Bit::Uint32 position = 0;
+			Bit::Float32 distance = 0.0f;
+
+			for( std::vector<Input>::iterator it = m_Inputs.begin( ); it != m_Inputs.end( ) && m_Slots[ i ].Connected; it++ )
+			{
+				if( it->Slot != i || it->Tick > applyTicks[ i ] )
+				{
+					continue;
+				}
+
+				// Inputs arrive in order, an earlier offset is applied right after the previous input.
+				const Bit::Uint32 offset = it->Tick < applyTicks[ i ] ? 0 : ( it->Offset < TickInterval ? it->Offset : TickInterval );
+				const Bit::Uint32 start = offset > position ? offset : position;
+				distance += velocity * static_cast<Bit::Float32>( start - position );
+				position = start;
+
+				pPlayer->IsMoving = it->IsMoving;
+				pPlayer->Direction = it->Direction;
+				velocity = it->IsMoving ? ( it->Direction == eDirection::Up ? 1.0f : -1.0f ) : 0.0f;
+			}
+
+			distance += velocity * static_cast<Bit::Float32>( TickInterval - position );
+			m_InputVelocities[ i ] = distance / static_cast<Bit::Float32>( TickInterval );
+		}
+
+		// Keep the inputs of later client ticks, drop the applied ones and the ones of users that left.
+		Bit::SizeType kept = 0;
+		for( Bit::SizeType i = 0; i < m_Inputs.size( ); i++ )
+		{
+			const Input input = m_Inputs[ i ];
+			if( m_Slots[ input.Slot ].Connected && input.Tick > applyTicks[ input.Slot ] )
+			{
+				m_Inputs[ kept++ ] = input;
+			}
+		}
+		m_Inputs.resize( kept );
+
+		m_SlotMutex.Unlock( );
+		m_InputMutex.Unlock( );
+	}
+
+	Bit::Bool Server::IsDrained( )
+	{
+		const Bit::Uint64 now = GetTime( );
+		const Bit::Uint64 resumeTimeout = static_cast<Bit::Uint64>( m_Settings.ResumeTimeout ) * 1000;
+		Bit::Bool drained = true;
+
+		m_SlotMutex.Lock( );
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			if( m_Slots[ i ].Connected || ( m_Slots[ i ].Reserved && now - m_Slots[ i ].DisconnectTime <= resumeTimeout ) )
+			{
+				drained = false;
+			}
+		}
+		m_SlotMutex.Unlock( );
+
+		return drained;
+	}
+
+	void Server::SummarizeMatches( )
+	{
+		const Bit::Bool multiBall = m_Settings.Mode == GameMode::MultiBall;
+		for( Bit::SizeType i = 0; i < m_MatchSummaries.size( ); i++ )
+		{
+			const BallStates & ballStates = multiBall ? m_MultiBallMatches[ i ]->GetBallStates( ) : m_Matches.GetBallStates( );
+			const PlayerStates & playerStates = multiBall ? m_MultiBallMatches[ i ]->GetPlayerStates( ) : m_Matches.GetPlayerStates( );
+			const Bit::SizeType ball = multiBall ? 0 : i;
+			const Bit::SizeType player = multiBall ? 0 : i * 2;
+
+			MatchSummary & summary = m_MatchSummaries[ i ];
+			summary.BallCount = static_cast<Bit::Uint32>( multiBall ? ballStates.GetCount( ) : 1 );
+			summary.BallX = summary.BallCount ? ballStates.PositionX[ ball ] : 0.0f;
+			summary.BallY = summary.BallCount ? ballStates.PositionY[ ball ] : 0.0f;
+			summary.PlayerY[ 0 ] = playerStates.PositionY[ player ];
+			summary.PlayerY[ 1 ] = playerStates.PositionY[ player + 1 ];
+		}
+	}
+
+	std::string Server::HandleCommand( const std::string & p_Command )
+	{
+		std::ostringstream reply;
+
+		if( p_Command == "stop" )
+		{
+			m_StopRequested = true;
+			reply << "Stopping." << std::endl;
+		}
+		else if( p_Command == "drain" )
+		{
+			m_Draining = true;
+			reply << "Draining, new users are refused and the server stops when the players left." << std::endl;
+		}
+		else if( p_Command == "stats" )
+		{
+			const TickStatistics ticks = GetTickStatistics( );
+			const Bit::Float64 meanTick = ticks.Ticks ? ticks.TotalTickTime.AsMilliseconds( ) / static_cast<Bit::Float64>( ticks.Ticks ) : 0.0;
+
+			Bit::SizeType connected = 0;
+			Bit::SizeType reserved = 0;
+			m_SlotMutex.Lock( );
+			for( Bit::SizeType i = 0; i < 2; i++ )
+			{
+				connected += m_Slots[ i ].Connected ? 1 : 0;
+				reserved += m_Slots[ i ].Reserved ? 1 : 0;
+			}
+			m_SlotMutex.Unlock( );
+
+			m_SnapshotMutex.Lock( );
+			const Bit::SizeType clients = m_SnapshotControllers.size( );
+			m_SnapshotMutex.Unlock( );
+
+			reply	<< "ticks " << ticks.Ticks << std::endl
+					<< "overruns " << ticks.Overruns << std::endl
+					<< "mean tick " << meanTick << " ms" << std::endl
+					<< "max tick " << ticks.MaxTickTime.AsMilliseconds( ) << " ms" << std::endl
+					<< "physics level " << ticks.QualityLevel << std::endl
+					<< "physics downgrades " << ticks.QualityDowngrades << std::endl
+					<< "physics upgrades " << ticks.QualityUpgrades << std::endl
+					<< "skipped states " << ticks.SkippedStates << std::endl
+					<< "coalesced frames " << ticks.CoalescedFrames << std::endl
+					<< "dropped frames " << ticks.DroppedFrames << std::endl
+					<< "clients " << clients << std::endl
+					<< "players connected " << connected << std::endl
+					<< "players reserved " << reserved << std::endl
+					<< "draining " << ( m_Draining.load( ) ? "yes" : "no" ) << std::endl;
+		}
+		else if( p_Command == "matches" )
+		{
+			// Drop a summary of an earlier request that timed out, then wait for the next tick.
+			while( m_SummarySemaphore.TryWait( ) )
+			{
+			}
+			m_SummaryRequested = true;
+
+			if( m_SummarySemaphore.Wait( Bit::Seconds( 1.0f ) ) == false )
+			{
+				m_SummaryRequested = false;
+				reply << "No tick answered." << std::endl;
+			}
+			else
+			{
+				reply	<< "matches " << m_MatchSummaries.size( )
+						<< ", mode " << ( m_Settings.Mode == GameMode::MultiBall ? "multi-ball" : "classic" )
+						<< ", bots " << ( m_Settings.Bots ? "on" : "off" ) << std::endl;
+				for( Bit::SizeType i = 0; i < m_MatchSummaries.size( ); i++ )
+				{
+					const MatchSummary & summary = m_MatchSummaries[ i ];
+					reply	<< i << ": balls " << summary.BallCount
+							<< ", ball " << summary.BallX << " " << summary.BallY
+							<< ", players " << summary.PlayerY[ 0 ] << " " << summary.PlayerY[ 1 ]
+							<< ( i == 0 ? ", networked" : "" ) << std::endl;
+				}
+			}
+		}
+		else
+		{
+			if( p_Command != "help" )
+			{
+				reply << "Unknown command " << p_Command << "." << std::endl;
+			}
+			reply << "Commands: stop, drain, stats, matches, help." << std::endl;
+		}
+
+		return reply.str( );
+	}
+
+	void Server::PlayFreeSlots( )
+	{
+		const Bit::Bool multiBall = m_Settings.Mode == GameMode::MultiBall;
+		const BallStates & ballStates = multiBall ? m_MultiBallMatches[ 0 ]->GetBallStates( ) : m_Matches.GetBallStates( );
+		const PlayerStates & playerStates = multiBall ? m_MultiBallMatches[ 0 ]->GetPlayerStates( ) : m_Matches.GetPlayerStates( );
+		const Bit::SizeType ballCount = multiBall ? ballStates.GetCount( ) : 1;
+
+		m_SlotMutex.Lock( );
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			if( m_Slots[ i ].Connected == false )
+			{
+				const Bit::Float32 target = Bot::FindTarget( ballStates, 0, ballCount, playerStates.PositionX[ i ] );
+				Bot::Think( playerStates.PositionY[ i ], target, m_pPlayers[ i ]->IsMoving, m_pPlayers[ i ]->Direction );
+			}
+		}
+		m_SlotMutex.Unlock( );
+	}
+
+	void Server::PublishStates( )
+	{
+		// The entities belong to the first match, which owns the first states.
+		const Bit::Bool multiBall = m_Settings.Mode == GameMode::MultiBall;
+		const BallStates & ballStates = multiBall ? m_MultiBallMatches[ 0 ]->GetBallStates( ) : m_Matches.GetBallStates( );
+		const PlayerStates & playerStates = multiBall ? m_MultiBallMatches[ 0 ]->GetPlayerStates( ) : m_Matches.GetPlayerStates( );
+
+		// The buffers are sized by the constructor, copy without allocating.
+		PublishedState & state = m_PublishedStates.GetWriteBuffer( );
+		state.Tick = m_Tick;
+		for( Bit::SizeType i = 0; i < state.Balls.GetCount( ) && i < ballStates.GetCount( ); i++ )
+		{
+			state.Balls.PositionX[ i ] = ballStates.PositionX[ i ];
+			state.Balls.PositionY[ i ] = ballStates.PositionY[ i ];
+			state.Balls.Rotation[ i ] = ballStates.Rotation[ i ];
+		}
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			state.Players.PositionX[ i ] = playerStates.PositionX[ i ];
+			state.Players.PositionY[ i ] = playerStates.PositionY[ i ];
+		}
+
+		if( m_PublishedStates.Publish( ) == false )
+		{
+			m_TickMutex.Lock( );
+			m_TickStatistics.SkippedStates++;
+			m_TickMutex.Unlock( );
+		}
+	}
+
+	void Server::UpdateEntities( const PublishedState & p_State )
+	{
+		for( Bit::SizeType i = 0; i < m_Balls.GetCount( ); i++ )
+		{
+			Ball * pBall = m_Balls.Get( i );
+			pBall->Position.Set( Bit::Vector2f32( p_State.Balls.PositionX[ i ], p_State.Balls.PositionY[ i ] ) );
+			pBall->Rotation.Set( p_State.Balls.Rotation[ i ] );
+		}
+
+		for( Bit::SizeType i = 0; i < m_Players.GetCount( ); i++ )
+		{
+			m_Players.Get( i )->Position.Set( Bit::Vector2f32( p_State.Players.PositionX[ i ], p_State.Players.PositionY[ i ] ) );
+		}
+	}
+
+	Bit::Uint64 Server::GetTime( )
+	{
+		return m_ClockOffset + static_cast<Bit::Uint64>( m_Clock.GetLapsedTime( ).AsMicroseconds( ) );
+	}
+
+	Bit::Bool Server::TakeOver( )
+	{
+		if( m_Settings.CheckpointPath.empty( ) || m_Checkpoint.Open( m_Settings.CheckpointPath ) == false )
+		{
+			return false;
+		}
+
+		// The running server writes a final checkpoint at the end of its next tick.
+		m_Checkpoint.RequestHandover( );
+
+		Bit::Timer timer;
+		timer.Start( );
+		while( m_Checkpoint.IsReleased( ) == false &&
+			   timer.GetLapsedTime( ) < Bit::Milliseconds( HandoverTimeout ) )
+		{
+			Bit::Sleep( Bit::Milliseconds( 1 ) );
+		}
+
+		if( m_Checkpoint.IsReleased( ) == false )
+		{
+			std::cout << "No server handed over, continuing from the newest checkpoint." << std::endl;
+		}
+		m_Checkpoint.Acquire( );
+
+		if( m_Checkpoint.Read( m_CheckpointPacket ) == false )
+		{
+			m_Checkpoint.Close( );
+			return false;
+		}
+
+		return true;
+	}
+
+	void Server::RestoreCheckpoint( )
+	{
+		// Continue from the taken over state.
+		if( m_CheckpointPacket.GetSize( ) )
+		{
+			if( LoadState( m_CheckpointPacket ) )
+			{
+				PublishStates( );
+				std::cout << "Took over the matches at tick " << m_Tick << "." << std::endl;
+			}
+			else
+			{
+				std::cout << "The checkpoint was written with other settings, starting new matches." << std::endl;
+				CreateMatches( );
+			}
+		}
+
+		if( m_Settings.CheckpointPath.empty( ) )
+		{
+			m_Checkpoint.Close( );
+			return;
+		}
+
+		// The state has a fixed size, reserve twice that to never allocate in a tick.
+		m_CheckpointPacket.Clear( );
+		SaveState( m_CheckpointPacket, m_Tick );
+		const Bit::SizeType capacity = m_CheckpointPacket.GetSize( ) * 2;
+
+		if( m_Checkpoint.GetCapacity( ) < capacity &&
+			m_Checkpoint.Create( m_Settings.CheckpointPath, capacity ) == false )
+		{
+			std::cout << "Failed to create the checkpoint file " << m_Settings.CheckpointPath << "." << std::endl;
+			return;
+		}
+
+		m_CheckpointPacket.Reserve( m_Checkpoint.GetCapacity( ) );
+		m_Checkpoint.Write( m_CheckpointPacket );
+	}
+
+	void Server::WriteCheckpoint( )
+	{
+		if( m_Checkpoint.IsOpen( ) == false )
+		{
+			return;
+		}
+
+		// The state is written after the tick, continue from the next one.
+		const Bit::Uint32 nextTick = m_Tick + 1;
+		const Bit::Bool handover = m_Checkpoint.IsHandoverRequested( );
+		if( handover == false &&
+			( m_Settings.CheckpointInterval == 0 || nextTick % m_Settings.CheckpointInterval != 0 ) )
+		{
+			return;
+		}
+
+		m_CheckpointPacket.Clear( );
+		SaveState( m_CheckpointPacket, nextTick );
+		m_Checkpoint.Write( m_CheckpointPacket );
+
+		if( handover )
+		{
+			m_Checkpoint.Release( );
+			m_Checkpoint.Close( );
+			std::cout << "Handed over the matches at tick " << nextTick << "." << std::endl;
+			Stop( );
+		}
+	}
+
+	void Server::SaveState( Packet & p_Packet, const Bit::Uint32 p_Tick )
+	{
+		// The settings the state depends on, checked by the loading server.
+		const Bit::Bool multiBall = m_Settings.Mode == GameMode::MultiBall;
+		p_Packet.WriteByte( static_cast<Bit::Uint8>( m_Settings.Mode ) );
+		p_Packet.WriteUint32( static_cast<Bit::Uint32>( multiBall ? m_MultiBallMatches.size( ) : m_Matches.GetMatchCount( ) ) );
+		p_Packet.WriteUint16( m_Settings.ObstacleCount );
+		p_Packet.WriteUint32( m_Settings.Seed );
+
+		p_Packet.WriteUint32( p_Tick );
+		p_Packet.WriteUint64( GetTime( ) );
+
+		// Slots, users holding a slot can resume it on the next server.
+		m_SlotMutex.Lock( );
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			const Bit::Bool held = m_Slots[ i ].Connected || m_Slots[ i ].Reserved;
+			p_Packet.WriteUint64( held ? m_Slots[ i ].Token : 0 );
+		}
+		m_SlotMutex.Unlock( );
+
+		// Matches
+		if( multiBall )
+		{
+			for( Bit::SizeType i = 0; i < m_MultiBallMatches.size( ); i++ )
+			{
+				m_MultiBallMatches[ i ]->SaveState( p_Packet );
+			}
+		}
+		else
+		{
+			m_Matches.SaveState( p_Packet );
+		}
+	}
+
+	Bit::Bool Server::LoadState( Packet & p_Packet )
+	{
+		const Bit::Bool multiBall = m_Settings.Mode == GameMode::MultiBall;
+		const Bit::Uint8 mode = p_Packet.ReadByte( );
+		const Bit::Uint32 matchCount = p_Packet.ReadUint32( );
+		const Bit::Uint16 obstacleCount = p_Packet.ReadUint16( );
+		const Bit::Uint32 seed = p_Packet.ReadUint32( );
+		if( mode != static_cast<Bit::Uint8>( m_Settings.Mode ) ||
+			matchCount != ( multiBall ? m_MultiBallMatches.size( ) : m_Matches.GetMatchCount( ) ) ||
+			( multiBall && ( obstacleCount != m_Settings.ObstacleCount || seed != m_Settings.Seed ) ) )
+		{
+			return false;
+		}
+
+		const Bit::Uint32 tick = p_Packet.ReadUint32( );
+		const Bit::Uint64 time = p_Packet.ReadUint64( );
+		Bit::Uint64 tokens[ 2 ];
+		tokens[ 0 ] = p_Packet.ReadUint64( );
+		tokens[ 1 ] = p_Packet.ReadUint64( );
+
+		// Matches
+		if( multiBall )
+		{
+			for( Bit::SizeType i = 0; i < m_MultiBallMatches.size( ); i++ )
+			{
+				if( m_MultiBallMatches[ i ]->LoadState( p_Packet ) == false )
+				{
+					return false;
+				}
+			}
+		}
+		else if( m_Matches.LoadState( p_Packet ) == false )
+		{
+			return false;
+		}
+
+		// Continue the tick and the clock, modulo 2^64 like the clock itself.
+		m_Tick = tick;
+		m_ClockOffset = 0;
+		m_ClockOffset = time - GetTime( );
+
+		// Reserve the held slots, as if the users just disconnected.
+		const Bit::Uint64 now = GetTime( );
+		m_SlotMutex.Lock( );
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			m_Slots[ i ].Connected = false;
+			m_Slots[ i ].Reserved = tokens[ i ] != 0;
+			m_Slots[ i ].UserId = 0;
+			m_Slots[ i ].Token = tokens[ i ];
+			m_Slots[ i ].DisconnectTime = now;
+		}
+		m_SlotMutex.Unlock( );
+
+		return true;
+	}
+
+	Bit::Int32 Server::GetSlot( const Bit::Uint16 p_UserId )
+	{
+		Bit::Int32 slot = -1;
+
+		m_SlotMutex.Lock( );
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			if( m_Slots[ i ].Connected && m_Slots[ i ].UserId == p_UserId )
+			{
+				slot = static_cast<Bit::Int32>( i );
+			}
+		}
+		m_SlotMutex.Unlock( );
+
+		return slot;
+	}
+
+	void Server::AcceptJoins( )
+	{
+		m_JoinMutex.Lock( );
+
+		if( m_Joins.empty( ) )
+		{
+			m_JoinMutex.Unlock( );
+			return;
+		}
+
+		const Bit::Uint64 now = GetTime( );
+		const Bit::Uint64 resumeTimeout = static_cast<Bit::Uint64>( m_Settings.ResumeTimeout ) * 1000;
+
+		m_SlotMutex.Lock( );
+
+		for( std::vector<Join>::iterator it = m_Joins.begin( ); it != m_Joins.end( ); it++ )
+		{
+			Bit::Int32 slot = -1;
+
+			// The client hosted by this process switches to the local transport after the baseline,
+			// which it waits for over the network. Drop what the previous connection left in the ring.
+			if( it->Local )
+			{
+				m_LocalUserId = -1;
+				m_LocalTransport.Upstream.Clear( );
+				m_PendingLocalUserId = it->UserId;
+			}
+
+			// Release the reserved slots no longer resumable.
+			for( Bit::SizeType i = 0; i < 2; i++ )
+			{
+				if( m_Slots[ i ].Reserved && now - m_Slots[ i ].DisconnectTime > resumeTimeout )
+				{
+					m_Slots[ i ].Reserved = false;
+					m_Slots[ i ].Token = 0;
+				}
+			}
+
+			// A repeated join gets the same slot.
+			for( Bit::SizeType i = 0; i < 2 && slot < 0; i++ )
+			{
+				if( m_Slots[ i ].Connected && m_Slots[ i ].UserId == it->UserId )
+				{
+					slot = static_cast<Bit::Int32>( i );
+				}
+			}
+
+			// Resume the reserved slot of the token.
+			for( Bit::SizeType i = 0; i < 2 && slot < 0 && it->Token != 0; i++ )
+			{
+				if( m_Slots[ i ].Reserved && m_Slots[ i ].Token == it->Token )
+				{
+					m_Slots[ i ].Connected = true;
+					m_Slots[ i ].Reserved = false;
+					m_Slots[ i ].UserId = it->UserId;
+					m_pPlayers[ i ]->IsMoving = false;
+					slot = static_cast<Bit::Int32>( i );
+					std::cout << "Client resumed: " << it->UserId << ", slot " << slot << std::endl;
+				}
+			}
+
+			// Otherwise take a free slot, with a new token.
+			for( Bit::SizeType i = 0; i < 2 && slot < 0; i++ )
+			{
+				if( m_Slots[ i ].Connected == false && m_Slots[ i ].Reserved == false && m_Draining.load( ) == false )
+				{
+					Bit::Uint64 token = 0;
+					while( token == 0 )
+					{
+						token = m_TokenGenerator( );
+					}
+
+					m_Slots[ i ].Connected = true;
+					m_Slots[ i ].UserId = it->UserId;
+					m_Slots[ i ].Token = token;
+					m_pPlayers[ i ]->IsMoving = false;
+					slot = static_cast<Bit::Int32>( i );
+				}
+			}
+
+			QueueBaseline( it->UserId, slot, slot >= 0 ? m_Slots[ slot ].Token : 0 );
+		}
+
+		m_SlotMutex.Unlock( );
+
+		m_Joins.clear( );
+		m_JoinMutex.Unlock( );
+	}
+
+	void Server::QueueBaseline( const Bit::Uint16 p_UserId, const Bit::Int32 p_Slot, const Bit::Uint64 p_Token )
+	{
+		const Bit::Bool multiBall = m_Settings.Mode == GameMode::MultiBall;
+		const BallStates & ballStates = multiBall ? m_MultiBallMatches[ 0 ]->GetBallStates( ) : m_Matches.GetBallStates( );
+		const PlayerStates & playerStates = multiBall ? m_MultiBallMatches[ 0 ]->GetPlayerStates( ) : m_Matches.GetPlayerStates( );
+
+		// Slot, resume token and the match setup.
+		m_BaselinePacket.Clear( );
+		m_BaselinePacket.WriteByte( p_Slot >= 0 ? static_cast<Bit::Uint8>( p_Slot ) : 0xFF );
+		m_BaselinePacket.WriteUint64( p_Token );
+		m_BaselinePacket.WriteByte( static_cast<Bit::Uint8>( m_Settings.Mode ) );
+		m_BaselinePacket.WriteUint16( multiBall ? m_Settings.ObstacleCount : 0 );
+		m_BaselinePacket.WriteUint32( m_Settings.Seed );
+		m_BaselinePacket.WriteFloat( m_pBall->Size.Get( ).x );
+		m_BaselinePacket.WriteFloat( Field::PlayerWidth );
+		m_BaselinePacket.WriteFloat( Field::PlayerHeight );
+
+		// The state of every entity, a full detail snapshot of this tick.
+		Snapshot::Header header;
+		header.Sequence = 0;
+		header.Tick = m_Tick;
+		header.Level = 0;
+		header.FirstBall = 0;
+		header.BallCount = static_cast<Bit::Uint16>( m_Balls.GetCount( ) );
+		header.TotalBallCount = header.BallCount;
+		Snapshot::Write( m_BaselinePacket, header, ballStates, playerStates );
+
+		m_MessageBatcher.Queue( p_UserId, MessageType::Baseline, m_BaselinePacket );
+	}
+
+	void Server::QueueTimeSyncReplies( )
+	{
+		m_PingMutex.Lock( );
+
+		// Stamp the send time as late as possible, right before the flush.
+		const Bit::Uint64 serverSend = GetTime( );
+		for( std::vector<Ping>::iterator it = m_Pings.begin( ); it != m_Pings.end( ); it++ )
+		{
+			m_TimeSyncPacket.Clear( );
+			m_TimeSyncPacket.WriteUint32( it->Sequence );
+			m_TimeSyncPacket.WriteUint64( it->ClientSend );
+			m_TimeSyncPacket.WriteUint64( it->ServerReceive );
+			m_TimeSyncPacket.WriteUint64( serverSend );
+			m_TimeSyncPacket.WriteUint32( m_Tick );
+			m_TimeSyncPacket.WriteUint32( TickInterval );
+			m_TimeSyncPacket.WriteUint64( m_TickTime );
+			m_MessageBatcher.Queue( it->UserId, MessageType::TimeSync, m_TimeSyncPacket );
+		}
+		m_Pings.clear( );
+
+		m_PingMutex.Unlock( );
+	}
+
+	void Server::SendSnapshots( const PublishedState & p_State )
+	{
+		const Bit::Uint64 time = GetTime( );
+
+		m_SnapshotMutex.Lock( );
+
+		for( std::map<Bit::Uint16, SnapshotController>::iterator it = m_SnapshotControllers.begin( ); it != m_SnapshotControllers.end( ); it++ )
+		{
+			SnapshotController & controller = it->second;
+			controller.Update( time );
+
+			if( controller.IsDue( p_State.Tick ) == false )
+			{
+				continue;
+			}
+
+			// Write the snapshot at the detail level of the user.
+			Snapshot::Header header;
+			header.Sequence = controller.GetSequence( );
+			header.Tick = p_State.Tick;
+			header.Level = controller.GetLevel( );
+			header.FirstBall = controller.GetFirstBall( );
+			header.BallCount = static_cast<Bit::Uint16>( SnapshotController::GetBallCount( header.Level, m_Balls.GetCount( ) ) );
+			header.TotalBallCount = static_cast<Bit::Uint16>( m_Balls.GetCount( ) );
+			m_SnapshotPacket.Clear( );
+			Snapshot::Write( m_SnapshotPacket, header, p_State.Balls, p_State.Players );
+
+			// Snapshots are unreliable, a lost snapshot is replaced by the next one.
+			TraceScope trace( "Send snapshot" );
+			if( SendLocal( it->first, LocalMessage::Snapshot, m_SnapshotPacket ) )
+			{
+				controller.OnSent( p_State.Tick, m_SnapshotPacket.GetSize( ), time );
+				continue;
+			}
+			Bit::Net::HostMessage * pMessage = CreateHostMessage( "Snapshot" );
+			Bit::Net::HostRecipientFilter * pFilter = CreateRecipientFilter( );
+			pFilter->AddUser( it->first );
+			pFilter->SetReliable( false );
+			pMessage->WriteArray( m_SnapshotPacket.GetData( ), m_SnapshotPacket.GetSize( ) );
+			pMessage->Send( pFilter );
+			delete pFilter;
+			delete pMessage;
+
+			controller.OnSent( p_State.Tick, m_SnapshotPacket.GetSize( ), time );
+		}
+
+		m_SnapshotMutex.Unlock( );
+	}
+
+	void Server::FlushMessages( )
+	{
+		// Answer the joins and the time sync pings of this tick.
+		AcceptJoins( );
+		QueueTimeSyncReplies( );
+
+		// Copy the frames for the send thread, the queued packets keep their capacity.
+		Bit::Uint64 coalescedFrames = 0;
+		Bit::Uint64 droppedFrames = 0;
+		m_FrameMutex.Lock( );
+		m_MessageBatcher.Flush( [ this, &coalescedFrames, &droppedFrames ] ( const Bit::Uint16 p_UserId, const Packet & p_Frame )
+		{
+			if( m_QueuedFrameCount < MaxQueuedFrames )
+			{
+				QueuedFrame & frame = m_QueuedFrames[ m_QueuedFrameCount++ ];
+				frame.UserId = p_UserId;
+				frame.Frame.Assign( p_Frame.GetData( ), p_Frame.GetSize( ) );
+				return;
+			}
+
+			// The send thread stalls. The records of a frame follow each other, so appending
+			// them to the last queued frame of the user keeps them reliable and ordered.
+			for( Bit::SizeType i = MaxQueuedFrames; i > 0; i-- )
+			{
+				QueuedFrame & frame = m_QueuedFrames[ i - 1 ];
+				if( frame.UserId == p_UserId )
+				{
+					frame.Frame.WriteArray( p_Frame.GetData( ), p_Frame.GetSize( ) );
+					coalescedFrames++;
+					return;
+				}
+			}
+			droppedFrames++;
+		} );
+
+		// Later messages of the joined local client pass in-process, once its baseline went out.
+		if( m_PendingLocalUserId >= 0 )
+		{
+			m_QueuedLocalUserId = m_PendingLocalUserId;
+			m_QueuedLocalFrameCount = m_QueuedFrameCount;
+			m_PendingLocalUserId = -1;
+		}
+		m_FrameMutex.Unlock( );
+
+		if( coalescedFrames > 0 || droppedFrames > 0 )
+		{
+			m_TickMutex.Lock( );
+			m_TickStatistics.CoalescedFrames += coalescedFrames;
+			m_TickStatistics.DroppedFrames += droppedFrames;
+			m_TickMutex.Unlock( );
+		}
+	}
+
+	void Server::SendFrames( )
+	{
+		// Take the frames of the ticks since the last call.
+		m_FrameMutex.Lock( );
+		m_SendingFrames.swap( m_QueuedFrames );
+		const Bit::SizeType frameCount = m_QueuedFrameCount;
+		const Bit::Int32 localUserId = m_QueuedLocalUserId;
+		const Bit::SizeType localFrameCount = m_QueuedLocalFrameCount;
+		m_QueuedFrameCount = 0;
+		m_QueuedLocalUserId = -1;
+		m_QueuedLocalFrameCount = 0;
+		m_FrameMutex.Unlock( );
+
+		for( Bit::SizeType i = 0; i < frameCount; i++ )
+		{
+			// The baseline went out, later messages of the joined local client pass in-process.
+			if( localUserId >= 0 && i == localFrameCount )
+			{
+				m_LocalUserId = localUserId;
+			}
+
+			const QueuedFrame & frame = m_SendingFrames[ i ];
+			TraceScope trace( "Send batch" );
+			if( SendLocal( frame.UserId, LocalMessage::Batch, frame.Frame ) )
+			{
+				continue;
+			}
+
+			// Create message and filter
+			Bit::Net::HostMessage * pMessage = CreateHostMessage( "Batch" );
+			Bit::Net::HostRecipientFilter * pFilter = CreateRecipientFilter( );
+
+			// Add the receiver.
+			pFilter->AddUser( frame.UserId );
+
+			// Add the frame to the message and send it.
+			pMessage->WriteArray( frame.Frame.GetData( ), frame.Frame.GetSize( ) );
+			pMessage->Send( pFilter );
+
+			// Clean up the pointers
+			delete pFilter;
+			delete pMessage;
+		}
+
+		if( localUserId >= 0 && localFrameCount == frameCount )
+		{
+			m_LocalUserId = localUserId;
+		}
+	}
+
+	void Server::QueueInput( const Bit::Uint16 p_UserId, const Bit::Bool p_Move, Packet & p_Message )
+	{
+		// Error check the slot of the user.
+		const Bit::Int32 slot = GetSlot( p_UserId );
+		if( slot < 0 )
+		{
+			return;
+		}
+
+		Input input;
+		input.Slot = static_cast<Bit::Uint8>( slot );
+		input.IsMoving = p_Move;
+		input.Direction = p_Move ? static_cast<eDirection>( p_Message.ReadByte( ) ) : eDirection::Up;
+		input.Tick = p_Message.ReadUint32( );
+		input.Offset = p_Message.ReadUint32( );
+		if( p_Message.IsValid( ) == false )
+		{
+			return;
+		}
+
+		// The inputs are applied by the tick, at their offset within the step.
+		// Drop the inputs of a flooding client, without touching the other slot.
+		m_InputMutex.Lock( );
+		Bit::SizeType queued = 0;
+		for( Bit::SizeType i = 0; i < m_Inputs.size( ); i++ )
+		{
+			queued += m_Inputs[ i ].Slot == input.Slot ? 1 : 0;
+		}
+		if( queued < MaxQueuedInputs )
+		{
+			m_Inputs.push_back( input );
+		}
+		m_InputMutex.Unlock( );
+	}
+
+	void Server::QueuePing( const Bit::Uint16 p_UserId, Packet & p_Message )
+	{
+		Ping ping;
+		ping.UserId = p_UserId;
+		ping.Sequence = p_Message.ReadUint32( );
+		ping.ClientSend = p_Message.ReadUint64( );
+		ping.ServerReceive = GetTime( );
+		if( p_Message.IsValid( ) == false )
+		{
+			return;
+		}
+
+		// Drop pings beyond the reserved capacity, the client pings again.
+		m_PingMutex.Lock( );
+		if( m_Pings.size( ) < m_Pings.capacity( ) )
+		{
+			m_Pings.push_back( ping );
+		}
+		m_PingMutex.Unlock( );
+	}
+
+	void Server::AckSnapshot( const Bit::Uint16 p_UserId, Packet & p_Message )
+	{
+		const Bit::Uint32 sequence = p_Message.ReadUint32( );
+		const Bit::Uint32 bits = p_Message.ReadUint32( );
+		const Bit::Uint64 time = GetTime( );
+		if( p_Message.IsValid( ) == false )
+		{
+			return;
+		}
+
+		m_SnapshotMutex.Lock( );
+		std::map<Bit::Uint16, SnapshotController>::iterator it = m_SnapshotControllers.find( p_UserId );
+		if( it != m_SnapshotControllers.end( ) )
+		{
+			it->second.OnAck( sequence, bits, time );
+		}
+		m_SnapshotMutex.Unlock( );
+	}
+
+	void Server::ReceiveLocalMessages( )
+	{
+		const Bit::Int32 userId = m_LocalUserId.load( );
+		if( userId < 0 )
+		{
+			return;
+		}
+
+		// Handled like the network messages, the payloads are the same.
+		Bit::Uint8 type = 0;
+		Bit::SizeType size = 0;
+		const Bit::Uint8 * pData = NULL;
+		while( ( pData = m_LocalTransport.Upstream.Read( type, size ) ) != NULL )
+		{
+			m_LocalMessage.Assign( pData, size );
+			m_LocalTransport.Upstream.Pop( );
+
+			switch( type )
+			{
+				case LocalMessage::Move:
+				case LocalMessage::StopMove:
+				{
+					QueueInput( static_cast<Bit::Uint16>( userId ), type == LocalMessage::Move, m_LocalMessage );
+				}
+				break;
+				case LocalMessage::TimeSync:
+				{
+					QueuePing( static_cast<Bit::Uint16>( userId ), m_LocalMessage );
+				}
+				break;
+				case LocalMessage::SnapshotAck:
+				{
+					AckSnapshot( static_cast<Bit::Uint16>( userId ), m_LocalMessage );
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+	}
+
+	Bit::Bool Server::SendLocal( const Bit::Uint16 p_UserId, const LocalMessage::eType p_Type, const Packet & p_Message )
+	{
+		Bit::Int32 userId = static_cast<Bit::Int32>( p_UserId );
+		if( m_LocalUserId.load( ) != userId )
+		{
+			// The batches of an overflowed client are discarded, it reconnects.
+			return p_Type == LocalMessage::Batch && m_OverflowUserId.load( ) == userId;
+		}
+
+		// The snapshots are unreliable, they leave half of the ring to the batches.
+		MessageRing & ring = m_LocalTransport.Downstream;
+		const Bit::Bool write = p_Type != LocalMessage::Snapshot || ring.GetUsedSize( ) < ring.GetCapacity( ) / 2;
+		const Bit::Bool written = write && ring.Write( static_cast<Bit::Uint8>( p_Type ), p_Message.GetData( ), p_Message.GetSize( ) );
+		if( written || p_Type != LocalMessage::Batch )
+		{
+			return written;
+		}
+
+		// A batch over the network could overtake the batches in the ring,
+		// drop the client from the local transport instead, it stopped reading for long.
+		std::cout << "Local transport of user " << p_UserId << " overflowed, dropping it." << std::endl;
+		m_OverflowUserId = userId;
+		m_LocalUserId.compare_exchange_strong( userId, -1 );
+		m_LocalTransport.Overflow = true;
+		return true;
+	}
+
+	LocalTransport * Server::GetLocalTransport( const Bit::Uint16 p_Port )
+	{
+		return m_Port != 0 && m_Port == p_Port ? &m_LocalTransport : NULL;
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,169 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Snapshot.hpp>
+#include <Field.hpp>
+#include <EntitySchema.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Quantized positions cover the field and a margin around it.
+	static const Bit::Float32 g_QuantizeMargin = 1.0f;
+
+	static Bit::Uint16 Quantize( const Bit::Float32 p_Value, const Bit::Float32 p_Size )
+	{
+		const Bit::Float32 unit = ( p_Value + g_QuantizeMargin ) / ( p_Size + g_QuantizeMargin * 2.0f );
+		const Bit::Float32 clamped = unit < 0.0f ? 0.0f : ( unit > 1.0f ? 1.0f : unit );
+		return static_cast<Bit::Uint16>( clamped * 65535.0f + 0.5f );
+	}
+
+	static Bit::Float32 Dequantize( const Bit::Uint16 p_Value, const Bit::Float32 p_Size )
+	{
+		return static_cast<Bit::Float32>( p_Value ) / 65535.0f * ( p_Size + g_QuantizeMargin * 2.0f ) - g_QuantizeMargin;
+	}
+
+	static_assert(	Snapshot::HeaderSize == SnapshotSchema::Header::Size + SnapshotSchema::Player::Size * 2,
+					"The snapshot header size does not match the schema." );
+
+	Bit::SizeType Snapshot::GetBallSize( const Bit::Uint32 p_Level )
+	{
+		return p_Level == 0 ? SnapshotSchema::Ball::Size : SnapshotSchema::QuantizedBall::Size;
+	}
+
+	void Snapshot::Write(	Packet & p_Packet, const Header & p_Header,
+							const BallStates & p_Balls, const PlayerStates & p_Players )
+	{
+		// Grow the packet once and write every record at its fixed offset.
+		const Bit::SizeType start = p_Packet.GetSize( );
+		p_Packet.Resize( start + HeaderSize + p_Header.BallCount * GetBallSize( p_Header.Level ) );
+		Bit::Uint8 * pRecord = p_Packet.GetData( ) + start;
+
+		SnapshotSchema::Header::Sequence::Write( pRecord, p_Header.Sequence );
+		SnapshotSchema::Header::Tick::Write( pRecord, p_Header.Tick );
+		SnapshotSchema::Header::Level::Write( pRecord, static_cast<Bit::Uint8>( p_Header.Level ) );
+		SnapshotSchema::Header::FirstBall::Write( pRecord, p_Header.FirstBall );
+		SnapshotSchema::Header::BallCount::Write( pRecord, p_Header.BallCount );
+		SnapshotSchema::Header::TotalBallCount::Write( pRecord, p_Header.TotalBallCount );
+		pRecord += SnapshotSchema::Header::Size;
+
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			SnapshotSchema::Player::PositionX::Write( pRecord, p_Players.PositionX[ i ] );
+			SnapshotSchema::Player::PositionY::Write( pRecord, p_Players.PositionY[ i ] );
+			pRecord += SnapshotSchema::Player::Size;
+		}
+
+		if( p_Header.Level == 0 )
+		{
+			for( Bit::SizeType i = 0; i < p_Header.BallCount; i++ )
+			{
+				const Bit::SizeType ball = ( p_Header.FirstBall + i ) % p_Header.TotalBallCount;
+				SnapshotSchema::Ball::PositionX::Write( pRecord, p_Balls.PositionX[ ball ] );
+				SnapshotSchema::Ball::PositionY::Write( pRecord, p_Balls.PositionY[ ball ] );
+				SnapshotSchema::Ball::Rotation::Write( pRecord, static_cast<Bit::Float32>( p_Balls.Rotation[ ball ] ) );
+				pRecord += SnapshotSchema::Ball::Size;
+			}
+		}
+		else
+		{
+			for( Bit::SizeType i = 0; i < p_Header.BallCount; i++ )
+			{
+				const Bit::SizeType ball = ( p_Header.FirstBall + i ) % p_Header.TotalBallCount;
+				SnapshotSchema::QuantizedBall::PositionX::Write( pRecord, Quantize( p_Balls.PositionX[ ball ], Field::Width ) );
+				SnapshotSchema::QuantizedBall::PositionY::Write( pRecord, Quantize( p_Balls.PositionY[ ball ], Field::Height ) );
+				pRecord += SnapshotSchema::QuantizedBall::Size;
+			}
+		}
+	}
+
+	Bit::Bool Snapshot::Read(	Packet & p_Packet, Header & p_Header,
+								BallStates & p_Balls, PlayerStates & p_Players )
+	{
+		if( p_Packet.GetRemainingSize( ) < HeaderSize )
+		{
+			return false;
+		}
+
+		const Bit::Uint8 * pRecord = p_Packet.GetData( ) + p_Packet.GetReadPosition( );
+
+		p_Header.Sequence = SnapshotSchema::Header::Sequence::Read( pRecord );
+		p_Header.Tick = SnapshotSchema::Header::Tick::Read( pRecord );
+		p_Header.Level = SnapshotSchema::Header::Level::Read( pRecord );
+		p_Header.FirstBall = SnapshotSchema::Header::FirstBall::Read( pRecord );
+		p_Header.BallCount = SnapshotSchema::Header::BallCount::Read( pRecord );
+		p_Header.TotalBallCount = SnapshotSchema::Header::TotalBallCount::Read( pRecord );
+		pRecord += SnapshotSchema::Header::Size;
+
+		// Error check the ball range and the message size.
+		const Bit::SizeType size = HeaderSize + p_Header.BallCount * GetBallSize( p_Header.Level );
+		if( p_Header.BallCount > p_Header.TotalBallCount || p_Header.FirstBall >= p_Header.TotalBallCount ||
+			p_Packet.GetRemainingSize( ) < size )
+		{
+			p_Packet.Skip( SnapshotSchema::Header::Size );
+			return false;
+		}
+
+		if( p_Players.GetCount( ) < 2 )
+		{
+			p_Players.Resize( 2 );
+		}
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			p_Players.PositionX[ i ] = SnapshotSchema::Player::PositionX::Read( pRecord );
+			p_Players.PositionY[ i ] = SnapshotSchema::Player::PositionY::Read( pRecord );
+			pRecord += SnapshotSchema::Player::Size;
+		}
+
+		if( p_Balls.GetCount( ) < p_Header.TotalBallCount )
+		{
+			p_Balls.Resize( p_Header.TotalBallCount );
+		}
+		if( p_Header.Level == 0 )
+		{
+			for( Bit::SizeType i = 0; i < p_Header.BallCount; i++ )
+			{
+				const Bit::SizeType ball = ( p_Header.FirstBall + i ) % p_Header.TotalBallCount;
+				p_Balls.PositionX[ ball ] = SnapshotSchema::Ball::PositionX::Read( pRecord );
+				p_Balls.PositionY[ ball ] = SnapshotSchema::Ball::PositionY::Read( pRecord );
+				p_Balls.Rotation[ ball ] = static_cast<Bit::Float64>( SnapshotSchema::Ball::Rotation::Read( pRecord ) );
+				pRecord += SnapshotSchema::Ball::Size;
+			}
+		}
+		else
+		{
+			for( Bit::SizeType i = 0; i < p_Header.BallCount; i++ )
+			{
+				const Bit::SizeType ball = ( p_Header.FirstBall + i ) % p_Header.TotalBallCount;
+				p_Balls.PositionX[ ball ] = Dequantize( SnapshotSchema::QuantizedBall::PositionX::Read( pRecord ), Field::Width );
+				p_Balls.PositionY[ ball ] = Dequantize( SnapshotSchema::QuantizedBall::PositionY::Read( pRecord ), Field::Height );
+				pRecord += SnapshotSchema::QuantizedBall::Size;
+			}
+		}
+
+		p_Packet.Skip( size );
+		return true;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,285 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <SnapshotController.hpp>
+#include <Snapshot.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// The link is judged once per period, in microseconds.
+	static const Bit::Uint64 g_PeriodLength = 500000;
+
+	// Loss rate and round trip growth treated as congestion.
+	static const Bit::Float32 g_CongestionLoss = 0.05f;
+	static const Bit::Uint64 g_CongestionDelay = 50000;
+
+	// Multiplicative decrease of the budget on congestion.
+	static const Bit::Float64 g_DecreaseFactor = 0.7;
+
+	// Sequences further back than the acknowledgement bits are lost.
+	static const Bit::Uint32 g_AckBits = 32;
+
+	// Limits structure
+	SnapshotController::Limits::Limits( ) :
+		TickRate( 60 ),
+		MinInterval( 1 ),
+		MaxInterval( 6 ),
+		MinBandwidth( 2000 ),
+		MaxBandwidth( 64000 )
+	{
+	}
+
+	// Snapshot controller class
+	SnapshotController::SnapshotController( const Limits & p_Limits, const Bit::SizeType p_BallCount ) :
+		m_Limits( p_Limits ),
+		m_BallCount( p_BallCount ),
+		m_Sequence( 1 ),
+		m_FirstBall( 0 ),
+		m_LastTick( 0 ),
+		m_HasSent( false ),
+		m_Level( 0 ),
+		m_Interval( p_Limits.MinInterval ),
+		m_Budget( p_Limits.MaxBandwidth * 0.5 ),
+		m_PeriodStart( 0 ),
+		m_PeriodSent( 0 ),
+		m_PeriodAcked( 0 ),
+		m_PeriodLost( 0 ),
+		m_PeriodBytes( 0 ),
+		m_DeliveryRate( 0 ),
+		m_LossRate( 0.0f ),
+		m_RoundTrip( 0 ),
+		m_MinRoundTrip( 0 )
+	{
+		for( Bit::SizeType i = 0; i < HistorySize; i++ )
+		{
+			m_History[ i ].Sequence = 0;
+			m_History[ i ].Size = 0;
+			m_History[ i ].Time = 0;
+			m_History[ i ].Pending = false;
+		}
+
+		ChooseRate( );
+	}
+
+	Bit::Bool SnapshotController::IsDue( const Bit::Uint32 p_Tick ) const
+	{
+		return m_HasSent == false || p_Tick - m_LastTick >= m_Interval;
+	}
+
+	Bit::Uint32 SnapshotController::GetLevel( ) const
+	{
+		return m_Level;
+	}
+
+	Bit::Uint32 SnapshotController::GetInterval( ) const
+	{
+		return m_Interval;
+	}
+
+	Bit::Uint32 SnapshotController::GetSequence( ) const
+	{
+		return m_Sequence;
+	}
+
+	Bit::Uint16 SnapshotController::GetFirstBall( ) const
+	{
+		return m_FirstBall;
+	}
+
+	Bit::Uint32 SnapshotController::OnSent( const Bit::Uint32 p_Tick, const Bit::SizeType p_Size, const Bit::Uint64 p_Time )
+	{
+		// A record still pending when its slot is reused was never acknowledged.
+		Record & record = m_History[ m_Sequence % HistorySize ];
+		if( record.Pending )
+		{
+			m_PeriodLost++;
+		}
+
+		record.Sequence = m_Sequence;
+		record.Size = static_cast<Bit::Uint32>( p_Size );
+		record.Time = p_Time;
+		record.Pending = true;
+
+		m_HasSent = true;
+		m_LastTick = p_Tick;
+		m_PeriodSent++;
+
+		if( m_BallCount > 0 )
+		{
+			m_FirstBall = static_cast<Bit::Uint16>( ( m_FirstBall + GetBallCount( m_Level, m_BallCount ) ) % m_BallCount );
+		}
+
+		return m_Sequence++;
+	}
+
+	void SnapshotController::OnAck( const Bit::Uint32 p_Sequence, const Bit::Uint32 p_Bits, const Bit::Uint64 p_Time )
+	{
+		if( p_Sequence >= m_Sequence )
+		{
+			return;
+		}
+
+		Acknowledge( p_Sequence, p_Time );
+		for( Bit::Uint32 i = 0; i < g_AckBits && i + 1 < p_Sequence; i++ )
+		{
+			if( p_Bits & ( 1U << i ) )
+			{
+				Acknowledge( p_Sequence - 1 - i, p_Time );
+			}
+		}
+
+		// Older snapshots can no longer be acknowledged.
+		for( Bit::SizeType i = 0; i < HistorySize; i++ )
+		{
+			Record & record = m_History[ i ];
+			if( record.Pending && record.Sequence + g_AckBits < p_Sequence )
+			{
+				record.Pending = false;
+				m_PeriodLost++;
+			}
+		}
+	}
+
+	void SnapshotController::Update( const Bit::Uint64 p_Time )
+	{
+		if( m_PeriodStart == 0 )
+		{
+			m_PeriodStart = p_Time;
+			return;
+		}
+
+		const Bit::Uint64 elapsed = p_Time - m_PeriodStart;
+		if( elapsed < g_PeriodLength )
+		{
+			return;
+		}
+
+		// Judge the link of the period.
+		const Bit::Uint32 judged = m_PeriodAcked + m_PeriodLost;
+		m_LossRate = judged ? static_cast<Bit::Float32>( m_PeriodLost ) / static_cast<Bit::Float32>( judged ) : 0.0f;
+		m_DeliveryRate = static_cast<Bit::Uint32>( m_PeriodBytes * 1000000 / elapsed );
+
+		const Bit::Uint64 delayLimit = m_MinRoundTrip / 2 > g_CongestionDelay ? m_MinRoundTrip / 2 : g_CongestionDelay;
+		const Bit::Bool lossy = judged >= 4 && m_LossRate > g_CongestionLoss;
+		const Bit::Bool queued = m_RoundTrip > m_MinRoundTrip + delayLimit;
+		const Bit::Bool silent = m_PeriodSent > 0 && m_PeriodAcked == 0;
+
+		// Additive increase, multiplicative decrease.
+		if( lossy || queued || silent )
+		{
+			m_Budget *= g_DecreaseFactor;
+		}
+		else
+		{
+			m_Budget += m_Limits.MaxBandwidth / 64.0;
+		}
+		m_Budget = m_Budget < m_Limits.MinBandwidth ? m_Limits.MinBandwidth : m_Budget;
+		m_Budget = m_Budget > m_Limits.MaxBandwidth ? m_Limits.MaxBandwidth : m_Budget;
+
+		m_PeriodStart = p_Time;
+		m_PeriodSent = 0;
+		m_PeriodAcked = 0;
+		m_PeriodLost = 0;
+		m_PeriodBytes = 0;
+
+		ChooseRate( );
+	}
+
+	Bit::SizeType SnapshotController::GetSnapshotSize( const Bit::Uint32 p_Level, const Bit::SizeType p_BallCount )
+	{
+		return Snapshot::HeaderSize + GetBallCount( p_Level, p_BallCount ) * Snapshot::GetBallSize( p_Level );
+	}
+
+	Bit::SizeType SnapshotController::GetBallCount( const Bit::Uint32 p_Level, const Bit::SizeType p_BallCount )
+	{
+		if( p_Level <= 1 || p_BallCount == 0 )
+		{
+			return p_BallCount;
+		}
+
+		const Bit::SizeType count = p_BallCount >> ( p_Level - 1 );
+		return count > 0 ? count : 1;
+	}
+
+	Bit::Uint32 SnapshotController::GetBudget( ) const
+	{
+		return static_cast<Bit::Uint32>( m_Budget );
+	}
+
+	Bit::Uint32 SnapshotController::GetDeliveryRate( ) const
+	{
+		return m_DeliveryRate;
+	}
+
+	Bit::Float32 SnapshotController::GetLossRate( ) const
+	{
+		return m_LossRate;
+	}
+
+	Bit::Uint64 SnapshotController::GetRoundTripTime( ) const
+	{
+		return m_RoundTrip;
+	}
+
+	void SnapshotController::Acknowledge( const Bit::Uint32 p_Sequence, const Bit::Uint64 p_Time )
+	{
+		Record & record = m_History[ p_Sequence % HistorySize ];
+		if( record.Pending == false || record.Sequence != p_Sequence )
+		{
+			return;
+		}
+
+		record.Pending = false;
+		m_PeriodAcked++;
+		m_PeriodBytes += record.Size;
+
+		const Bit::Uint64 roundTrip = p_Time > record.Time ? p_Time - record.Time : 0;
+		m_RoundTrip = m_RoundTrip == 0 ? roundTrip : ( m_RoundTrip * 7 + roundTrip ) / 8;
+		m_MinRoundTrip = m_MinRoundTrip == 0 || roundTrip < m_MinRoundTrip ? roundTrip : m_MinRoundTrip;
+	}
+
+	void SnapshotController::ChooseRate( )
+	{
+		// The most frequent snapshots first, then the most detailed ones, that fit the budget.
+		for( Bit::Uint32 interval = m_Limits.MinInterval; interval <= m_Limits.MaxInterval; interval++ )
+		{
+			for( Bit::Uint32 level = 0; level <= MaxLevel; level++ )
+			{
+				const Bit::Float64 cost =	static_cast<Bit::Float64>( GetSnapshotSize( level, m_BallCount ) ) *
+											static_cast<Bit::Float64>( m_Limits.TickRate ) / static_cast<Bit::Float64>( interval );
+				if( cost <= m_Budget )
+				{
+					m_Interval = interval;
+					m_Level = level;
+					return;
+				}
+			}
+		}
+
+		m_Interval = m_Limits.MaxInterval;
+		m_Level = MaxLevel;
+	}
+
+}
\ No newline at end of file
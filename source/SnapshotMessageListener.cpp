@@ -0,0 +1,124 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <SnapshotMessageListener.hpp>
+#include <Snapshot.hpp>
+#include <Client.hpp>
+#include <Trace.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	SnapshotMessageListener::SnapshotMessageListener( Client * p_pClient ) :
+		m_pClient( p_pClient )
+	{
+	}
+
+	void SnapshotMessageListener::HandleMessage( Bit::Net::HostMessageDecoder & p_Message )
+	{
+		TraceScope trace( "SnapshotMessageListener::HandleMessage" );
+
+		// Copy the snapshot out of the decoder.
+		const Bit::SizeType size = p_Message.GetMessageSize( );
+		if( size == 0 )
+		{
+			return;
+		}
+		m_Message.Resize( size );
+		p_Message.ReadArray( m_Message.GetData( ), size );
+		m_Message.Rewind( );
+
+		Apply( );
+	}
+
+	void SnapshotMessageListener::HandleSnapshot( const Bit::Uint8 * p_pData, const Bit::SizeType p_Size )
+	{
+		TraceScope trace( "SnapshotMessageListener::HandleSnapshot" );
+
+		m_Message.Assign( p_pData, p_Size );
+		Apply( );
+	}
+
+	void SnapshotMessageListener::Apply( )
+	{
+		Snapshot::Header header;
+		if( Snapshot::Read( m_Message, header, m_Balls, m_Players ) == false || header.Sequence == 0 )
+		{
+			return;
+		}
+
+		m_pClient->m_SnapshotMutex.Lock( );
+
+		// Acknowledge the snapshot, the bits cover the 32 sequences before the newest one.
+		Bit::Bool newest = false;
+		if( header.Sequence > m_pClient->m_SnapshotAck )
+		{
+			const Bit::Uint32 shift = header.Sequence - m_pClient->m_SnapshotAck;
+			Bit::Uint32 bits = 0;
+			if( m_pClient->m_SnapshotAck != 0 && shift <= 32 )
+			{
+				bits = ( shift < 32 ? m_pClient->m_SnapshotAckBits << shift : 0 ) | ( 1U << ( shift - 1 ) );
+			}
+			m_pClient->m_SnapshotAck = header.Sequence;
+			m_pClient->m_SnapshotAckBits = bits;
+			newest = true;
+		}
+		else if( header.Sequence < m_pClient->m_SnapshotAck && m_pClient->m_SnapshotAck - header.Sequence <= 32 )
+		{
+			m_pClient->m_SnapshotAckBits |= 1U << ( m_pClient->m_SnapshotAck - header.Sequence - 1 );
+		}
+		m_pClient->m_SnapshotAckPending = true;
+
+		m_pClient->m_SnapshotMutex.Unlock( );
+
+		// Reordered snapshots are acknowledged, but older than the applied state.
+		if( newest == false )
+		{
+			return;
+		}
+
+		for( Bit::SizeType i = 0; i < 2; i++ )
+		{
+			m_pClient->m_pPlayers[ i ]->Position.Set( Bit::Vector2f32( m_Players.PositionX[ i ], m_Players.PositionY[ i ] ) );
+		}
+
+		const Bit::SizeType ballCount = m_pClient->m_Balls.GetCount( );
+		for( Bit::SizeType i = 0; i < header.BallCount; i++ )
+		{
+			const Bit::SizeType index = ( header.FirstBall + i ) % header.TotalBallCount;
+			if( index >= ballCount )
+			{
+				continue;
+			}
+
+			Ball * pBall = m_pClient->m_Balls.Get( index );
+			pBall->Position.Set( Bit::Vector2f32( m_Balls.PositionX[ index ], m_Balls.PositionY[ index ] ) );
+			if( header.Level == 0 )
+			{
+				pBall->Rotation.Set( m_Balls.Rotation[ index ] );
+			}
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,324 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+// Soak test, runs a match through the network emulator and reports problems.
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <Client.hpp>
+#include <Server.hpp>
+#include <NetEmulator.hpp>
+#include <Field.hpp>
+#include <Trace.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+// Global functions
+
+// Xorshift random number generator.
+static Bit::Uint32 NextRandom( Bit::Uint32 & p_State )
+{
+	p_State ^= p_State << 13;
+	p_State ^= p_State >> 17;
+	p_State ^= p_State << 5;
+	return p_State;
+}
+
+// Main function
+int main( int argc, char ** argv )
+{
+	// Init memory check.
+	BitInitMemoryLeak( NULL );
+
+	// Local variables
+	const Bit::Uint16	serverPort		= 1340;
+	const Bit::Uint16	proxyPort		= 1341;
+	const Bit::Uint32	localhost		= 0x7F000001;
+	const Bit::Time		sampleTime		= Bit::Milliseconds( 50 );
+	Bit::Float64		duration		= 3600.0;
+	Bit::Float64		reportInterval	= 10.0;
+	Bit::Uint32			seed			= 1;
+	Pong::ServerSettings settings;
+	Pong::NetConditions conditions;
+	std::string			tracePath;
+
+	// Read the arguments, all of them take a value.
+	// Durations are in seconds, latency and jitter in milliseconds, rates in percent and the bandwidth in kB/s.
+	for( int i = 1; i + 1 < argc; i += 2 )
+	{
+		const std::string argument = argv[ i ];
+		const std::string value = argv[ i + 1 ];
+
+		if( argument == "-duration" )
+		{
+			duration = std::stod( value );
+		}
+		else if( argument == "-report" )
+		{
+			reportInterval = std::stod( value );
+		}
+		else if( argument == "-seed" )
+		{
+			seed = static_cast<Bit::Uint32>( std::stoul( value ) );
+		}
+		else if( argument == "-latency" )
+		{
+			conditions.Latency = Bit::Milliseconds( std::stoul( value ) );
+		}
+		else if( argument == "-jitter" )
+		{
+			conditions.Jitter = Bit::Milliseconds( std::stoul( value ) );
+		}
+		else if( argument == "-loss" )
+		{
+			conditions.LossRate = std::stof( value ) / 100.0f;
+		}
+		else if( argument == "-duplicate" )
+		{
+			conditions.DuplicateRate = std::stof( value ) / 100.0f;
+		}
+		else if( argument == "-reorder" )
+		{
+			conditions.ReorderRate = std::stof( value ) / 100.0f;
+		}
+		else if( argument == "-bandwidth" )
+		{
+			conditions.Bandwidth = static_cast<Bit::Uint32>( std::stoul( value ) ) * 1000;
+		}
+		else if( argument == "-matches" )
+		{
+			settings.MatchCount = static_cast<Bit::SizeType>( std::stoul( value ) );
+		}
+		else if( argument == "-workers" )
+		{
+			settings.WorkerCount = static_cast<Bit::SizeType>( std::stoul( value ) );
+		}
+		else if( argument == "-balls" )
+		{
+			settings.BallCount = static_cast<Bit::Uint16>( std::stoul( value ) );
+		}
+		else if( argument == "-mode" )
+		{
+			settings.Mode = value == "multiball" ? Pong::GameMode::MultiBall : Pong::GameMode::Classic;
+		}
+		else if( argument == "-trace" )
+		{
+			tracePath = value;
+			Pong::Trace::Enable( true );
+			Pong::Trace::SetThreadName( "Soak client" );
+		}
+	}
+
+	// Host the server behind the emulator.
+	Pong::Server * pServer = new Pong::Server( settings );
+	if( pServer->Host( serverPort ) == false )
+	{
+		std::cout << "Failed to host server." << std::endl;
+		delete pServer;
+		return 2;
+	}
+
+	Pong::NetEmulator emulator;
+	emulator.SetConditions( Pong::NetEmulator::Upstream, conditions );
+	emulator.SetConditions( Pong::NetEmulator::Downstream, conditions );
+	if( emulator.Start( proxyPort, localhost, serverPort, seed ) == false )
+	{
+		std::cout << "Failed to start the network emulator." << std::endl;
+		delete pServer;
+		return 2;
+	}
+
+	Pong::Client * pClient = new Pong::Client;
+	if( pClient->Join( pServer, Bit::Address::Localhost, proxyPort, Bit::Seconds( 5.0f ) ) == false )
+	{
+		std::cout << "Failed to connect through the network emulator." << std::endl;
+		delete pClient;
+		delete pServer;
+		return 2;
+	}
+
+	// Time for a command to reach the server and the result to come back.
+	const Bit::Float64 settleTime =	( conditions.Latency.AsSeconds( ) + conditions.Jitter.AsSeconds( ) ) * 2.0 +
+									conditions.ReorderDelay.AsSeconds( ) * 2.0 + 0.5;
+	const Bit::Float32 desyncDistance = static_cast<Bit::Float32>( Pong::Field::PlayerSpeed * settleTime ) + 0.1f;
+
+	// A client without a slot only watches, there is no paddle to soak.
+	const Bit::Uint16 userId = pClient->GetUserId( );
+	if( userId >= 2 )
+	{
+		std::cout << "The client got no player slot." << std::endl;
+		delete pClient;
+		delete pServer;
+		return 2;
+	}
+	Pong::Player * pServerPlayer = pServer->GetPlayer( userId );
+	Pong::Player * pClientPlayer = pClient->GetPlayer( userId );
+
+	// Soak state
+	Bit::Uint32 random = seed ? seed : 0x9E3779B9;
+	Bit::Bool moving = false;
+	Bit::Bool commandChecked = true;
+	Bit::Float64 commandTime = 0.0;
+	Bit::Float64 nextCommandTime = 0.0;
+	Bit::Float64 desyncStart = 0.0;
+	Bit::Bool desynced = false;
+	Bit::Bool desyncReported = false;
+	Bit::Float64 nextReportTime = reportInterval;
+	Bit::Float32 lastServerY = pServerPlayer->Position.Get( ).y;
+	Bit::Uint64 desyncs = 0;
+	Bit::Uint64 stuckPaddles = 0;
+	Bit::Uint64 commands = 0;
+	Bit::Bool disconnected = false;
+	Pong::NetEmulator::Statistics lastUpstream;
+	Pong::NetEmulator::Statistics lastDownstream;
+
+	Bit::Timer timer;
+	timer.Start( );
+
+	std::cout << "Soaking for " << duration << " seconds." << std::endl;
+
+	while( true )
+	{
+		Bit::Sleep( sampleTime );
+		const Bit::Float64 now = timer.GetLapsedTime( ).AsSeconds( );
+
+		if( pClient->IsConnected( ) == false )
+		{
+			std::cout << "[" << now << "] Client disconnected." << std::endl;
+			disconnected = true;
+			break;
+		}
+
+		// Keep the server clock in sync and acknowledge the snapshots, like the game loop does.
+		pClient->UpdateTimeSync( );
+		pClient->SendSnapshotAck( );
+
+		const Bit::Float32 serverY = pServerPlayer->Position.Get( ).y;
+		const Bit::Float32 clientY = pClientPlayer->Position.Get( ).y;
+		const Bit::Bool serverMoved = std::fabs( serverY - lastServerY ) > 0.0001f;
+		lastServerY = serverY;
+
+		// A paddle is stuck if it still moves long after a stop, or does not move long after a move.
+		if( commandChecked == false && now - commandTime > settleTime )
+		{
+			if( serverMoved != moving )
+			{
+				stuckPaddles++;
+				std::cout << "[" << now << "] Stuck paddle, " << ( moving ? "not moving" : "still moving" ) << " after command " << commands << "." << std::endl;
+			}
+			commandChecked = true;
+		}
+
+		// The client view desyncs if it stays away from the server view for longer than it takes to settle.
+		if( std::fabs( serverY - clientY ) > desyncDistance )
+		{
+			if( desynced == false )
+			{
+				desynced = true;
+				desyncStart = now;
+			}
+			else if( desyncReported == false && now - desyncStart > settleTime )
+			{
+				desyncs++;
+				desyncReported = true;
+				std::cout << "[" << now << "] Desync, server " << serverY << ", client " << clientY << "." << std::endl;
+			}
+		}
+		else
+		{
+			desynced = false;
+			desyncReported = false;
+		}
+
+		// Alternate between moving towards the center and standing still.
+		if( now >= nextCommandTime )
+		{
+			if( moving )
+			{
+				pClient->SendStopMove( );
+			}
+			else
+			{
+				pClient->SendMove( serverY < Pong::Field::Height * 0.5f ? Pong::eDirection::Up : Pong::eDirection::Down );
+			}
+			moving = !moving;
+			commands++;
+			commandTime = now;
+			commandChecked = false;
+			nextCommandTime = now + settleTime + static_cast<Bit::Float64>( NextRandom( random ) % 1000 ) / 1000.0;
+		}
+
+		// Report
+		const Bit::Bool finished = now >= duration;
+		if( now >= nextReportTime || finished )
+		{
+			const Pong::Server::TickStatistics ticks = pServer->GetTickStatistics( );
+			const Pong::NetEmulator::Statistics upstream = emulator.GetStatistics( Pong::NetEmulator::Upstream );
+			const Pong::NetEmulator::Statistics downstream = emulator.GetStatistics( Pong::NetEmulator::Downstream );
+			const Bit::Float64 interval = reportInterval > 0.0 ? reportInterval : 1.0;
+
+			std::cout	<< "[" << now << "] ticks " << ticks.Ticks
+						<< ", overruns " << ticks.Overruns
+						<< ", max tick " << ticks.MaxTickTime.AsMilliseconds( ) << " ms"
+						<< ", physics level " << ticks.QualityLevel
+						<< ", rtt " << pClient->GetRoundTripTime( ).AsMilliseconds( ) << " ms"
+						<< ", up " << static_cast<Bit::Float64>( upstream.Bytes - lastUpstream.Bytes ) / interval / 1000.0 << " kB/s"
+						<< ", down " << static_cast<Bit::Float64>( downstream.Bytes - lastDownstream.Bytes ) / interval / 1000.0 << " kB/s"
+						<< ", lost " << upstream.Lost + downstream.Lost
+						<< ", dropped " << upstream.Dropped + downstream.Dropped
+						<< ", desyncs " << desyncs
+						<< ", stuck paddles " << stuckPaddles << std::endl;
+
+			lastUpstream = upstream;
+			lastDownstream = downstream;
+			nextReportTime += reportInterval;
+		}
+
+		if( finished )
+		{
+			break;
+		}
+	}
+
+	// Write the timeline in the server clock.
+	if( tracePath.empty( ) == false )
+	{
+		Pong::Trace::Enable( false );
+		const Bit::Int64 clockOffset = static_cast<Bit::Int64>( pServer->GetTime( ) ) - static_cast<Bit::Int64>( Pong::Trace::GetTime( ) );
+		if( Pong::Trace::Write( tracePath, "NetPong soak test", clockOffset ) == false )
+		{
+			std::cout << "Failed to write trace to " << tracePath << "." << std::endl;
+		}
+	}
+
+	// Clean up
+	delete pClient;
+	emulator.Stop( );
+	delete pServer;
+
+	const Bit::Bool passed = disconnected == false && desyncs == 0 && stuckPaddles == 0;
+	std::cout << ( passed ? "Soak test passed." : "Soak test failed." ) << std::endl;
+	return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <TimeSync.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	// Drifts beyond this are treated as estimation noise, real clocks are within a few hundred ppm.
+	static const Bit::Float64 g_MaxDrift = 0.0005;
+
+	// Time span of the drift measurement, in microseconds.
+	static const Bit::Int64 g_MinDriftSpan = 60000000;
+	static const Bit::Int64 g_MaxDriftSpan = 600000000;
+
+	TimeSync::TimeSync( )
+	{
+		Reset( );
+	}
+
+	void TimeSync::Reset( )
+	{
+		m_SampleCount = 0;
+		m_RoundTrip = 0;
+		m_MinRoundTrip = 0;
+		m_Offset = 0;
+		m_BaseTime = 0;
+		m_Drift = 0.0;
+		m_AnchorSet = false;
+		m_AnchorTime = 0;
+		m_AnchorOffset = 0;
+	}
+
+	Bit::Bool TimeSync::AddSample(	const Bit::Int64 p_ClientSend, const Bit::Int64 p_ServerReceive,
+									const Bit::Int64 p_ServerSend, const Bit::Int64 p_ClientReceive )
+	{
+		const Bit::Int64 roundTrip = ( p_ClientReceive - p_ClientSend ) - ( p_ServerSend - p_ServerReceive );
+		if( p_ClientReceive < p_ClientSend || p_ServerSend < p_ServerReceive || roundTrip < 0 )
+		{
+			return false;
+		}
+
+		Sample & sample = m_Samples[ m_SampleCount % WindowSize ];
+		sample.Time = p_ClientReceive;
+		sample.Offset = ( ( p_ServerReceive - p_ClientSend ) + ( p_ServerSend - p_ClientReceive ) ) / 2;
+		sample.RoundTrip = roundTrip;
+
+		// Smooth the round trip time like TCP does.
+		m_RoundTrip = m_SampleCount == 0 ? roundTrip : m_RoundTrip + ( roundTrip - m_RoundTrip ) / 8;
+		m_SampleCount++;
+
+		Estimate( );
+		return true;
+	}
+
+	Bit::Bool TimeSync::IsSynchronized( ) const
+	{
+		return m_SampleCount >= MinSamples;
+	}
+
+	Bit::Int64 TimeSync::GetServerTime( const Bit::Int64 p_ClientTime ) const
+	{
+		const Bit::Float64 drift = m_Drift * static_cast<Bit::Float64>( p_ClientTime - m_BaseTime );
+		return p_ClientTime + m_Offset + static_cast<Bit::Int64>( drift );
+	}
+
+	Bit::Int64 TimeSync::GetRoundTripTime( ) const
+	{
+		return m_RoundTrip;
+	}
+
+	Bit::Int64 TimeSync::GetMinRoundTripTime( ) const
+	{
+		return m_MinRoundTrip;
+	}
+
+	Bit::Float64 TimeSync::GetDrift( ) const
+	{
+		return m_Drift;
+	}
+
+	void TimeSync::Estimate( )
+	{
+		const Bit::SizeType count = m_SampleCount < WindowSize ? m_SampleCount : WindowSize;
+
+		m_MinRoundTrip = m_Samples[ 0 ].RoundTrip;
+		for( Bit::SizeType i = 1; i < count; i++ )
+		{
+			if( m_Samples[ i ].RoundTrip < m_MinRoundTrip )
+			{
+				m_MinRoundTrip = m_Samples[ i ].RoundTrip;
+			}
+		}
+
+		// Samples close to the shortest round trip, at least a millisecond of slack.
+		const Bit::Int64 slack = m_MinRoundTrip / 2 > 1000 ? m_MinRoundTrip / 2 : 1000;
+		const Bit::Int64 maxRoundTrip = m_MinRoundTrip + slack;
+
+		// Average time and offset of the good samples.
+		Bit::Float64 sumTime = 0.0;
+		Bit::Float64 sumOffset = 0.0;
+		Bit::SizeType goodCount = 0;
+		const Bit::Int64 newestTime = m_Samples[ ( m_SampleCount - 1 ) % WindowSize ].Time;
+
+		for( Bit::SizeType i = 0; i < count; i++ )
+		{
+			const Sample & sample = m_Samples[ i ];
+			if( sample.RoundTrip > maxRoundTrip )
+			{
+				continue;
+			}
+
+			sumTime += static_cast<Bit::Float64>( sample.Time - newestTime );
+			sumOffset += static_cast<Bit::Float64>( sample.Offset );
+			goodCount++;
+		}
+
+		const Bit::Float64 n = static_cast<Bit::Float64>( goodCount );
+		m_BaseTime = newestTime + static_cast<Bit::Int64>( sumTime / n );
+		m_Offset = static_cast<Bit::Int64>( sumOffset / n );
+
+		if( IsSynchronized( ) == false )
+		{
+			return;
+		}
+
+		// The drift is the change of the offset since the anchor,
+		// measured over minutes, since the offset noise is in the order of a millisecond.
+		if( m_AnchorSet == false )
+		{
+			// Anchor on a full window, not on the first few samples.
+			if( m_SampleCount < WindowSize )
+			{
+				return;
+			}
+
+			m_AnchorSet = true;
+			m_AnchorTime = m_BaseTime;
+			m_AnchorOffset = m_Offset;
+			return;
+		}
+
+		const Bit::Int64 span = m_BaseTime - m_AnchorTime;
+		if( span >= g_MinDriftSpan )
+		{
+			const Bit::Float64 drift = static_cast<Bit::Float64>( m_Offset - m_AnchorOffset ) / static_cast<Bit::Float64>( span );
+			m_Drift = drift > g_MaxDrift ? g_MaxDrift : ( drift < -g_MaxDrift ? -g_MaxDrift : drift );
+		}
+
+		// Move the anchor along, to follow drift changes.
+		if( span >= g_MaxDriftSpan )
+		{
+			m_AnchorTime = m_BaseTime;
+			m_AnchorOffset = m_Offset;
+		}
+	}
+
+}
\ No newline at end of file
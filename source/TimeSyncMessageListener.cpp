@@ -0,0 +1,69 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <TimeSyncMessageListener.hpp>
+#include <Client.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+	TimeSyncMessageListener::TimeSyncMessageListener( Client * p_pClient ) :
+		m_pClient( p_pClient )
+	{
+	}
+
+	void TimeSyncMessageListener::HandleMessage( Packet & p_Message )
+	{
+		// Stamp the receive time first.
+		const Bit::Int64 clientReceive = m_pClient->GetLocalTime( );
+
+		// Error check the message size
+		if( p_Message.GetRemainingSize( ) < 44 )
+		{
+			return;
+		}
+
+		const Bit::Uint32 sequence = p_Message.ReadUint32( );
+		const Bit::Int64 clientSend = static_cast<Bit::Int64>( p_Message.ReadUint64( ) );
+		const Bit::Int64 serverReceive = static_cast<Bit::Int64>( p_Message.ReadUint64( ) );
+		const Bit::Int64 serverSend = static_cast<Bit::Int64>( p_Message.ReadUint64( ) );
+		const Bit::Uint32 tick = p_Message.ReadUint32( );
+		const Bit::Uint32 tickInterval = p_Message.ReadUint32( );
+		const Bit::Int64 tickTime = static_cast<Bit::Int64>( p_Message.ReadUint64( ) );
+
+		m_pClient->m_TimeSyncMutex.Lock( );
+
+		// Ignore replies to pings older than the newest answered one.
+		if( sequence > m_pClient->m_LastPongSequence &&
+			m_pClient->m_TimeSync.AddSample( clientSend, serverReceive, serverSend, clientReceive ) )
+		{
+			m_pClient->m_LastPongSequence = sequence;
+			m_pClient->m_ServerTick = tick;
+			m_pClient->m_ServerTickTime = tickTime;
+			m_pClient->m_TickInterval = tickInterval;
+		}
+
+		m_pClient->m_TimeSyncMutex.Unlock( );
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,227 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Trace.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Bit/System/Mutex.hpp>
+#include <atomic>
+#include <vector>
+#include <fstream>
+#if defined( _MSC_VER )
+	#include <process.h>
+#else
+	#include <unistd.h>
+#endif
+#include <Bit/System/MemoryLeak.hpp>
+
+#if defined( _MSC_VER )
+	#define PONG_THREAD_LOCAL __declspec( thread )
+#else
+	#define PONG_THREAD_LOCAL __thread
+#endif
+
+namespace Pong
+{
+
+	// Recorded span
+	struct TraceEvent
+	{
+		const char *	pName;
+		Bit::Uint64		Begin;
+		Bit::Uint64		End;
+	};
+
+	// Ring buffer of a thread, owned by the registry and kept after the thread exits.
+	struct TraceBuffer
+	{
+		TraceBuffer( const Bit::Uint32 p_ThreadId ) :
+			ThreadId( p_ThreadId ),
+			pName( NULL ),
+			Head( 0 ),
+			Events( Trace::BufferSize )
+		{
+		}
+
+		Bit::Uint32					ThreadId;
+		const char *				pName;
+		std::atomic<Bit::Uint64>	Head;	///< Number of recorded spans, the next slot is Head % BufferSize.
+		std::vector<TraceEvent>		Events;
+	};
+
+	// Registry of the buffers of all threads.
+	static std::atomic<Bit::Bool> g_Enabled( false );
+	static Bit::Mutex g_BufferMutex;
+	static std::vector<TraceBuffer *> g_Buffers;
+	static PONG_THREAD_LOCAL TraceBuffer * g_pThreadBuffer = NULL;
+
+	// Trace clock, started before main.
+	static Bit::Timer g_Clock;
+
+	static Bit::Bool StartClock( )
+	{
+		g_Clock.Start( );
+		return true;
+	}
+
+	static const Bit::Bool g_ClockStarted = StartClock( );
+
+	static TraceBuffer * GetThreadBuffer( )
+	{
+		if( g_pThreadBuffer == NULL )
+		{
+			g_BufferMutex.Lock( );
+			g_pThreadBuffer = new TraceBuffer( static_cast<Bit::Uint32>( g_Buffers.size( ) + 1 ) );
+			g_Buffers.push_back( g_pThreadBuffer );
+			g_BufferMutex.Unlock( );
+		}
+
+		return g_pThreadBuffer;
+	}
+
+	// Write a string literal as a JSON string, escaping quotes and backslashes.
+	static void WriteString( std::ofstream & p_File, const char * p_pString )
+	{
+		p_File << '"';
+		for( const char * pChar = p_pString; *pChar; pChar++ )
+		{
+			if( *pChar == '"' || *pChar == '\\' )
+			{
+				p_File << '\\';
+			}
+			p_File << *pChar;
+		}
+		p_File << '"';
+	}
+
+	// Trace class
+	void Trace::Enable( const Bit::Bool p_Enabled )
+	{
+		g_Enabled.store( p_Enabled );
+	}
+
+	Bit::Bool Trace::IsEnabled( )
+	{
+		return g_Enabled.load( std::memory_order_relaxed );
+	}
+
+	void Trace::SetThreadName( const char * p_pName )
+	{
+		if( IsEnabled( ) )
+		{
+			GetThreadBuffer( )->pName = p_pName;
+		}
+	}
+
+	Bit::Uint64 Trace::GetTime( )
+	{
+		return static_cast<Bit::Uint64>( g_Clock.GetLapsedTime( ).AsMicroseconds( ) );
+	}
+
+	void Trace::Record( const char * p_pName, const Bit::Uint64 p_Begin, const Bit::Uint64 p_End )
+	{
+		TraceBuffer * pBuffer = GetThreadBuffer( );
+
+		// Only this thread writes the buffer, publish the span after writing it.
+		const Bit::Uint64 head = pBuffer->Head.load( std::memory_order_relaxed );
+		TraceEvent & event = pBuffer->Events[ head % BufferSize ];
+		event.pName = p_pName;
+		event.Begin = p_Begin;
+		event.End = p_End;
+		pBuffer->Head.store( head + 1, std::memory_order_release );
+	}
+
+	Bit::Bool Trace::Write( const std::string & p_Path, const char * p_pProcessName, const Bit::Int64 p_ClockOffset )
+	{
+		std::ofstream file( p_Path.c_str( ), std::ios::out | std::ios::trunc );
+		if( file.is_open( ) == false )
+		{
+			return false;
+		}
+
+		#if defined( _MSC_VER )
+			const int processId = _getpid( );
+		#else
+			const int processId = static_cast<int>( getpid( ) );
+		#endif
+
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << processId << ",\"tid\":0,\"args\":{\"name\":";
+		WriteString( file, p_pProcessName );
+		file << "}}";
+
+		g_BufferMutex.Lock( );
+
+		for( std::vector<TraceBuffer *>::iterator it = g_Buffers.begin( ); it != g_Buffers.end( ); it++ )
+		{
+			TraceBuffer * pBuffer = *it;
+
+			if( pBuffer->pName )
+			{
+				file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << processId << ",\"tid\":" << pBuffer->ThreadId << ",\"args\":{\"name\":";
+				WriteString( file, pBuffer->pName );
+				file << "}}";
+			}
+
+			// The oldest slot of a full buffer may be written by a span still in flight, leave it out.
+			const Bit::Uint64 head = pBuffer->Head.load( std::memory_order_acquire );
+			const Bit::Uint64 count = head < BufferSize ? head : BufferSize - 1;
+			for( Bit::Uint64 i = head - count; i < head; i++ )
+			{
+				const TraceEvent & event = pBuffer->Events[ i % BufferSize ];
+				const Bit::Int64 begin = static_cast<Bit::Int64>( event.Begin ) + p_ClockOffset;
+				const Bit::Uint64 duration = event.End > event.Begin ? event.End - event.Begin : 0;
+
+				file << ",\n{\"name\":";
+				WriteString( file, event.pName );
+				file << ",\"ph\":\"X\",\"ts\":" << begin << ",\"dur\":" << duration;
+				file << ",\"pid\":" << processId << ",\"tid\":" << pBuffer->ThreadId << "}";
+			}
+		}
+
+		g_BufferMutex.Unlock( );
+
+		file << "\n]}\n";
+		return file.good( );
+	}
+
+	// Trace scope class
+	TraceScope::TraceScope( const char * p_pName ) :
+		m_pName( p_pName ),
+		m_Begin( 0 ),
+		m_Enabled( Trace::IsEnabled( ) )
+	{
+		if( m_Enabled )
+		{
+			m_Begin = Trace::GetTime( );
+		}
+	}
+
+	TraceScope::~TraceScope( )
+	{
+		if( m_Enabled )
+		{
+			Trace::Record( m_pName, m_Begin, Trace::GetTime( ) );
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <UniformGrid.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Pong
+{
+
+	UniformGrid::UniformGrid( ) :
+		m_MinX( 0.0f ),
+		m_MinY( 0.0f ),
+		m_InverseCellSize( 1.0f ),
+		m_Columns( 0 ),
+		m_Rows( 0 )
+	{
+	}
+
+	void UniformGrid::Create(	const Bit::Float32 p_MinX, const Bit::Float32 p_MinY,
+								const Bit::Float32 p_MaxX, const Bit::Float32 p_MaxY,
+								const Bit::Float32 p_CellSize )
+	{
+		m_MinX = p_MinX;
+		m_MinY = p_MinY;
+		m_InverseCellSize = 1.0f / p_CellSize;
+		m_Columns = static_cast<Bit::SizeType>( ( p_MaxX - p_MinX ) * m_InverseCellSize ) + 1;
+		m_Rows = static_cast<Bit::SizeType>( ( p_MaxY - p_MinY ) * m_InverseCellSize ) + 1;
+
+		m_CellStarts.assign( m_Columns * m_Rows + 1, 0 );
+		m_Items.clear( );
+		m_ItemCells.clear( );
+	}
+
+	void UniformGrid::BuildPoints( const Bit::Float32 * p_pX, const Bit::Float32 * p_pY, const Bit::SizeType p_Count )
+	{
+		const Bit::SizeType cellCount = m_Columns * m_Rows;
+		m_Items.resize( p_Count );
+		m_ItemCells.resize( p_Count );
+
+		// Count the points of each cell.
+		for( Bit::SizeType i = 0; i <= cellCount; i++ )
+		{
+			m_CellStarts[ i ] = 0;
+		}
+		for( Bit::SizeType i = 0; i < p_Count; i++ )
+		{
+			const Bit::Uint32 cell = static_cast<Bit::Uint32>( GetRow( p_pY[ i ] ) * m_Columns + GetColumn( p_pX[ i ] ) );
+			m_ItemCells[ i ] = cell;
+			m_CellStarts[ cell + 1 ]++;
+		}
+
+		// Turn the counts into start offsets.
+		for( Bit::SizeType i = 0; i < cellCount; i++ )
+		{
+			m_CellStarts[ i + 1 ] += m_CellStarts[ i ];
+		}
+
+		// Place the points, the end offsets are restored afterwards.
+		for( Bit::SizeType i = 0; i < p_Count; i++ )
+		{
+			m_Items[ m_CellStarts[ m_ItemCells[ i ] ]++ ] = static_cast<Bit::Uint32>( i );
+		}
+		for( Bit::SizeType i = cellCount; i > 0; i-- )
+		{
+			m_CellStarts[ i ] = m_CellStarts[ i - 1 ];
+		}
+		m_CellStarts[ 0 ] = 0;
+	}
+
+	void UniformGrid::BuildBoxes(	const Bit::Float32 * p_pMinX, const Bit::Float32 * p_pMinY,
+									const Bit::Float32 * p_pMaxX, const Bit::Float32 * p_pMaxY,
+									const Bit::SizeType p_Count, const Bit::Float32 p_Margin )
+	{
+		const Bit::SizeType cellCount = m_Columns * m_Rows;
+		m_ItemCells.clear( );
+
+		for( Bit::SizeType i = 0; i <= cellCount; i++ )
+		{
+			m_CellStarts[ i ] = 0;
+		}
+
+		// Count the boxes of each cell, in two passes, counting and placing.
+		for( Bit::SizeType pass = 0; pass < 2; pass++ )
+		{
+			for( Bit::SizeType i = 0; i < p_Count; i++ )
+			{
+				const Bit::SizeType firstColumn = GetColumn( p_pMinX[ i ] - p_Margin );
+				const Bit::SizeType lastColumn = GetColumn( p_pMaxX[ i ] + p_Margin );
+				const Bit::SizeType firstRow = GetRow( p_pMinY[ i ] - p_Margin );
+				const Bit::SizeType lastRow = GetRow( p_pMaxY[ i ] + p_Margin );
+
+				for( Bit::SizeType row = firstRow; row <= lastRow; row++ )
+				{
+					for( Bit::SizeType column = firstColumn; column <= lastColumn; column++ )
+					{
+						const Bit::SizeType cell = row * m_Columns + column;
+						if( pass == 0 )
+						{
+							m_CellStarts[ cell + 1 ]++;
+						}
+						else
+						{
+							m_Items[ m_CellStarts[ cell ]++ ] = static_cast<Bit::Uint32>( i );
+						}
+					}
+				}
+			}
+
+			if( pass == 0 )
+			{
+				for( Bit::SizeType i = 0; i < cellCount; i++ )
+				{
+					m_CellStarts[ i + 1 ] += m_CellStarts[ i ];
+				}
+				m_Items.resize( m_CellStarts[ cellCount ] );
+			}
+		}
+
+		for( Bit::SizeType i = cellCount; i > 0; i-- )
+		{
+			m_CellStarts[ i ] = m_CellStarts[ i - 1 ];
+		}
+		m_CellStarts[ 0 ] = 0;
+	}
+
+	Bit::SizeType UniformGrid::GetColumn( const Bit::Float32 p_X ) const
+	{
+		const Bit::Float32 column = ( p_X - m_MinX ) * m_InverseCellSize;
+		// Clamp before the conversion, NaN ends up in the first column.
+		if( !( column > 0.0f ) )
+		{
+			return 0;
+		}
+		if( column >= static_cast<Bit::Float32>( m_Columns ) )
+		{
+			return m_Columns - 1;
+		}
+
+		return static_cast<Bit::SizeType>( column );
+	}
+
+	Bit::SizeType UniformGrid::GetRow( const Bit::Float32 p_Y ) const
+	{
+		const Bit::Float32 row = ( p_Y - m_MinY ) * m_InverseCellSize;
+		// Clamp before the conversion, NaN ends up in the first row.
+		if( !( row > 0.0f ) )
+		{
+			return 0;
+		}
+		if( row >= static_cast<Bit::Float32>( m_Rows ) )
+		{
+			return m_Rows - 1;
+		}
+
+		return static_cast<Bit::SizeType>( row );
+	}
+
+}
\ No newline at end of file